@@ -0,0 +1,123 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * address_index.cpp - Sorted and interval indexes for address lookups
+ */
+
+#include <dwarfsql/address_index.hpp>
+
+#include <algorithm>
+
+namespace dwarfsql {
+
+// ============================================================================
+// SortedIndex
+// ============================================================================
+
+void SortedIndex::finish() {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry& a, const Entry& b) { return a.key < b.key; });
+
+    keys_.resize(entries_.size());
+    rows_.resize(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        keys_[i] = entries_[i].key;
+        rows_[i] = entries_[i].row;
+    }
+    entries_.clear();
+    entries_.shrink_to_fit();
+}
+
+RowPositions SortedIndex::find(int64_t min, int64_t max) const {
+    RowPositions result;
+    if (min > max) return result;
+
+    auto first = std::lower_bound(keys_.begin(), keys_.end(), min);
+    auto last = std::upper_bound(first, keys_.end(), max);
+    result.view = rows_.data() + (first - keys_.begin());
+    result.size = static_cast<size_t>(last - first);
+    return result;
+}
+
+bool SortedIndex::last_at_or_before(int64_t value, uint32_t& row) const {
+    auto it = std::upper_bound(keys_.begin(), keys_.end(), value);
+    if (it == keys_.begin()) return false;
+    row = rows_[(it - keys_.begin()) - 1];
+    return true;
+}
+
+// ============================================================================
+// IntervalIndex
+// ============================================================================
+
+void IntervalIndex::finish() {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry& a, const Entry& b) { return a.low < b.low; });
+
+    max_high_.resize(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        max_high_[i] = i == 0 ? entries_[i].high : std::max(max_high_[i - 1], entries_[i].high);
+    }
+}
+
+RowPositions IntervalIndex::find(int64_t low_max, int64_t high_min) const {
+    auto end = std::upper_bound(entries_.begin(), entries_.end(), low_max,
+                                [](int64_t v, const Entry& e) { return v < e.low; });
+
+    // Walk back from the last interval starting at or before low_max; once
+    // no earlier interval reaches high_min, nothing further back can match
+    std::vector<uint32_t> rows;
+    for (size_t i = static_cast<size_t>(end - entries_.begin()); i > 0; --i) {
+        if (max_high_[i - 1] < high_min) break;
+        if (entries_[i - 1].high >= high_min) {
+            rows.push_back(entries_[i - 1].row);
+        }
+    }
+    std::reverse(rows.begin(), rows.end());
+
+    RowPositions result;
+    result.own(std::move(rows));
+    return result;
+}
+
+RowPositions IntervalIndex::covering(int64_t point) const {
+    if (point == INT64_MAX) return RowPositions();  // No high is past it
+    return find(point, point + 1);
+}
+
+// ============================================================================
+// parse_address
+// ============================================================================
+
+bool parse_address(std::string_view text, uint64_t& out) {
+    unsigned base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text.remove_prefix(2);
+    }
+    if (text.empty()) return false;
+
+    uint64_t value = 0;
+    for (char c : text) {
+        unsigned digit;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<unsigned>(c - '0');
+        } else if (base == 16 && c >= 'a' && c <= 'f') {
+            digit = static_cast<unsigned>(c - 'a' + 10);
+        } else if (base == 16 && c >= 'A' && c <= 'F') {
+            digit = static_cast<unsigned>(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        if (value > (UINT64_MAX - digit) / base) return false;  // Past 64 bits
+        value = value * base + digit;
+    }
+    out = value;
+    return true;
+}
+
+} // namespace dwarfsql
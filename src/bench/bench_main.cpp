@@ -0,0 +1,437 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * dwarfsql_bench - Extraction and query benchmarks
+ *
+ * Usage:
+ *   dwarfsql_bench                        # The corpus built with the target
+ *   dwarfsql_bench <binary>... -o out.json
+ *
+ * For each binary, times the index walk, every DwarfSession::get_* method
+ * (per unit or per DIE before the index exists, whole tables after) and a
+ * fixed set of SQL queries, and writes one JSON document to stdout.
+ */
+
+// Windows SDK compatibility - must be before any includes
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <dwarfsql/dwarfsql.hpp>
+#include <xsql/database.hpp>
+#include <xsql/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef DWARFSQL_BENCH_CORPUS
+#define DWARFSQL_BENCH_CORPUS ""
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Lookups by DIE (get_parameters(func), get_struct_members(struct), ...)
+// are sampled down to this many keys, spread evenly over the binary
+constexpr size_t MAX_KEYS = 1000;
+
+void print_usage() {
+    std::cout << "dwarfsql_bench v" << dwarfsql::VERSION << " - Extraction and query benchmarks\n"
+              << dwarfsql::COPYRIGHT << "\n\n"
+              << "Usage:\n"
+              << "  dwarfsql_bench [options] [binary...]\n\n"
+              << "With no binary, runs over the corpus built alongside dwarfsql_bench.\n\n"
+              << "Options:\n"
+              << "  -n, --repeat <n>    Runs per query after the first (default: 20)\n"
+              << "  -j, --jobs <n>      DWARF extraction threads (0 = all cores, default: 1)\n"
+              << "  -o, --output <path> Write the JSON report to a file instead of stdout\n"
+              << "  -h, --help          Show this help\n";
+}
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double per_second(size_t count, double ms) {
+    return ms > 0 ? count * 1000.0 / ms : 0.0;
+}
+
+// Peak resident set size of this process so far, in KiB
+uint64_t peak_rss_kb() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize / 1024;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;  // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// Nearest-rank percentile of an ascending sample
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+std::vector<std::string> split_corpus(const std::string& list) {
+    std::vector<std::string> paths;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find('|', start);
+        if (end == std::string::npos) end = list.size();
+        if (end > start) paths.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return paths;
+}
+
+// Every n-th key, so at most MAX_KEYS remain
+std::vector<uint64_t> sample_keys(std::vector<uint64_t> keys) {
+    if (keys.size() <= MAX_KEYS) return keys;
+    std::vector<uint64_t> sampled;
+    sampled.reserve(MAX_KEYS);
+    for (size_t i = 0; i < MAX_KEYS; ++i) {
+        sampled.push_back(keys[i * keys.size() / MAX_KEYS]);
+    }
+    return sampled;
+}
+
+template <typename Row>
+std::vector<uint64_t> offsets_of(const std::vector<Row>& rows) {
+    std::vector<uint64_t> keys;
+    keys.reserve(rows.size());
+    for (const auto& row : rows) keys.push_back(row.offset);
+    return keys;
+}
+
+// Rows the index walk recorded: one per DIE that lands in a table
+size_t indexed_dies(const dwarfsql::DwarfIndex& index) {
+    size_t dies = index.compilation_units.size() + index.functions.size() + index.variables.size() +
+                  index.types.size() + index.structs.size() + index.enums.size() +
+                  index.parameters.size() + index.local_variables.size() + index.base_classes.size() +
+                  index.calls.size() + index.inlined_calls.size() + index.namespaces.size();
+    for (const auto& entry : index.struct_members) dies += entry.second.size();
+    for (const auto& entry : index.enum_values) dies += entry.second.size();
+    return dies;
+}
+
+/**
+ * Times one getter over a list of keys (or once, with no keys)
+ */
+struct MethodBench {
+    std::string name;
+    std::string mode;  // "unit", "die" (before the index exists) or "indexed"
+    size_t calls = 0;
+    size_t rows = 0;
+    double ms = 0.0;
+
+    xsql::json to_json() const {
+        return {{"name", name}, {"mode", mode}, {"calls", calls}, {"rows", rows},
+                {"ms", ms}, {"rows_per_sec", per_second(rows, ms)}};
+    }
+};
+
+MethodBench run_method(const std::string& name, const std::string& mode,
+                       const std::vector<uint64_t>& keys,
+                       const std::function<size_t(uint64_t)>& call) {
+    MethodBench bench{name, mode};
+    auto start = Clock::now();
+    for (uint64_t key : keys) {
+        bench.rows += call(key);
+        ++bench.calls;
+    }
+    bench.ms = elapsed_ms(start);
+    return bench;
+}
+
+MethodBench run_method(const std::string& name, const std::function<size_t()>& call) {
+    MethodBench bench{name, "indexed", 1};
+    auto start = Clock::now();
+    bench.rows = call();
+    bench.ms = elapsed_ms(start);
+    return bench;
+}
+
+/**
+ * The canonical queries; {pc} is replaced with the start of a function
+ */
+struct CanonicalQuery {
+    const char* name;
+    const char* sql;
+};
+
+const CanonicalQuery QUERIES[] = {
+    {"count_functions", "SELECT COUNT(*) FROM functions"},
+    {"limit_scan", "SELECT name FROM functions LIMIT 10"},
+    {"largest_functions",
+     "SELECT name, (high_pc - low_pc) AS size FROM functions WHERE high_pc > 0 "
+     "ORDER BY size DESC LIMIT 10"},
+    {"source_files", "SELECT name, comp_dir, producer FROM compilation_units"},
+    {"types_by_name", "SELECT name, byte_size FROM types WHERE name LIKE '%::%' ORDER BY name"},
+    {"struct_layouts",
+     "SELECT s.name, m.name, m.type, m.offset FROM structs s "
+     "JOIN struct_members m ON s.id = m.struct_id ORDER BY s.name, m.offset"},
+    {"enum_values",
+     "SELECT e.name, v.name, v.value FROM enums e JOIN enum_values v ON e.id = v.enum_id"},
+    {"parameter_counts",
+     "SELECT f.name, COUNT(*) AS n FROM functions f JOIN parameters p ON p.func_id = f.id "
+     "GROUP BY f.id ORDER BY n DESC LIMIT 10"},
+    {"class_hierarchy", "SELECT derived_name, base_name FROM base_classes ORDER BY derived_name"},
+    {"inline_sites",
+     "SELECT name, COUNT(*) AS n FROM inlined_calls GROUP BY name ORDER BY n DESC LIMIT 10"},
+    {"function_at", "SELECT name FROM functions WHERE low_pc <= {pc} AND high_pc > {pc}"},
+    {"lines_at", "SELECT file, line FROM line_info WHERE address BETWEEN {pc} AND {pc} + 64"},
+    {"symbolize", "SELECT depth, kind, name, file, line FROM symbolize({pc})"},
+};
+
+std::string substitute_pc(std::string sql, uint64_t pc) {
+    const std::string token = "{pc}";
+    std::string value = std::to_string(pc);
+    for (size_t pos = sql.find(token); pos != std::string::npos; pos = sql.find(token, pos)) {
+        sql.replace(pos, token.size(), value);
+        pos += value.size();
+    }
+    return sql;
+}
+
+// A function with code, from the middle of the address range
+uint64_t pick_pc(const dwarfsql::DwarfIndex& index) {
+    std::vector<uint64_t> starts;
+    for (const auto& f : index.functions) {
+        if (f.low_pc != 0 && f.high_pc > f.low_pc) starts.push_back(f.low_pc);
+    }
+    if (starts.empty()) return 0;
+    std::sort(starts.begin(), starts.end());
+    return starts[starts.size() / 2];
+}
+
+/**
+ * Runs one query on a fresh session (cold), then repeat times more on the
+ * same database, so the cold time includes any table decode and the warm
+ * percentiles see only cached rows.
+ */
+xsql::json run_query(const std::string& path, int jobs, const CanonicalQuery& query,
+                     uint64_t pc, int repeat) {
+    std::string sql = substitute_pc(query.sql, pc);
+    xsql::json result = {{"name", query.name}, {"sql", sql}};
+
+    dwarfsql::DwarfSession session;
+    if (!session.open(path)) {
+        result["error"] = session.last_error();
+        return result;
+    }
+    session.set_jobs(jobs);
+    xsql::Database db;
+    dwarfsql::register_tables(db, session);
+
+    auto start = Clock::now();
+    auto first = db.query(sql);
+    result["cold_ms"] = elapsed_ms(start);
+    if (!first.ok()) {
+        result["error"] = "query failed";
+        return result;
+    }
+    result["rows"] = first.size();
+
+    std::vector<double> times;
+    times.reserve(repeat);
+    for (int i = 0; i < repeat; ++i) {
+        start = Clock::now();
+        db.query(sql);
+        times.push_back(elapsed_ms(start));
+    }
+    std::sort(times.begin(), times.end());
+    result["runs"] = times.size();
+    result["p50_ms"] = percentile(times, 0.50);
+    result["p99_ms"] = percentile(times, 0.99);
+    return result;
+}
+
+xsql::json run_binary(const std::string& path, int jobs, int repeat) {
+    xsql::json result = {{"path", path}};
+
+    // Before the index exists: one unit or DIE at a time, as pushed-down
+    // filters and LIMIT scans decode them
+    dwarfsql::DwarfSession lazy;
+    auto start = Clock::now();
+    if (!lazy.open(path)) {
+        result["error"] = lazy.last_error();
+        return result;
+    }
+    result["open_ms"] = elapsed_ms(start);
+
+    // Keys come from a second session, so the lazy one never builds its index
+    dwarfsql::DwarfSession session;
+    if (!session.open(path)) {
+        result["error"] = session.last_error();
+        return result;
+    }
+    session.set_jobs(jobs);
+
+    start = Clock::now();
+    const auto& index = session.index();
+    double index_ms = elapsed_ms(start);
+    size_t dies = indexed_dies(index);
+    result["index"] = {{"jobs", jobs}, {"ms", index_ms}, {"dies", dies},
+                       {"dies_per_sec", per_second(dies, index_ms)},
+                       {"units", index.compilation_units.size()}};
+
+    std::vector<uint64_t> units = lazy.get_unit_offsets();
+    std::vector<uint64_t> funcs = sample_keys(offsets_of(index.functions));
+    std::vector<uint64_t> structs = sample_keys(offsets_of(index.structs));
+    std::vector<uint64_t> enums = sample_keys(offsets_of(index.enums));
+    std::vector<uint64_t> params = sample_keys(offsets_of(index.parameters));
+    std::vector<uint64_t> pcs;
+    for (const auto& f : index.functions) {
+        if (f.low_pc != 0 && f.high_pc > f.low_pc) pcs.push_back(f.low_pc);
+    }
+    pcs = sample_keys(std::move(pcs));
+    auto id = [](uint64_t key) { return static_cast<int64_t>(key); };
+
+    std::vector<MethodBench> methods;
+    methods.push_back(run_method("get_functions", "unit", units, [&](uint64_t k) { return lazy.get_functions(id(k)).size(); }));
+    methods.push_back(run_method("get_variables", "unit", units, [&](uint64_t k) { return lazy.get_variables(id(k)).size(); }));
+    methods.push_back(run_method("get_types", "unit", units, [&](uint64_t k) { return lazy.get_types(id(k)).size(); }));
+    methods.push_back(run_method("get_structs", "unit", units, [&](uint64_t k) { return lazy.get_structs(id(k)).size(); }));
+    methods.push_back(run_method("get_enums", "unit", units, [&](uint64_t k) { return lazy.get_enums(id(k)).size(); }));
+    methods.push_back(run_method("get_line_info", "unit", units, [&](uint64_t k) { return lazy.get_line_info(id(k)).size(); }));
+    methods.push_back(run_method("get_parameters", "die", funcs, [&](uint64_t k) { return lazy.get_parameters(id(k)).size(); }));
+    methods.push_back(run_method("get_local_variables", "die", funcs, [&](uint64_t k) { return lazy.get_local_variables(id(k)).size(); }));
+    methods.push_back(run_method("get_struct_members", "die", structs, [&](uint64_t k) { return lazy.get_struct_members(k).size(); }));
+    methods.push_back(run_method("get_enum_values", "die", enums, [&](uint64_t k) { return lazy.get_enum_values(k).size(); }));
+    methods.push_back(run_method("get_location", "die", params, [&](uint64_t k) { return lazy.get_location(k).empty() ? size_t(0) : size_t(1); }));
+
+    // After the index exists: whole tables copied out of it; line tables
+    // and address indexes are still decoded on first use
+    methods.push_back(run_method("get_compilation_units", [&] { return session.get_compilation_units().size(); }));
+    methods.push_back(run_method("get_functions", [&] { return session.get_functions().size(); }));
+    methods.push_back(run_method("get_variables", [&] { return session.get_variables().size(); }));
+    methods.push_back(run_method("get_types", [&] { return session.get_types().size(); }));
+    methods.push_back(run_method("get_structs", [&] { return session.get_structs().size(); }));
+    methods.push_back(run_method("get_enums", [&] { return session.get_enums().size(); }));
+    methods.push_back(run_method("get_parameters", [&] { return session.get_parameters().size(); }));
+    methods.push_back(run_method("get_local_variables", [&] { return session.get_local_variables().size(); }));
+    methods.push_back(run_method("get_base_classes", [&] { return session.get_base_classes().size(); }));
+    methods.push_back(run_method("get_calls", [&] { return session.get_calls().size(); }));
+    methods.push_back(run_method("get_inlined_calls", [&] { return session.get_inlined_calls().size(); }));
+    methods.push_back(run_method("get_namespaces", [&] { return session.get_namespaces().size(); }));
+    methods.push_back(run_method("get_line_info", [&] { return session.get_line_info().size(); }));
+    methods.push_back(run_method("function_bounds", [&] { return session.function_bounds().size(); }));
+    methods.push_back(run_method("inline_bounds", [&] { return session.inline_bounds().size(); }));
+    methods.push_back(run_method("function_ranges", [&] { return session.function_ranges().size(); }));
+    methods.push_back(run_method("inline_ranges", [&] { return session.inline_ranges().size(); }));
+    methods.push_back(run_method("line_ranges", [&] { return session.line_ranges().size(); }));
+    methods.push_back(run_method("symbolize", "indexed", pcs, [&](uint64_t pc) { return session.symbolize(pc).size(); }));
+
+    xsql::json method_list = xsql::json::array();
+    for (const auto& method : methods) method_list.push_back(method.to_json());
+    result["methods"] = std::move(method_list);
+
+    uint64_t pc = pick_pc(index);
+    xsql::json query_list = xsql::json::array();
+    for (const auto& query : QUERIES) {
+        query_list.push_back(run_query(path, jobs, query, pc, repeat));
+    }
+    result["queries"] = std::move(query_list);
+
+    // Process-wide, so it covers every binary benchmarked before this one
+    result["peak_rss_kb"] = peak_rss_kb();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> paths;
+    std::string output_path;
+    int repeat = 20;
+    int jobs = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "-n" || arg == "--repeat") {
+            if (i + 1 < argc) {
+                repeat = std::max(1, std::stoi(argv[++i]));
+            }
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (i + 1 < argc) {
+                jobs = std::stoi(argv[++i]);
+            }
+        } else if (arg == "-o" || arg == "--output") {
+            if (i + 1 < argc) {
+                output_path = argv[++i];
+            }
+        } else if (arg[0] != '-') {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.empty()) {
+        paths = split_corpus(DWARFSQL_BENCH_CORPUS);
+    }
+    if (paths.empty()) {
+        std::cerr << "Error: No binaries to benchmark\n";
+        print_usage();
+        return 1;
+    }
+
+    xsql::json report = {{"version", dwarfsql::VERSION}, {"repeat", repeat}, {"jobs", jobs}};
+    xsql::json binaries = xsql::json::array();
+    bool failed = false;
+    for (const auto& path : paths) {
+        std::cerr << "Benchmarking " << path << "\n";
+        binaries.push_back(run_binary(path, jobs, repeat));
+        if (binaries.back().contains("error")) {
+            std::cerr << "Error: " << binaries.back()["error"].get<std::string>() << "\n";
+            failed = true;
+        }
+    }
+    report["binaries"] = std::move(binaries);
+    report["peak_rss_kb"] = peak_rss_kb();
+
+    if (output_path.empty()) {
+        std::cout << report.dump(2) << "\n";
+    } else {
+        std::ofstream out(output_path);
+        if (!out) {
+            std::cerr << "Error: Cannot write " << output_path << "\n";
+            return 1;
+        }
+        out << report.dump(2) << "\n";
+    }
+    return failed ? 1 : 0;
+}
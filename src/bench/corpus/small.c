@@ -0,0 +1,100 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * small.c - Benchmark corpus: a small C program
+ *
+ * A handful of structs, enums, globals and functions, some of them inlined,
+ * so every table has rows. Only its debug info matters; it is never run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum shape_kind { SHAPE_CIRCLE, SHAPE_RECT, SHAPE_TRIANGLE };
+
+struct point {
+    double x;
+    double y;
+};
+
+struct shape {
+    enum shape_kind kind;
+    struct point origin;
+    union {
+        double radius;
+        struct { double w, h; } rect;
+        struct point corners[3];
+    } u;
+    struct shape* next;
+};
+
+static int shape_count;
+const char* shape_names[] = {"circle", "rect", "triangle"};
+
+static inline double square(double v) {
+    return v * v;
+}
+
+static inline double rect_area(const struct shape* s) {
+    return s->u.rect.w * s->u.rect.h;
+}
+
+static double triangle_area(const struct shape* s) {
+    const struct point* c = s->u.corners;
+    double a = (c[1].x - c[0].x) * (c[2].y - c[0].y);
+    double b = (c[2].x - c[0].x) * (c[1].y - c[0].y);
+    return (a > b ? a - b : b - a) / 2.0;
+}
+
+double shape_area(const struct shape* s) {
+    switch (s->kind) {
+    case SHAPE_CIRCLE: return 3.14159265358979 * square(s->u.radius);
+    case SHAPE_RECT: return rect_area(s);
+    case SHAPE_TRIANGLE: return triangle_area(s);
+    }
+    return 0.0;
+}
+
+struct shape* shape_new(enum shape_kind kind, double x, double y) {
+    struct shape* s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->kind = kind;
+    s->origin.x = x;
+    s->origin.y = y;
+    ++shape_count;
+    return s;
+}
+
+static void shape_free_all(struct shape* head) {
+    while (head) {
+        struct shape* next = head->next;
+        free(head);
+        --shape_count;
+        head = next;
+    }
+}
+
+int main(int argc, char** argv) {
+    struct shape* head = NULL;
+    for (int i = 1; i < argc; ++i) {
+        struct shape* s = shape_new((enum shape_kind)(strlen(argv[i]) % 3), i, -i);
+        if (!s) break;
+        s->u.radius = (double)i;
+        s->next = head;
+        head = s;
+    }
+
+    double total = 0.0;
+    for (struct shape* s = head; s; s = s->next) {
+        total += shape_area(s);
+        printf("%s %.2f\n", shape_names[s->kind], shape_area(s));
+    }
+    printf("%d shapes, %.2f total\n", shape_count, total);
+    shape_free_all(head);
+    return 0;
+}
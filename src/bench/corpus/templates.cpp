@@ -0,0 +1,124 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * templates.cpp - Benchmark corpus: template-heavy C++
+ *
+ * Standard containers and a recursive class template instantiated over a
+ * hundred times, giving the deep type trees, long qualified names and
+ * class hierarchies typical of large C++ binaries. Only its debug info
+ * matters; it is never run.
+ */
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace corpus {
+namespace detail {
+
+template <int N>
+struct Tag {
+    static constexpr int value = N;
+};
+
+struct NodeBase {
+    virtual ~NodeBase() = default;
+    virtual int weight() const = 0;
+};
+
+// Node<N> derives from Node<N - 1>, so every instantiation adds a struct,
+// a base class, members and a few member functions
+template <int N>
+struct Node : Node<N - 1> {
+    enum class Color { red = N, green, blue };
+
+    Color color = Color::green;
+    int payload[N % 5 + 1] = {};
+    std::pair<Tag<N>, std::string> label{Tag<N>{}, std::to_string(N)};
+
+    int weight() const override { return N + Node<N - 1>::weight(); }
+
+    template <typename F>
+    int visit(F&& f) const {
+        return f(payload[0], N) + Node<N - 1>::visit(f);
+    }
+};
+
+template <>
+struct Node<0> : NodeBase {
+    int weight() const override { return 0; }
+
+    template <typename F>
+    int visit(F&&) const { return 0; }
+};
+
+} // namespace detail
+
+template <typename Key, typename Value>
+class Registry {
+public:
+    using Map = std::map<Key, std::vector<Value>>;
+
+    void add(const Key& key, Value value) { entries_[key].push_back(std::move(value)); }
+
+    size_t count(const Key& key) const {
+        auto it = entries_.find(key);
+        return it == entries_.end() ? 0 : it->second.size();
+    }
+
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const auto& [key, values] : entries_) {
+            for (const auto& value : values) f(key, value);
+        }
+    }
+
+private:
+    Map entries_;
+};
+
+template <int... Ns>
+int total_weight(std::integer_sequence<int, Ns...>) {
+    int total = 0;
+    ((total += detail::Node<Ns * 12 + 11>{}.weight()), ...);
+    return total;
+}
+
+} // namespace corpus
+
+int main(int argc, char** argv) {
+    using namespace corpus;
+
+    Registry<std::string, std::shared_ptr<detail::NodeBase>> registry;
+    registry.add("deep", std::make_shared<detail::Node<119>>());
+    registry.add("shallow", std::make_shared<detail::Node<3>>());
+
+    Registry<int, std::tuple<std::string, double, std::function<int(int)>>> handlers;
+    for (int i = 0; i < argc; ++i) {
+        handlers.add(i, {argv[i], i * 0.5, [i](int v) { return v * i; }});
+    }
+
+    std::unordered_map<std::string, std::vector<std::pair<int, double>>> samples;
+    samples["args"].emplace_back(argc, 1.0);
+
+    int sum = 0;
+    registry.for_each([&sum](const std::string&, const std::shared_ptr<detail::NodeBase>& node) {
+        sum += node->weight();
+    });
+    handlers.for_each([&sum](int key, const auto& handler) { sum += std::get<2>(handler)(key); });
+    sum += detail::Node<119>{}.visit([](int a, int b) { return a + b; });
+    sum += total_weight(std::make_integer_sequence<int, 10>{});
+
+    std::printf("%d %zu %zu\n", sum, registry.count("deep"), samples.size());
+    return 0;
+}
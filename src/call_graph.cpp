@@ -0,0 +1,43 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * call_graph.cpp - Compressed adjacency lists for call graph walks
+ */
+
+#include <dwarfsql/call_graph.hpp>
+
+#include <algorithm>
+
+namespace dwarfsql {
+
+void Adjacency::finish(size_t nodes) {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry& a, const Entry& b) { return a.node < b.node; });
+
+    starts_.assign(nodes + 1, 0);
+    rows_.resize(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        ++starts_[entries_[i].node + 1];
+        rows_[i] = entries_[i].row;
+    }
+    for (size_t n = 0; n < nodes; ++n) {
+        starts_[n + 1] += starts_[n];
+    }
+    entries_.clear();
+    entries_.shrink_to_fit();
+}
+
+RowPositions Adjacency::of(uint32_t node) const {
+    RowPositions result;
+    if (static_cast<size_t>(node) + 1 >= starts_.size()) return result;
+
+    result.view = rows_.data() + starts_[node];
+    result.size = starts_[node + 1] - starts_[node];
+    return result;
+}
+
+} // namespace dwarfsql
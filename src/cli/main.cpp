@@ -12,6 +12,7 @@
  *   dwarfsql <binary> -i                           # Interactive mode
  *   dwarfsql <binary> --http [port]                # HTTP REST server
  *   dwarfsql <binary> --mcp [port]                 # MCP server
+ *   dwarfsql <binary> --daemon                     # Local index service
  */
 
 // Windows SDK compatibility - must be before any includes
@@ -38,7 +39,12 @@
 #include "mcp_server.hpp"
 #endif
 
+#ifdef DWARFSQL_HAS_DAEMON
+#include "daemon_server.hpp"
+#endif
+
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -47,16 +53,37 @@
 #include <mutex>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
 
 namespace {
 
 // Global for signal handling
 volatile sig_atomic_t g_quit_requested = 0;
+std::atomic<dwarfsql::QueryBudget*> g_running_query{nullptr};  // The query Ctrl+C stops
 
-void signal_handler(int /*sig*/) {
-    g_quit_requested = 1;
+void signal_handler(int sig) {
+    dwarfsql::QueryBudget* query = g_running_query.load();
+    if (query) query->cancel();
+    // Ctrl+C during a query stops only the query
+    if (!query || sig != SIGINT) g_quit_requested = 1;
 }
 
+// Makes budget the one signal_handler() cancels while in scope
+class InterruptibleQuery {
+public:
+    explicit InterruptibleQuery(dwarfsql::QueryBudget& budget) { g_running_query = &budget; }
+    ~InterruptibleQuery() { g_running_query = nullptr; }
+
+    InterruptibleQuery(const InterruptibleQuery&) = delete;
+    InterruptibleQuery& operator=(const InterruptibleQuery&) = delete;
+};
+
 void print_usage() {
     std::cout << "dwarfsql v" << dwarfsql::VERSION << " - SQL interface to DWARF debug information\n"
               << dwarfsql::COPYRIGHT << "\n\n"
@@ -64,19 +91,41 @@ void print_usage() {
               << "  dwarfsql <binary> \"<query>\"       Execute query and exit\n"
               << "  dwarfsql <binary> -i              Interactive mode\n"
               << "  dwarfsql <binary> --http [port]  HTTP REST server\n"
-              << "  dwarfsql <binary> --mcp [port]   MCP server\n\n"
+              << "  dwarfsql <binary> --mcp [port]   MCP server\n"
+#ifdef DWARFSQL_HAS_DAEMON
+              << "  dwarfsql <binary> --daemon       Keep the binary loaded for later queries\n"
+#endif
+              << "\n"
               << "Options:\n"
               << "  -s, --source <path> Binary file path (alternative to positional)\n"
               << "  -i, --interactive   Interactive REPL mode\n"
               << "  -q, --query <sql>   Execute query\n"
+              << "  --ndjson            Query mode: stream rows as NDJSON while they are read\n"
 #ifdef DWARFSQL_HAS_HTTP
               << "  --http [port]       Start HTTP REST server (default: 8080)\n"
 #endif
 #ifdef DWARFSQL_HAS_MCP
               << "  --mcp [port]        Start MCP server (default: random 9000-9999)\n"
+#endif
+#ifdef DWARFSQL_HAS_DAEMON
+              << "  --daemon            Serve query mode runs on this host from one loaded copy\n"
+              << "  --socket <path>     Daemon socket (default: one per user and binary under\n"
+              << "                      $XDG_RUNTIME_DIR or /tmp)\n"
+              << "  --no-daemon         Query mode: do not ask a running daemon\n"
 #endif
               << "  --bind <addr>       Bind address for server (default: 127.0.0.1)\n"
               << "  --token <token>     Authentication token\n"
+              << "  --max-query-ms <n>  Stop a query after n milliseconds (default: no limit)\n"
+              << "  --max-rows <n>      Stop a query after n result rows (default: no limit)\n"
+              << "  -j, --jobs <n>      DWARF extraction threads, or binaries loaded at once\n"
+              << "                      with --module (0 = all cores, default: 1 / all cores)\n"
+              << "  --index             Reuse/write a sidecar index (<binary>.dwarfsql-idx)\n"
+              << "  --index-file <path> Same as --index with an explicit index file path\n"
+              << "  -m, --module <path> Also load this binary (e.g. a shared library); repeatable\n"
+              << "  --module-list <f>   Also load every binary listed in f, one path per line\n"
+              << "  --watch             Server modes: reload the binary when it is rebuilt\n"
+              << "  --prewarm [tables]  Server modes: build the index and table caches (all, or\n"
+              << "                      the comma-separated tables) in the background at startup\n"
               << "  -v, --verbose       Verbose output\n"
               << "  -h, --help          Show this help\n\n"
               << "Tables:\n"
@@ -97,6 +146,9 @@ void print_usage() {
 #endif
 #ifdef DWARFSQL_HAS_MCP
               << "  dwarfsql a.out --mcp 9000\n"
+#endif
+#ifdef DWARFSQL_HAS_DAEMON
+              << "  dwarfsql a.out --daemon --watch &\n"
 #endif
               ;
 }
@@ -159,25 +211,585 @@ private:
     std::vector<size_t> widths_;
 };
 
-std::string execute_query(xsql::Database& db, const std::string& sql) {
+std::string execute_query(xsql::Database& db, const std::string& sql, dwarfsql::QueryStats& stats,
+                          dwarfsql::QueryBudget& budget) {
+    dwarfsql::QueryTimer timer(stats);
+    dwarfsql::QueryScope scope(&budget, db.handle());
     auto script = xsql::run_database_script(db, sql, {});
     if (!script.parse_error.empty()) {
+        timer.fail();
         return "Parse error: " + script.parse_error;
     }
+    // Whatever it returned, a query its budget stopped may be missing rows
+    if (budget.spent()) {
+        timer.fail();
+        stats.record_stopped();
+        return "Error: " + budget.reason();
+    }
     return xsql::script_result_to_text(script);
 }
 
-std::string execute_query_json(xsql::Database& db, const std::string& sql) {
-    auto script = xsql::run_database_script(db, sql, {});
-    return xsql::script_result_to_json(script);
+// JSON encoding of result values, shared by QueryStream and execute_request_json()
+
+void append_json_string(std::string& out, const char* s) {
+    out += '"';
+    for (; s && *s; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c == '\t') {
+            out += "\\t";
+        } else if (c == '\r') {
+            out += "\\r";
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+void append_json_value(std::string& out, sqlite3_stmt* stmt, int col) {
+    switch (sqlite3_column_type(stmt, col)) {
+        case SQLITE_INTEGER:
+            out += std::to_string(sqlite3_column_int64(stmt, col));
+            break;
+        case SQLITE_FLOAT: {
+            double v = sqlite3_column_double(stmt, col);
+            if (!std::isfinite(v)) {
+                out += "null";
+                break;
+            }
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.17g", v);
+            out += buf;
+            break;
+        }
+        case SQLITE_TEXT:
+            append_json_string(out, reinterpret_cast<const char*>(sqlite3_column_text(stmt, col)));
+            break;
+        case SQLITE_BLOB: {
+            // As hex, since JSON has no bytes
+            static const char digits[] = "0123456789abcdef";
+            auto data = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, col));
+            int size = sqlite3_column_bytes(stmt, col);
+            out += '"';
+            for (int i = 0; i < size; ++i) {
+                out += digits[data[i] >> 4];
+                out += digits[data[i] & 0xf];
+            }
+            out += '"';
+            break;
+        }
+        default:
+            out += "null";
+            break;
+    }
+}
+
+std::string format_ms(uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", ns / 1e6);
+    return buf;
+}
+
+/**
+ * Runs a script as NDJSON, stepping the SQLite cursor as the output is read
+ *
+ * Each statement writes a header line, one JSON array per row and a trailer;
+ * the last line summarises the script like the /query envelope:
+ *
+ *   {"statement_index":0,"columns":["name","low_pc"]}
+ *   ["main",4198964]
+ *   {"statement_index":0,"success":true,"row_count":1,"elapsed_ms":0.4}
+ *   {"success":true,"statement_count":1,"row_count_total":1,"elapsed_ms_total":0.4,"first_error_index":null}
+ *
+ * Nothing is buffered beyond one batch of rows, so memory stays flat however
+ * large the result. Statements run fail-fast. Stepping may be spread over
+ * several next() calls; the query is recorded in stats once it ends or the
+ * stream is dropped. limits count from construction, over all next() calls.
+ */
+class QueryStream {
+public:
+    QueryStream(xsql::Database& db, std::string sql, dwarfsql::QueryStats& stats,
+                const dwarfsql::QueryLimits& limits = {})
+        : db_(db.handle()), sql_(std::move(sql)), tail_(sql_.c_str()), stats_(stats), budget_(limits),
+          start_(std::chrono::steady_clock::now()) {}
+
+    ~QueryStream() {
+        if (stmt_) sqlite3_finalize(stmt_);
+        stats_.record(dwarfsql::elapsed_ns(start_), decode_ns_, ok_);
+        if (stopped_) stats_.record_stopped();
+    }
+
+    // Stops the query at its next step, from any thread
+    dwarfsql::QueryBudget& budget() { return budget_; }
+
+    QueryStream(const QueryStream&) = delete;
+    QueryStream& operator=(const QueryStream&) = delete;
+
+    // Appends whole lines to out until about max_bytes; false once the summary is written
+    bool next(std::string& out, size_t max_bytes = 64 * 1024) {
+        if (done_) return false;
+        dwarfsql::QueryScope scope(&budget_, db_);
+        uint64_t decode_before = dwarfsql::decode_counters.decode_ns;
+        size_t limit = out.size() + max_bytes;
+        while (!done_ && out.size() < limit) step(out);
+        decode_ns_ += dwarfsql::decode_counters.decode_ns - decode_before;
+        return !done_;
+    }
+
+private:
+    // One row, or the start or end of a statement
+    void step(std::string& out) {
+        if (!stmt_) {
+            prepare(out);
+            return;
+        }
+        int rc = sqlite3_step(stmt_);
+        // Whatever it returned, a statement its budget stopped may be missing rows
+        if (budget_.spent()) {
+            fail(out, budget_.reason().c_str());
+            ok_ = false;
+            stopped_ = true;
+        } else if (rc == SQLITE_ROW) {
+            out += '[';
+            int n = sqlite3_column_count(stmt_);
+            for (int i = 0; i < n; ++i) {
+                if (i > 0) out += ',';
+                append_json_value(out, stmt_, i);
+            }
+            out += "]\n";
+            ++rows_;
+            return;
+        } else if (rc == SQLITE_DONE) {
+            out += "{\"statement_index\":" + std::to_string(index_) +
+                   ",\"success\":true,\"row_count\":" + std::to_string(rows_) +
+                   ",\"elapsed_ms\":" + format_ms(dwarfsql::elapsed_ns(statement_start_)) + "}\n";
+        } else {
+            fail(out, sqlite3_errmsg(db_));
+        }
+        sqlite3_finalize(stmt_);
+        stmt_ = nullptr;
+        total_rows_ += rows_;
+        ++index_;
+    }
+
+    // Next statement of the script, skipping empty ones, or the summary
+    void prepare(std::string& out) {
+        if (failed_) {
+            finish(out);
+            return;
+        }
+        while (*tail_ && !stmt_) {
+            const char* rest = nullptr;
+            if (sqlite3_prepare_v2(db_, tail_, -1, &stmt_, &rest) != SQLITE_OK) {
+                ok_ = false;  // The parser rejected it
+                fail(out, sqlite3_errmsg(db_));
+                ++index_;
+                finish(out);
+                return;
+            }
+            tail_ = rest;
+        }
+        if (!stmt_) {
+            finish(out);
+            return;
+        }
+
+        statement_start_ = std::chrono::steady_clock::now();
+        rows_ = 0;
+        out += "{\"statement_index\":" + std::to_string(index_) + ",\"columns\":[";
+        int n = sqlite3_column_count(stmt_);
+        for (int i = 0; i < n; ++i) {
+            if (i > 0) out += ',';
+            append_json_string(out, sqlite3_column_name(stmt_, i));
+        }
+        out += "]}\n";
+    }
+
+    void fail(std::string& out, const char* error) {
+        out += "{\"statement_index\":" + std::to_string(index_) + ",\"success\":false,\"error\":";
+        append_json_string(out, error);
+        out += "}\n";
+        failed_ = true;
+        first_error_ = index_;
+    }
+
+    void finish(std::string& out) {
+        out += std::string("{\"success\":") + (failed_ ? "false" : "true") +
+               ",\"statement_count\":" + std::to_string(index_) +
+               ",\"row_count_total\":" + std::to_string(total_rows_) +
+               ",\"elapsed_ms_total\":" + format_ms(dwarfsql::elapsed_ns(start_)) +
+               ",\"first_error_index\":" + (failed_ ? std::to_string(first_error_) : "null") + "}\n";
+        done_ = true;
+    }
+
+    sqlite3* db_;
+    std::string sql_;
+    const char* tail_;
+    sqlite3_stmt* stmt_ = nullptr;
+    dwarfsql::QueryStats& stats_;
+    dwarfsql::QueryBudget budget_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point statement_start_;
+    uint64_t decode_ns_ = 0;
+    size_t index_ = 0;
+    size_t rows_ = 0;
+    size_t total_rows_ = 0;
+    size_t first_error_ = 0;
+    bool failed_ = false;
+    bool done_ = false;
+    bool ok_ = true;
+    bool stopped_ = false;
+};
+
+#if defined(DWARFSQL_HAS_HTTP) || defined(DWARFSQL_HAS_DAEMON)
+// A QueryStream together with the pooled connection it runs on
+struct PooledStream {
+    PooledStream(dwarfsql::ConnectionPool::Lease leased, const std::string& sql, dwarfsql::QueryStats& stats,
+                 const dwarfsql::QueryLimits& limits)
+        : lease(std::move(leased)), query(lease.db(), sql, stats, limits) {}
+
+    dwarfsql::ConnectionPool::Lease lease;
+    QueryStream query;  // Declared after lease: finalized before the connection is released
+};
+#endif
+
+#if defined(DWARFSQL_HAS_HTTP) || defined(DWARFSQL_HAS_MCP)
+// Bind a JSON array to a statement's placeholders, in order
+bool bind_params(sqlite3_stmt* stmt, const xsql::json& params, std::string& error) {
+    int count = sqlite3_bind_parameter_count(stmt);
+    if (params.size() != static_cast<size_t>(count)) {
+        error = "Statement takes " + std::to_string(count) + " parameter(s), got " + std::to_string(params.size());
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        const xsql::json& value = params[static_cast<size_t>(i)];
+        int rc;
+        if (value.is_null()) {
+            rc = sqlite3_bind_null(stmt, i + 1);
+        } else if (value.is_boolean()) {
+            rc = sqlite3_bind_int(stmt, i + 1, value.get<bool>() ? 1 : 0);
+        } else if (value.is_number_unsigned()) {
+            // As the tables expose offsets: addresses past INT64_MAX wrap negative
+            rc = sqlite3_bind_int64(stmt, i + 1, static_cast<sqlite3_int64>(value.get<uint64_t>()));
+        } else if (value.is_number_integer()) {
+            rc = sqlite3_bind_int64(stmt, i + 1, value.get<int64_t>());
+        } else if (value.is_number_float()) {
+            rc = sqlite3_bind_double(stmt, i + 1, value.get<double>());
+        } else if (value.is_string()) {
+            const std::string& text = value.get_ref<const std::string&>();
+            rc = sqlite3_bind_text(stmt, i + 1, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+        } else {
+            error = "Parameter " + std::to_string(i + 1) + " is not a number, string, boolean or null";
+            return false;
+        }
+        if (rc != SQLITE_OK) {
+            error = sqlite3_errstr(rc);
+            return false;
+        }
+    }
+    return true;
+}
+
+// POST /query and the dwarfsql_query tool. The body is a SQL script, or
+// {"sql": "...", "params": [...]} binding params to the ? placeholders of
+// one statement. A single statement runs from the connection's statement
+// cache and answers with the same envelope as a script; several go
+// through xsql::run_database_script.
+std::string execute_request_json(const dwarfsql::ConnectionPool::Lease& lease, const std::string& body,
+                                 dwarfsql::QueryStats& stats, const dwarfsql::QueryLimits& limits) {
+    auto error = [](const std::string& message) {
+        return xsql::json{{"success", false}, {"error", message}}.dump();
+    };
+
+    std::string sql;
+    xsql::json params = xsql::json::array();
+    size_t first = body.find_first_not_of(" \t\r\n");
+    if (first != std::string::npos && body[first] == '{') {
+        xsql::json request = xsql::json::parse(body, nullptr, false);
+        if (request.is_discarded() || !request.is_object() || !request.contains("sql") ||
+            !request["sql"].is_string()) {
+            return error("Expected {\"sql\": \"...\", \"params\": [...]}");
+        }
+        sql = request["sql"].get<std::string>();
+        if (request.contains("params")) {
+            params = request["params"];
+            if (!params.is_array()) return error("params must be an array");
+        }
+    } else {
+        sql = body;
+    }
+
+    dwarfsql::QueryTimer timer(stats);
+    dwarfsql::QueryBudget budget(limits);
+    dwarfsql::QueryScope scope(&budget, lease.db().handle());
+    auto start = std::chrono::steady_clock::now();
+    std::string message;
+    auto stmt = lease.statements().prepare(sql, message);
+    if (!stmt && message.empty()) {
+        if (!params.empty()) {
+            timer.fail();
+            return error("params need a script of exactly one statement");
+        }
+        auto script = xsql::run_database_script(lease.db(), sql, {});
+        if (!script.parse_error.empty()) timer.fail();
+        if (budget.spent()) {
+            timer.fail();
+            stats.record_stopped();
+            return error(budget.reason());
+        }
+        return xsql::script_result_to_json(script);
+    }
+
+    std::string columns;
+    std::string rows;
+    size_t row_count = 0;
+    if (!stmt) {
+        timer.fail();  // The parser rejected it
+    } else {
+        stats.record_statement(stmt.reused());
+        int n = sqlite3_column_count(stmt.get());
+        for (int i = 0; i < n; ++i) {
+            if (i > 0) columns += ',';
+            append_json_string(columns, sqlite3_column_name(stmt.get(), i));
+        }
+        if (bind_params(stmt.get(), params, message)) {
+            int rc;
+            while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW && !budget.spent()) {
+                rows += row_count++ > 0 ? ",[" : "[";
+                for (int i = 0; i < n; ++i) {
+                    if (i > 0) rows += ',';
+                    append_json_value(rows, stmt.get(), i);
+                }
+                rows += ']';
+            }
+            if (budget.spent()) {
+                timer.fail();
+                stats.record_stopped();
+                message = budget.reason();
+            } else if (rc != SQLITE_DONE) {
+                message = sqlite3_errmsg(lease.db().handle());
+            }
+            if (!message.empty()) {
+                rows.clear();
+                row_count = 0;
+            }
+        }
+    }
+
+    bool ok = message.empty();
+    std::string elapsed = format_ms(dwarfsql::elapsed_ns(start));
+    std::string out = std::string("{\"success\":") + (ok ? "true" : "false") +
+                      ",\"statement_count\":1,\"results\":[{\"statement_index\":0,\"success\":" +
+                      (ok ? "true" : "false") + ",\"columns\":[" + columns + "],\"rows\":[" + rows +
+                      "],\"row_count\":" + std::to_string(row_count) + ",\"elapsed_ms\":" + elapsed +
+                      ",\"error\":";
+    if (ok) {
+        out += "null";
+    } else {
+        append_json_string(out, message.c_str());
+    }
+    out += "}],\"row_count_total\":" + std::to_string(row_count) + ",\"elapsed_ms_total\":" + elapsed +
+           ",\"first_error_index\":" + (ok ? "null" : "0") + "}";
+    return out;
 }
+#endif
+
+// Address from a JSON number or a "0x..." / decimal string
+static bool parse_address(const xsql::json& value, uint64_t& pc) {
+    if (value.is_number_unsigned()) {
+        pc = value.get<uint64_t>();
+        return true;
+    }
+    if (value.is_number_integer()) {
+        int64_t v = value.get<int64_t>();
+        pc = static_cast<uint64_t>(v);
+        return v >= 0;
+    }
+    if (!value.is_string()) return false;
+
+    return dwarfsql::parse_address(value.get_ref<const std::string&>(), pc);
+}
+
+// POST /symbolize: resolve a JSON array of addresses in one pass. An item
+// may be {"module": name, "address": pc}, however many modules are loaded;
+// a bare address is looked up in every module.
+std::string execute_symbolize_json(const dwarfsql::SessionSet& sessions, const std::string& body) {
+    auto error = [](const std::string& message) {
+        return xsql::json{{"success", false}, {"error", message}}.dump();
+    };
+
+    xsql::json request = xsql::json::parse(body, nullptr, false);
+    if (request.is_discarded() || !request.is_array()) {
+        return error("Expected a JSON array of addresses");
+    }
+
+    // Addresses asked of each module, as positions in pcs
+    std::vector<uint64_t> pcs;
+    std::vector<std::vector<size_t>> asked(sessions.size());
+    pcs.reserve(request.size());
+    for (const auto& item : request) {
+        uint64_t pc = 0;
+        const dwarfsql::SessionSet::Module* module = nullptr;
+        bool ok;
+        if (item.is_object()) {
+            auto name = item.find("module");
+            auto address = item.find("address");
+            ok = name != item.end() && name->is_string() && address != item.end() && parse_address(*address, pc);
+            if (ok) {
+                module = sessions.find(name->get<std::string>());
+                if (!module) return error("Unknown module: " + name->dump());
+            }
+        } else {
+            ok = parse_address(item, pc);
+        }
+        if (!ok) {
+            return error("Invalid address: " + item.dump());
+        }
+        for (size_t m = 0; m < sessions.size(); ++m) {
+            if (!module || module == &sessions[m]) asked[m].push_back(pcs.size());
+        }
+        pcs.push_back(pc);
+    }
+
+    std::vector<xsql::json> frames(pcs.size(), xsql::json::array());
+    for (size_t m = 0; m < sessions.size(); ++m) {
+        std::vector<uint64_t> batch;
+        for (size_t i : asked[m]) batch.push_back(pcs[i]);
+        auto symbolized = sessions[m].session->symbolize(batch);
+
+        for (size_t b = 0; b < batch.size(); ++b) {
+            for (const auto& f : symbolized[b]) {
+                xsql::json frame = {
+                    {"depth", f.depth},
+                    {"kind", f.kind()},
+                    {"id", f.offset},
+                    {"name", f.name.str()},
+                    {"low_pc", f.low_pc},
+                    {"high_pc", f.high_pc},
+                    {"file", f.file.str()},
+                    {"line", f.line},
+                    {"column", f.column},
+                };
+                if (sessions.size() > 1) frame["module"] = sessions[m].name;
+                frames[asked[m][b]].push_back(std::move(frame));
+            }
+        }
+    }
 
-void run_interactive(xsql::Database& db, const std::string& binary_path, bool verbose) {
+    xsql::json results = xsql::json::array();
+    for (size_t i = 0; i < pcs.size(); ++i) {
+        results.push_back({{"address", pcs[i]}, {"frames", std::move(frames[i])}});
+    }
+
+    return xsql::json{
+        {"success", true},
+        {"count", pcs.size()},
+        {"results", std::move(results)},
+    }.dump();
+}
+
+// Reopen a rebuilt binary and drop the table caches built from the old one.
+// No query may be running. Rewrites the index file, if one is in use.
+std::string reload_session(dwarfsql::DwarfSession& session, const std::vector<dwarfsql::TableDef>& tables,
+                           const std::string& index_path) {
+    dwarfsql::ReloadResult result;
+    if (!session.reload(&result)) {
+        return "Reload failed: " + session.last_error();
+    }
+    if (!result.changed) {
+        return "Binary unchanged";
+    }
+    dwarfsql::reset_tables(tables);
+
+    std::string status = "Reloaded " + session.path();
+    if (result.units_reused + result.units_indexed > 0) {
+        status += ": " + std::to_string(result.units_indexed) + " unit(s) re-indexed, " +
+                  std::to_string(result.units_reused) + " reused";
+    }
+    if (!index_path.empty() && !session.save_index(index_path)) {
+        status += " (" + session.last_error() + ")";
+    }
+    return status;
+}
+
+// Polls binaries once a second and calls on_change(i) once paths[i] has
+// been rewritten and then left alone for a poll, so a link in progress is
+// not picked up half-written
+class BinaryWatcher {
+public:
+    BinaryWatcher(std::vector<std::string> paths, std::function<void(size_t)> on_change)
+        : paths_(std::move(paths)), on_change_(std::move(on_change)), seen_(paths_.size()) {
+        for (size_t i = 0; i < paths_.size(); ++i) {
+            dwarfsql::read_index_key(paths_[i], seen_[i]);
+        }
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~BinaryWatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+    }
+
+private:
+    void run() {
+        std::vector<dwarfsql::IndexFileKey> last = seen_;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wake_.wait_for(lock, std::chrono::seconds(1), [this] { return stop_; })) {
+            for (size_t i = 0; i < paths_.size() && !stop_; ++i) {
+                dwarfsql::IndexFileKey key;
+                if (!dwarfsql::read_index_key(paths_[i], key)) continue;  // Mid-replace
+                if (key == last[i] && key != seen_[i]) {
+                    seen_[i] = key;
+                    lock.unlock();
+                    on_change_(i);
+                    lock.lock();
+                }
+                last[i] = key;
+            }
+        }
+    }
+
+    std::vector<std::string> paths_;
+    std::function<void(size_t)> on_change_;
+    std::vector<dwarfsql::IndexFileKey> seen_;  // Of the build last handed to on_change_ (or at start)
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+void run_interactive(xsql::Database& db, const std::vector<dwarfsql::TableDef>& tables,
+                     dwarfsql::QueryStats& stats, const dwarfsql::QueryLimits& limits,
+                     const std::string& binary_path, bool verbose, std::function<std::string()> reload,
+                     std::function<std::string()> get_stats) {
     dwarfsql::CommandCallbacks callbacks;
-    callbacks.get_tables = [&db]() {
-        return "compilation_units\nfunctions\nvariables\ntypes\nstructs\n"
-               "struct_members\nenums\nenum_values\nline_info\n"
-               "parameters\nlocal_variables\nbase_classes\ncalls\ninlined_calls\nnamespaces";
+    callbacks.get_tables = [&tables]() {
+        // Table-valued functions with their arguments, e.g. symbolize(pc)
+        std::string list;
+        for (const auto& def : tables) {
+            if (!list.empty()) list += '\n';
+            list += def.name;
+            if (def.arguments.empty()) continue;
+            list += '(';
+            for (size_t i = 0; i < def.arguments.size(); ++i) {
+                list += (i > 0 ? ", " : "") + def.arguments[i];
+            }
+            list += ')';
+        }
+        return list;
     };
     callbacks.get_schema = [&db](const std::string& table) {
         auto result = db.query("SELECT sql FROM sqlite_master WHERE name = '" + table + "'");
@@ -192,6 +804,8 @@ void run_interactive(xsql::Database& db, const std::string& binary_path, bool ve
     callbacks.clear_session = []() {
         return "Session cleared";
     };
+    callbacks.reload = std::move(reload);
+    callbacks.get_stats = std::move(get_stats);
 
     (void)verbose;
 
@@ -225,8 +839,10 @@ void run_interactive(xsql::Database& db, const std::string& binary_path, bool ve
                 std::cout << output << "\n";
             }
         } else {
-            // Not a command - execute as SQL query
-            std::cout << execute_query(db, line) << "\n";
+            // Not a command - execute as SQL query; Ctrl+C stops it and returns to the prompt
+            dwarfsql::QueryBudget budget(limits);
+            InterruptibleQuery running(budget);
+            std::cout << execute_query(db, line, stats, budget) << "\n";
         }
     }
 }
@@ -242,14 +858,30 @@ static void http_signal_handler(int) {
     if (g_http_server) g_http_server->stop();
 }
 
-static int run_http_mode(xsql::Database& db, const std::string& binary_path,
-                         int port, const std::string& bind_addr) {
-    auto query_cb = [&db](const std::string& sql) -> std::string {
-        return execute_query_json(db, sql);
+static int run_http_mode(dwarfsql::ConnectionPool& pool, const dwarfsql::SessionSet& sessions,
+                         dwarfsql::QueryStats& stats, const dwarfsql::QueryLimits& limits,
+                         std::function<std::string()> metrics,
+                         std::function<xsql::json()> status, const std::string& binary_path, int port, const std::string& bind_addr) {
+    // Requests arrive on server threads; each runs on its own pooled connection
+    auto query_cb = [&pool, &stats, &limits](const std::string& body) -> std::string {
+        auto lease = pool.acquire();
+        return execute_request_json(lease, body, stats, limits);
     };
 
     dwarfsql::DwarfsqlHTTPServer server;
     g_http_server = &server;
+    server.set_symbolize_callback([&pool, &sessions](const std::string& body) {
+        // Holds a connection only so a --watch reload waits for it
+        auto lease = pool.acquire();
+        return execute_symbolize_json(sessions, body);
+    });
+    server.set_metrics_callback(std::move(metrics));
+    server.set_status_callback(std::move(status));
+    server.set_stream_callback([&pool, &stats, &limits](const std::string& sql) -> dwarfsql::HTTPStreamProducer {
+        // The connection stays leased until the last row is sent or the client goes away
+        auto stream = std::make_shared<PooledStream>(pool.acquire(), sql, stats, limits);
+        return [stream](std::string& chunk) { return stream->query.next(chunk); };
+    });
 
     int actual_port = server.start(port, query_cb, bind_addr.empty() ? "127.0.0.1" : bind_addr, false);
     if (actual_port < 0) {
@@ -292,14 +924,18 @@ static void mcp_signal_handler(int) {
 }
 
 // Serve the direct-SQL dwarfsql_query MCP tool over SSE until Ctrl+C.
-static int run_mcp_mode(xsql::Database& db, const std::string& binary_path,
+static int run_mcp_mode(dwarfsql::ConnectionPool& pool, dwarfsql::QueryStats& stats,
+                        const dwarfsql::QueryLimits& limits, std::function<std::string()> status, const std::string& binary_path,
                         int port, const std::string& bind_addr) {
-    auto query_cb = [&db](const std::string& sql) -> std::string {
-        return execute_query_json(db, sql);
+    // Tool calls arrive on server threads; each runs on its own pooled connection
+    auto query_cb = [&pool, &stats, &limits](const std::string& body) -> std::string {
+        auto lease = pool.acquire();
+        return execute_request_json(lease, body, stats, limits);
     };
 
     dwarfsql::DwarfsqlMCPServer server;
     g_mcp_server = &server;
+    server.set_status_callback(std::move(status));
 
     int actual_port = server.start(port, query_cb,
                                     bind_addr.empty() ? "127.0.0.1" : bind_addr, false);
@@ -332,6 +968,106 @@ static int run_mcp_mode(xsql::Database& db, const std::string& binary_path,
 }
 #endif // DWARFSQL_HAS_MCP
 
+//=============================================================================
+// Daemon Mode
+//=============================================================================
+
+#ifdef DWARFSQL_HAS_DAEMON
+// How client and daemon name a binary, whatever path each was given
+std::string canonical_path(const std::string& path) {
+    std::error_code ec;
+    auto resolved = std::filesystem::weakly_canonical(std::filesystem::absolute(path, ec), ec);
+    return ec ? path : resolved.string();
+}
+
+// A text query mode request, run by the first producer call
+struct PooledQuery {
+    PooledQuery(dwarfsql::ConnectionPool::Lease leased, std::string text, const dwarfsql::QueryLimits& limits)
+        : lease(std::move(leased)), sql(std::move(text)), budget(limits) {}
+
+    dwarfsql::ConnectionPool::Lease lease;
+    std::string sql;
+    dwarfsql::QueryBudget budget;
+};
+
+// The tighter of two limits, 0 being none
+static uint64_t tighter_limit(uint64_t a, uint64_t b) {
+    return a == 0 ? b : (b == 0 ? a : std::min(a, b));
+}
+
+// Answer query mode runs of other dwarfsql processes until Ctrl+C. A request
+// names the binaries the client was given; anything else, or a binary
+// rebuilt since it was loaded, is refused and the client runs the query itself.
+// It runs under the tighter of the daemon's limits and the client's, and
+// from the reply's producer, so a client that hangs up cancels it.
+static int run_daemon_mode(dwarfsql::ConnectionPool& pool, const dwarfsql::SessionSet& sessions,
+                           const std::vector<std::string>& paths, dwarfsql::QueryStats& stats,
+                           const dwarfsql::QueryLimits& limits, const std::string& binary_path,
+                           const std::string& socket_path) {
+    auto request_cb = [&](const std::string& line) -> dwarfsql::DaemonReply {
+        dwarfsql::DaemonReply reply;
+        xsql::json request = xsql::json::parse(line, nullptr, false);
+        if (!request.is_object() || !request.contains("sql") || !request["sql"].is_string()) {
+            reply.reason = "malformed request";
+            return reply;
+        }
+        if (request.value("paths", xsql::json::array()) != xsql::json(paths)) {
+            reply.reason = "serving other binaries";
+            return reply;
+        }
+
+        // Held from the check on, so a --watch reload cannot slip in between
+        auto lease = pool.acquire();
+        for (size_t m = 0; m < sessions.size(); ++m) {
+            if (!sessions[m].session->is_current()) {
+                reply.reason = sessions[m].session->path() + " changed since it was loaded";
+                return reply;
+            }
+        }
+
+        std::string sql = request["sql"].get<std::string>();
+        dwarfsql::QueryLimits query_limits;
+        query_limits.max_ms = tighter_limit(limits.max_ms, request.value("max_query_ms", uint64_t{0}));
+        query_limits.max_rows = tighter_limit(limits.max_rows, request.value("max_rows", uint64_t{0}));
+        reply.accepted = true;
+        if (request.value("ndjson", false)) {
+            auto stream = std::make_shared<PooledStream>(std::move(lease), sql, stats, query_limits);
+            reply.producer = [stream](std::string& chunk) { return stream->query.next(chunk); };
+            reply.cancel = [stream] { stream->query.budget().cancel(); };
+        } else {
+            auto query = std::make_shared<PooledQuery>(std::move(lease), sql, query_limits);
+            reply.producer = [query, &stats](std::string& chunk) {
+                chunk = execute_query(query->lease.db(), query->sql, stats, query->budget) + "\n";
+                return false;
+            };
+            reply.cancel = [query] { query->budget.cancel(); };
+        }
+        return reply;
+    };
+
+    dwarfsql::DwarfsqlDaemonServer server;
+    std::string error;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (!server.start(socket_path, request_cb, threads, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << "Daemon listening on " << server.path() << "\n";
+    std::cout << "Binary: " << binary_path << "\n";
+    std::cout << "Press Ctrl+C to stop.\n\n";
+
+    // Wait for shutdown
+    while (!g_quit_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    server.stop();
+    std::cout << "\nDaemon stopped.\n";
+    return 0;
+}
+#endif // DWARFSQL_HAS_DAEMON
+
 } // anonymous namespace
 
 int main(int argc, char* argv[]) {
@@ -345,12 +1081,24 @@ int main(int argc, char* argv[]) {
     std::string query;
     std::string token;
     std::string bind_addr;
+    std::string socket_path;
     int http_port = 8080;
     int mcp_port = 0;  // 0 = random
+    int jobs = -1;  // Unset: 1, or all cores to load several binaries
+    std::string index_path;
+    std::vector<std::string> module_paths;
+    bool use_index = false;
+    bool watch = false;
     bool interactive = false;
     bool http_mode = false;
     bool mcp_mode = false;
+    bool daemon_mode = false;
+    bool use_daemon = true;
     bool verbose = false;
+    bool ndjson = false;
+    bool prewarm = false;
+    std::vector<std::string> prewarm_tables;  // Empty: all of them
+    dwarfsql::QueryLimits limits;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -366,6 +1114,45 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc) {
                 query = argv[++i];
             }
+        } else if (arg == "--ndjson") {
+            ndjson = true;
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (i + 1 < argc) {
+                jobs = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--index") {
+            use_index = true;
+        } else if (arg == "--index-file") {
+            if (i + 1 < argc) {
+                use_index = true;
+                index_path = argv[++i];
+            }
+        } else if (arg == "-m" || arg == "--module") {
+            if (i + 1 < argc) {
+                module_paths.push_back(argv[++i]);
+            }
+        } else if (arg == "--module-list") {
+            if (i + 1 < argc) {
+                std::ifstream list(argv[++i]);
+                if (!list) {
+                    std::cerr << "Error: Cannot read module list: " << argv[i] << "\n";
+                    return 1;
+                }
+                for (std::string line; std::getline(list, line);) {
+                    if (!line.empty() && line[0] != '#') module_paths.push_back(line);
+                }
+            }
+        } else if (arg == "--watch") {
+            watch = true;
+        } else if (arg == "--prewarm") {
+            prewarm = true;
+            // A table list only after the binary, so `--prewarm app` still names the binary
+            if (!binary_path.empty() && i + 1 < argc && argv[i + 1][0] != '-') {
+                std::stringstream list(argv[++i]);
+                for (std::string name; std::getline(list, name, ',');) {
+                    if (!name.empty()) prewarm_tables.push_back(name);
+                }
+            }
         } else if (arg == "--token") {
             if (i + 1 < argc) {
                 token = argv[++i];
@@ -380,6 +1167,22 @@ int main(int argc, char* argv[]) {
             if (i + 1 < argc && argv[i + 1][0] != '-') {
                 mcp_port = std::stoi(argv[++i]);
             }
+        } else if (arg == "--daemon") {
+            daemon_mode = true;
+        } else if (arg == "--socket") {
+            if (i + 1 < argc) {
+                socket_path = argv[++i];
+            }
+        } else if (arg == "--no-daemon") {
+            use_daemon = false;
+        } else if (arg == "--max-query-ms") {
+            if (i + 1 < argc) {
+                limits.max_ms = std::stoull(argv[++i]);
+            }
+        } else if (arg == "--max-rows") {
+            if (i + 1 < argc) {
+                limits.max_rows = std::stoull(argv[++i]);
+            }
         } else if (arg == "--bind") {
             if (i + 1 < argc) {
                 bind_addr = argv[++i];
@@ -400,16 +1203,140 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Open DWARF session
-    dwarfsql::DwarfSession session;
-    if (!session.open(binary_path)) {
-        std::cerr << "Error: " << session.last_error() << "\n";
+    std::vector<std::string> paths = {binary_path};
+    paths.insert(paths.end(), module_paths.begin(), module_paths.end());
+    if (jobs < 0) jobs = paths.size() > 1 ? 0 : 1;
+
+#ifdef DWARFSQL_HAS_DAEMON
+    std::vector<std::string> canonical_paths;
+    for (const auto& path : paths) {
+        canonical_paths.push_back(canonical_path(path));
+    }
+    if (socket_path.empty()) socket_path = dwarfsql::default_daemon_socket(binary_path);
+
+    // Query mode: a daemon with these binaries loaded answers without any parsing here
+    bool query_mode = !interactive && !query.empty() && !http_mode && !mcp_mode && !daemon_mode;
+    if (query_mode && use_daemon) {
+        xsql::json request = {{"paths", canonical_paths}, {"sql", query}, {"ndjson", ndjson},
+                              {"max_query_ms", limits.max_ms}, {"max_rows", limits.max_rows}};
+        // Without SA_RESTART, so Ctrl+C ends the wait; closing the socket cancels the query there
+        struct sigaction action = {};
+        struct sigaction old_int, old_term;
+        action.sa_handler = signal_handler;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &old_int);
+        sigaction(SIGTERM, &action, &old_term);
+        bool line_open = false;  // Output so far ends mid-line
+        bool served = dwarfsql::daemon_request(
+            socket_path, request.dump(),
+            [&line_open](const char* data, size_t size) {
+                std::cout.write(data, static_cast<std::streamsize>(size));
+                line_open = data[size - 1] != '\n';
+            },
+            [] { return g_quit_requested != 0; });
+        sigaction(SIGINT, &old_int, nullptr);
+        sigaction(SIGTERM, &old_term, nullptr);
+        if (served && g_quit_requested) {
+            if (line_open) std::cout << "\n";
+            std::cout << (ndjson ? "{\"success\":false,\"error\":\"query cancelled\"}" : "Error: query cancelled")
+                      << std::endl;
+            return 0;
+        }
+        if (served) {
+            std::cout.flush();
+            return 0;
+        }
+        if (verbose) std::cerr << "No daemon took the query on " << socket_path << ", running it here\n";
+    }
+#else
+    (void)use_daemon;
+#endif
+
+    // Persistent index: per binary, at its default sidecar unless --index-file names the main one's
+    auto index_file_for = [&](const std::string& path) {
+        if (!use_index) return std::string();
+        return path == binary_path && !index_path.empty() ? index_path : dwarfsql::default_index_path(path);
+    };
+
+    // Open DWARF sessions, several binaries at a time. An index is loaded
+    // when it matches the binary, otherwise rebuilt and saved.
+    std::mutex log_mutex;
+    dwarfsql::SessionSet sessions;
+    bool opened = sessions.open(paths, jobs, [&](dwarfsql::DwarfSession& session) {
+        std::string file = index_file_for(session.path());
+        if (file.empty()) return;
+        std::string message;
+        if (session.load_index(file)) {
+            if (verbose) message = "Loaded index: " + file;
+        } else if (session.save_index(file)) {
+            if (verbose) message = "Wrote index: " + file;
+        } else {
+            message = "Warning: " + session.last_error();
+        }
+        if (!message.empty()) {
+            std::lock_guard<std::mutex> lock(log_mutex);
+            std::cerr << message << "\n";
+        }
+    });
+    for (const auto& error : sessions.errors()) {
+        std::cerr << (opened ? "Warning: " : "Error: ") << error << "\n";
+    }
+    if (!opened) {
         return 1;
     }
+    std::string binaries = sessions.size() > 1
+        ? binary_path + " (+" + std::to_string(sessions.size() - 1) + " modules)"
+        : sessions[0].session->path();
 
-    // Create database and register tables
+    // Create database and register tables; server modes share these tables
+    // (and their caches) across a pool of connections
+    std::vector<std::vector<dwarfsql::TableDef>> module_tables;
+    auto tables = dwarfsql::build_tables(sessions, &module_tables);
     xsql::Database db;
-    dwarfsql::register_tables(db, session);
+    dwarfsql::register_tables(db, tables);
+
+    auto unknown = dwarfsql::Prewarmer::unknown_tables(tables, prewarm_tables);
+    if (!unknown.empty()) {
+        std::cerr << "Error: Unknown table in --prewarm: " << unknown[0] << "\n";
+        return 1;
+    }
+
+    // Counters are shared by every connection; reports read them in place
+    dwarfsql::QueryStats query_stats;
+    auto stats_report = [&] { return dwarfsql::format_stats(sessions, tables, query_stats); };
+
+    auto reload_module = [&](size_t m) {
+        std::string status = reload_session(*sessions[m].session, module_tables[m],
+                                            index_file_for(sessions[m].session->path()));
+        return sessions.size() > 1 ? sessions[m].name + ": " + status : status;
+    };
+
+#if defined(DWARFSQL_HAS_HTTP) || defined(DWARFSQL_HAS_MCP) || defined(DWARFSQL_HAS_DAEMON)
+    // Servers reload between requests; see BinaryWatcher
+    auto watch_pool = [&](dwarfsql::ConnectionPool& pool) -> std::unique_ptr<BinaryWatcher> {
+        if (!watch) return nullptr;
+        std::vector<std::string> watched;
+        for (size_t m = 0; m < sessions.size(); ++m) {
+            watched.push_back(sessions[m].session->path());
+        }
+        return std::make_unique<BinaryWatcher>(watched, [&reload_module, &pool](size_t m) {
+            pool.exclusive([&] { std::cerr << reload_module(m) << "\n"; });
+        });
+    };
+
+    // Each step holds a connection, so a --watch reload waits for it
+    auto prewarm_pool = [&](dwarfsql::ConnectionPool& pool) -> std::unique_ptr<dwarfsql::Prewarmer> {
+        if (!prewarm) return nullptr;
+        return std::make_unique<dwarfsql::Prewarmer>(sessions, tables, prewarm_tables, jobs,
+            [&pool](const std::function<void()>& step) {
+                auto lease = pool.acquire();
+                step();
+            });
+    };
+#else
+    (void)watch;
+    (void)prewarm;
+#endif
 
     // Set up signal handler
     std::signal(SIGINT, signal_handler);
@@ -420,7 +1347,20 @@ int main(int argc, char* argv[]) {
 #ifdef DWARFSQL_HAS_HTTP
     // HTTP server mode
     if (http_mode) {
-        return run_http_mode(db, binary_path, http_port, bind_addr);
+        dwarfsql::ConnectionPool pool(tables, 0);
+        auto watcher = watch_pool(pool);
+        auto warmer = prewarm_pool(pool);
+        auto status = [&warmer]() -> xsql::json {
+            if (!warmer) return xsql::json::object();
+            auto p = warmer->progress();
+            return {{"ready", p.finished},
+                    {"prewarm", {{"done", p.done}, {"total", p.total}, {"building", p.building},
+                                 {"warm", p.warm}, {"errors", p.errors},
+                                 {"elapsed_ms", p.elapsed_ns / 1000000}}}};
+        };
+        return run_http_mode(pool, sessions, query_stats, limits,
+                             [&] { return dwarfsql::format_metrics(sessions, tables, query_stats); },
+                             status, binaries, http_port, bind_addr);
     }
 #else
     if (http_mode) {
@@ -432,7 +1372,14 @@ int main(int argc, char* argv[]) {
 #ifdef DWARFSQL_HAS_MCP
     // MCP server mode
     if (mcp_mode) {
-        return run_mcp_mode(db, binary_path, mcp_port, bind_addr);
+        dwarfsql::ConnectionPool pool(tables, 0);
+        auto watcher = watch_pool(pool);
+        auto warmer = prewarm_pool(pool);
+        auto status = [&] {
+            std::string report = stats_report();
+            return warmer ? dwarfsql::format_prewarm(warmer->progress()) + "\n" + report : report;
+        };
+        return run_mcp_mode(pool, query_stats, limits, status, binaries, mcp_port, bind_addr);
     }
 #else
     if (mcp_mode) {
@@ -441,13 +1388,49 @@ int main(int argc, char* argv[]) {
     }
 #endif
 
+#ifdef DWARFSQL_HAS_DAEMON
+    // Daemon mode
+    if (daemon_mode) {
+        dwarfsql::ConnectionPool pool(tables, 0);
+        auto watcher = watch_pool(pool);
+        auto warmer = prewarm_pool(pool);
+        return run_daemon_mode(pool, sessions, canonical_paths, query_stats, limits, binaries, socket_path);
+    }
+#else
+    if (daemon_mode) {
+        std::cerr << "Error: Daemon mode not available. Rebuild with -DDWARFSQL_WITH_DAEMON=ON\n";
+        return 1;
+    }
+#endif
+
     // Interactive mode
     if (interactive || query.empty()) {
-        run_interactive(db, binary_path, verbose);
+        run_interactive(db, tables, query_stats, limits, binaries, verbose, [&] {
+            std::string status;
+            for (size_t m = 0; m < sessions.size(); ++m) {
+                status += (m > 0 ? "\n" : "") + reload_module(m);
+            }
+            return status;
+        }, stats_report);
         return 0;
     }
 
-    // Query mode
-    std::cout << execute_query(db, query) << "\n";
+    // Query mode; Ctrl+C stops the query, which then reports it failed
+    if (ndjson) {
+        QueryStream stream(db, query, query_stats, limits);
+        InterruptibleQuery running(stream.budget());
+        std::string chunk;
+        bool more = true;
+        while (more) {
+            chunk.clear();
+            more = stream.next(chunk);
+            std::cout << chunk;
+        }
+        std::cout.flush();
+        return 0;
+    }
+    dwarfsql::QueryBudget budget(limits);
+    InterruptibleQuery running(budget);
+    std::cout << execute_query(db, query, query_stats, budget) << "\n";
     return 0;
 }
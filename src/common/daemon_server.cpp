@@ -0,0 +1,337 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#include "daemon_server.hpp"
+
+#ifdef DWARFSQL_HAS_DAEMON
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+namespace dwarfsql {
+
+namespace {
+
+constexpr size_t MAX_REQUEST = 16 * 1024 * 1024;
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;  // A client that went away must not kill the daemon
+#else
+constexpr int SEND_FLAGS = 0;             // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+bool make_address(const std::string& path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+int open_socket() {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+#ifdef SO_NOSIGPIPE
+    if (fd >= 0) {
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    }
+#endif
+    return fd;
+}
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, SEND_FLAGS);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Bytes up to the first newline (dropped); rest gets whatever was read past it.
+// Gives up when a signal interrupts the read and cancelled() holds.
+bool read_line(int fd, std::string& line, std::string& rest, size_t limit,
+               const std::function<bool()>& cancelled = {}) {
+    char buf[64 * 1024];
+    line.clear();
+    for (;;) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR && !(cancelled && cancelled())) continue;
+        if (n <= 0) return false;
+        const char* end = static_cast<const char*>(std::memchr(buf, '\n', static_cast<size_t>(n)));
+        if (end) {
+            size_t used = static_cast<size_t>(end - buf);
+            line.append(buf, used);
+            rest.assign(end + 1, static_cast<size_t>(n) - used - 1);
+            return true;
+        }
+        line.append(buf, static_cast<size_t>(n));
+        if (line.size() > limit) return false;
+    }
+}
+
+} // namespace
+
+bool DwarfsqlDaemonServer::start(const std::string& socket_path, DaemonRequestCallback cb, int threads,
+                                 std::string& error) {
+    if (running_.load()) return true;
+
+    sockaddr_un addr;
+    if (!make_address(socket_path, addr)) {
+        error = "Socket path too long: " + socket_path;
+        return false;
+    }
+
+    // A socket nobody answers on was left by a daemon that did not exit cleanly
+    int probe = open_socket();
+    if (probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+        ::close(probe);
+        error = "A daemon is already listening on " + socket_path;
+        return false;
+    }
+    if (probe >= 0) ::close(probe);
+    ::unlink(socket_path.c_str());
+
+    listen_fd_ = open_socket();
+    if (listen_fd_ < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    // Only this user may connect
+    mode_t old_mask = ::umask(0177);
+    int rc = ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    ::umask(old_mask);
+    if (rc != 0 || ::listen(listen_fd_, 64) != 0 || ::pipe(wake_fds_) != 0) {
+        error = "Cannot listen on " + socket_path + ": " + std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    path_ = socket_path;
+    cb_ = std::move(cb);
+    running_.store(true);
+    acceptor_ = std::thread([this] { accept_loop(); });
+    for (int i = 0; i < std::max(threads, 1); ++i) {
+        workers_.emplace_back([this] { worker(); });
+    }
+    return true;
+}
+
+void DwarfsqlDaemonServer::stop() {
+    if (!running_.exchange(false)) return;
+
+    wake();
+    acceptor_.join();
+    ready_.notify_all();
+    for (auto& t : workers_) {
+        t.join();
+    }
+    workers_.clear();
+
+    for (int fd : pending_) {
+        ::close(fd);
+    }
+    pending_.clear();
+    watched_.clear();
+    ::close(listen_fd_);
+    ::close(wake_fds_[0]);
+    ::close(wake_fds_[1]);
+    listen_fd_ = wake_fds_[0] = wake_fds_[1] = -1;
+    ::unlink(path_.c_str());
+}
+
+void DwarfsqlDaemonServer::wake() {
+    char byte = 0;
+    (void)!::write(wake_fds_[1], &byte, 1);
+}
+
+void DwarfsqlDaemonServer::watch(int fd, std::function<void()> cancel) {
+    if (!cancel) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        watched_[fd] = std::move(cancel);
+    }
+    wake();  // To poll fd too
+}
+
+void DwarfsqlDaemonServer::unwatch(int fd) {
+    {
+        // Waits out a cancel() running on the acceptor, so the reply can go
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!watched_.erase(fd)) return;
+    }
+    // poll() holds on to the socket: until the acceptor lets go of it,
+    // closing fd would not end the connection
+    wake();
+}
+
+void DwarfsqlDaemonServer::accept_loop() {
+    std::vector<pollfd> fds;
+    while (running_.load()) {
+        // Watched connections are polled for nothing: POLLHUP comes regardless,
+        // once the client (which already shut down its side) closes the socket
+        fds.assign({{listen_fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}});
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& entry : watched_) {
+                fds.push_back({entry.first, 0, 0});
+            }
+        }
+        if (::poll(fds.data(), static_cast<nfds_t>(fds.size()), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) {
+            char buf[64];
+            (void)!::read(wake_fds_[0], buf, sizeof(buf));
+            continue;  // Stopping, or a connection to watch
+        }
+        for (size_t i = 2; i < fds.size(); ++i) {
+            if (!(fds[i].revents & (POLLHUP | POLLERR))) continue;
+            // Still the connection polled: a closed fd is reused only by accept() below
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = watched_.find(fds[i].fd);
+            if (it != watched_.end()) {
+                it->second();
+                watched_.erase(it);
+            }
+        }
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        // A client that connects and never sends must not hold a worker forever
+        timeval timeout{5, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(fd);
+        }
+        ready_.notify_one();
+    }
+}
+
+void DwarfsqlDaemonServer::worker() {
+    for (;;) {
+        int fd;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return !pending_.empty() || !running_.load(); });
+            if (!running_.load()) return;
+            fd = pending_.front();
+            pending_.pop_front();
+        }
+        serve(fd);
+        ::close(fd);
+    }
+}
+
+void DwarfsqlDaemonServer::serve(int fd) {
+    std::string request;
+    std::string rest;
+    if (!read_line(fd, request, rest, MAX_REQUEST)) return;
+
+    DaemonReply reply;
+    try {
+        reply = cb_(request);
+    } catch (const std::exception& e) {
+        reply.accepted = false;
+        reply.reason = e.what();
+    }
+    if (!reply.accepted || !reply.producer) {
+        std::string status = "refused: " + reply.reason + "\n";
+        write_all(fd, status.data(), status.size());
+        return;
+    }
+
+    if (!write_all(fd, "ok\n", 3)) return;
+    // A client gone while the query runs cancels it; one gone between
+    // chunks fails the next write, and dropping the producer ends the query
+    watch(fd, reply.cancel);
+    std::string chunk;
+    bool more = true;
+    while (more) {
+        chunk.clear();
+        more = reply.producer(chunk);
+        if (!chunk.empty() && !write_all(fd, chunk.data(), chunk.size())) break;
+    }
+    unwatch(fd);
+}
+
+std::string default_daemon_socket(const std::string& binary_path) {
+    std::error_code ec;
+    std::string path = std::filesystem::weakly_canonical(std::filesystem::absolute(binary_path, ec), ec).string();
+    if (ec) path = binary_path;
+
+    // FNV-1a of the resolved path: one socket per binary, however it is named
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : path) {
+        h = (h ^ c) * 0x100000001b3ULL;
+    }
+
+    const char* dir = std::getenv("XDG_RUNTIME_DIR");
+    char name[64];
+    std::snprintf(name, sizeof(name), "dwarfsql-%u-%016llx.sock",
+                  static_cast<unsigned>(::getuid()), static_cast<unsigned long long>(h));
+    return std::string(dir && *dir ? dir : "/tmp") + "/" + name;
+}
+
+bool daemon_request(const std::string& socket_path, const std::string& request,
+                    const std::function<void(const char* data, size_t size)>& sink,
+                    const std::function<bool()>& cancelled) {
+    // Anyone can create a socket in /tmp; only talk to one of our own
+    struct stat st;
+    if (::lstat(socket_path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode) || st.st_uid != ::getuid()) {
+        return false;
+    }
+
+    sockaddr_un addr;
+    if (!make_address(socket_path, addr)) return false;
+    int fd = open_socket();
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    std::string line = request + "\n";
+    std::string status;
+    std::string rest;
+    if (!write_all(fd, line.data(), line.size()) || ::shutdown(fd, SHUT_WR) != 0 ||
+        !read_line(fd, status, rest, 4096, cancelled) || status != "ok") {
+        ::close(fd);
+        return cancelled && cancelled();
+    }
+
+    if (!rest.empty()) sink(rest.data(), rest.size());
+    char buf[64 * 1024];
+    for (;;) {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR && !(cancelled && cancelled())) continue;
+        if (n <= 0) break;
+        sink(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return true;
+}
+
+} // namespace dwarfsql
+
+#endif // DWARFSQL_HAS_DAEMON
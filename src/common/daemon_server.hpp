@@ -0,0 +1,118 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * DwarfsqlDaemonServer - Local index service over a Unix domain socket
+ *
+ * A `--daemon` process opens the binaries once and keeps their index and
+ * table caches; short-lived `dwarfsql <binary> "<query>"` processes on the
+ * same host hand their query to it instead of parsing DWARF themselves.
+ *
+ * Protocol: the client writes one request line (JSON) and shuts down its
+ * side; the daemon answers with a status line, "ok" or "refused: <reason>",
+ * followed by the query output, and closes. A refused client runs the query
+ * itself. A client that hangs up before the output ends cancels the query.
+ */
+
+#ifdef DWARFSQL_HAS_DAEMON
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dwarfsql {
+
+/**
+ * Answer to one request
+ */
+struct DaemonReply {
+    bool accepted = false;
+    std::string reason;  // Why the request was refused
+    // Appends the next chunk of output, returns false after the last
+    std::function<bool(std::string& chunk)> producer;
+    // Stops producer early; called from another thread if the client hangs up
+    std::function<void()> cancel;
+};
+
+// Callback for one request line; runs on a server thread
+using DaemonRequestCallback = std::function<DaemonReply(const std::string& request)>;
+
+class DwarfsqlDaemonServer {
+public:
+    DwarfsqlDaemonServer() = default;
+    ~DwarfsqlDaemonServer() { stop(); }
+
+    // Non-copyable
+    DwarfsqlDaemonServer(const DwarfsqlDaemonServer&) = delete;
+    DwarfsqlDaemonServer& operator=(const DwarfsqlDaemonServer&) = delete;
+
+    /**
+     * Listen on socket_path, replacing a stale socket left there
+     *
+     * @param threads Requests served at once
+     * @return false with error set if the socket cannot be bound, or another
+     *         daemon already answers on it
+     */
+    bool start(const std::string& socket_path, DaemonRequestCallback cb, int threads, std::string& error);
+
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+    const std::string& path() const { return path_; }
+
+private:
+    void accept_loop();
+    void worker();
+    void serve(int fd);
+    void watch(int fd, std::function<void()> cancel);
+    void unwatch(int fd);
+    void wake();
+
+    std::string path_;
+    DaemonRequestCallback cb_;
+    std::atomic<bool> running_{false};
+    int listen_fd_ = -1;
+    int wake_fds_[2] = {-1, -1};  // Interrupts accept_loop() on stop()
+    std::thread acceptor_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<int> pending_;  // Accepted connections not yet served
+    // Connections being answered, and what to call if their client hangs up
+    std::unordered_map<int, std::function<void()>> watched_;
+};
+
+/**
+ * Socket a daemon for binary_path listens on by default: one per user and
+ * binary, under $XDG_RUNTIME_DIR (or /tmp)
+ */
+std::string default_daemon_socket(const std::string& binary_path);
+
+/**
+ * Send request to the daemon on socket_path and pass its output to sink
+ *
+ * When a signal interrupts the wait and cancelled() then holds, the socket is
+ * closed, which cancels the query in the daemon, and true is returned.
+ *
+ * @return false if no daemon owned by this user listens there or it refused
+ *         the request; nothing has been passed to sink then
+ */
+bool daemon_request(const std::string& socket_path, const std::string& request,
+                    const std::function<void(const char* data, size_t size)>& sink,
+                    const std::function<bool()>& cancelled = {});
+
+} // namespace dwarfsql
+
+#endif // DWARFSQL_HAS_DAEMON
@@ -34,6 +34,8 @@ struct CommandCallbacks {
     std::function<std::string(const std::string&)> get_schema;  // Return schema for table
     std::function<std::string()> get_info;        // Return database info
     std::function<std::string()> clear_session;   // Clear/reset session (agent, UI, etc.)
+    std::function<std::string()> reload;          // Reopen the binary if it was rebuilt
+    std::function<std::string()> get_stats;       // Per-table counters and query timing
 };
 
 /**
@@ -80,12 +82,24 @@ inline CommandResult handle_command(
         return CommandResult::HANDLED;
     }
 
+    if (input == ".reload") {
+        output = callbacks.reload ? callbacks.reload() : "Reload not supported";
+        return CommandResult::HANDLED;
+    }
+
+    if (input == ".stats") {
+        output = callbacks.get_stats ? callbacks.get_stats() : "Stats not available";
+        return CommandResult::HANDLED;
+    }
+
     if (input == ".help") {
         output = "DWARFSQL Commands:\n"
                  "  .tables         List all tables\n"
                  "  .schema <table> Show table schema\n"
                  "  .info           Show database info\n"
                  "  .clear          Clear/reset session\n"
+                 "  .reload         Reopen the binary if it was rebuilt\n"
+                 "  .stats          Show per-table counters and query timing\n"
                  "  .quit / .exit   Exit\n"
                  "  .help           Show this help\n"
                  "\n"
@@ -18,8 +18,11 @@ SQL interface for DWARF debug information via HTTP.
 Endpoints:
   GET  /         - Welcome message
   GET  /help     - This documentation
-  POST /query    - Execute SQL (body = raw SQL, response = JSON)
-  GET  /status   - Server health check
+  POST /query    - Execute SQL (body = raw SQL or a JSON request, response = JSON)
+  POST /query/stream - Execute SQL, rows streamed as NDJSON (chunked)
+  POST /symbolize - Resolve addresses (body = JSON array, response = JSON)
+  GET  /status   - Server health check (and --prewarm progress)
+  GET  /metrics  - Per-table counters and query latency (Prometheus text format)
   POST /shutdown - Stop server
 
 Tables:
@@ -37,14 +40,41 @@ Tables:
   base_classes        - Class inheritance
   inlined_calls       - Inlined function calls
   namespaces          - Namespace definitions
+  symbolize(pc)       - Function, inline chain and line for an address
+  callees_of(id, n)   - Call sites reached from a function, n levels deep
+  callers_of(id, n)   - Call sites reaching a function, n levels up
+  inline_stack(pc)    - Inlined calls enclosing an address
 
 Response Format:
   Success: {"success": true, "columns": [...], "rows": [[...]], "row_count": N}
   Error:   {"success": false, "error": "message"}
 
+Parameterized Queries:
+  Body: {"sql": "SELECT * FROM functions WHERE name = ?", "params": ["main"]}
+  Values bind in order to the ? placeholders of a single statement. Each
+  connection caches compiled statements by their SQL, so a repeated query
+  shape skips parsing and planning, with or without params.
+
+Stream Format (one JSON value per line):
+  {"statement_index": 0, "columns": [...]}
+  [...]                                   one array per row
+  {"statement_index": 0, "success": true, "row_count": N, "elapsed_ms": ms}
+  {"success": true, "statement_count": N, "row_count_total": N, ...}
+  A failed statement ends with {"statement_index": i, "success": false, "error": "..."}.
+
+Symbolize Format:
+  Request:  [4198964, "0x401234", ...]
+  Response: {"success": true, "count": N, "results": [{"address": A, "frames": [
+              {"depth": 0, "kind": "inline", "id": ..., "name": "...", "low_pc": ...,
+               "high_pc": ..., "file": "...", "line": L, "column": C}, ...]}]}
+  Frames are innermost first; an address nothing covers has no frames.
+
 Example:
   curl http://localhost:<port>/help
   curl -X POST http://localhost:<port>/query -d "SELECT name FROM functions LIMIT 5"
+  curl -X POST http://localhost:<port>/query -d '{"sql": "SELECT * FROM functions WHERE id = ?", "params": [4711]}'
+  curl -N -X POST http://localhost:<port>/query/stream -d "SELECT * FROM line_info"
+  curl -X POST http://localhost:<port>/symbolize -d "[\"0x401234\", \"0x401300\"]"
 )";
 
 int DwarfsqlHTTPServer::start(int port, HTTPQueryCallback query_cb,
@@ -60,9 +90,44 @@ int DwarfsqlHTTPServer::start(int port, HTTPQueryCallback query_cb,
     config.bind_address = bind_addr;
     config.query_fn = std::move(query_cb);
     config.use_queue = use_queue;
-    config.status_fn = []() {
-        return xsql::json{{"mode", "repl"}};
+    auto status_cb = status_cb_;
+    config.status_fn = [status_cb]() {
+        xsql::json status{{"mode", "repl"}};
+        if (status_cb) status.update(status_cb());
+        return status;
     };
+    if (symbolize_cb_ || metrics_cb_ || stream_cb_) {
+        auto symbolize_cb = symbolize_cb_;
+        auto metrics_cb = metrics_cb_;
+        auto stream_cb = stream_cb_;
+        config.setup_routes = [symbolize_cb, metrics_cb, stream_cb](httplib::Server& svr) {
+            if (symbolize_cb) {
+                svr.Post("/symbolize", [symbolize_cb](const httplib::Request& req, httplib::Response& res) {
+                    res.set_content(symbolize_cb(req.body), "application/json");
+                });
+            }
+            if (metrics_cb) {
+                svr.Get("/metrics", [metrics_cb](const httplib::Request&, httplib::Response& res) {
+                    res.set_content(metrics_cb(), "text/plain; version=0.0.4");
+                });
+            }
+            if (stream_cb) {
+                svr.Post("/query/stream", [stream_cb](const httplib::Request& req, httplib::Response& res) {
+                    // Runs on the connection's thread as it writes; dropping the
+                    // provider (done or disconnected) ends the query
+                    auto producer = std::make_shared<HTTPStreamProducer>(stream_cb(req.body));
+                    res.set_chunked_content_provider("application/x-ndjson",
+                        [producer](size_t, httplib::DataSink& sink) {
+                            std::string chunk;
+                            bool more = (*producer)(chunk);
+                            if (!chunk.empty() && !sink.write(chunk.data(), chunk.size())) return false;
+                            if (!more) sink.done();
+                            return true;
+                        });
+                });
+            }
+        };
+    }
 
     impl_ = std::make_unique<xsql::thinclient::http_query_server>(config);
     return impl_->start();
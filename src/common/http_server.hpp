@@ -23,9 +23,24 @@
 
 namespace dwarfsql {
 
-// Callback for handling SQL queries
+// Callback for POST /query (body = raw SQL, or {"sql": ..., "params": [...]})
 using HTTPQueryCallback = std::function<std::string(const std::string& sql)>;
 
+// Callback for POST /symbolize (body = JSON array of addresses, returns JSON)
+using HTTPSymbolizeCallback = std::function<std::string(const std::string& body)>;
+
+// Callback for GET /metrics (returns Prometheus text exposition format)
+using HTTPMetricsCallback = std::function<std::string()>;
+
+// Callback for GET /status (returns fields added to the status object)
+using HTTPStatusCallback = std::function<xsql::json()>;
+
+// Producer of a streamed response: appends the next chunk, returns false after the last
+using HTTPStreamProducer = std::function<bool(std::string& chunk)>;
+
+// Callback for POST /query/stream (body = raw SQL, returns the NDJSON producer)
+using HTTPStreamCallback = std::function<HTTPStreamProducer(const std::string& sql)>;
+
 class DwarfsqlHTTPServer {
 public:
     DwarfsqlHTTPServer() = default;
@@ -48,8 +63,24 @@ public:
 
     void set_interrupt_check(std::function<bool()> check);
 
+    // Enables POST /symbolize; call before start()
+    void set_symbolize_callback(HTTPSymbolizeCallback cb) { symbolize_cb_ = std::move(cb); }
+
+    // Enables GET /metrics; call before start()
+    void set_metrics_callback(HTTPMetricsCallback cb) { metrics_cb_ = std::move(cb); }
+
+    // Adds fields to GET /status; call before start()
+    void set_status_callback(HTTPStatusCallback cb) { status_cb_ = std::move(cb); }
+
+    // Enables POST /query/stream; call before start()
+    void set_stream_callback(HTTPStreamCallback cb) { stream_cb_ = std::move(cb); }
+
 private:
     std::unique_ptr<xsql::thinclient::http_query_server> impl_;
+    HTTPSymbolizeCallback symbolize_cb_;
+    HTTPMetricsCallback metrics_cb_;
+    HTTPStreamCallback stream_cb_;
+    HTTPStatusCallback status_cb_;
 };
 
 std::string format_http_info(int port);
@@ -92,6 +92,11 @@ int DwarfsqlMCPServer::start(int port, QueryCallback query_cb,
             {"query", {
                 {"type", "string"},
                 {"description", "SQL query to execute against the DWARF debug information database"}
+            }},
+            {"params", {
+                {"type", "array"},
+                {"description", "Values bound in order to the ? placeholders of a single-statement query; "
+                                "repeated query shapes then skip SQL compilation"}
             }}
         }},
         {"required", Json::array({"query"})}
@@ -120,6 +125,12 @@ int DwarfsqlMCPServer::start(int port, QueryCallback query_cb,
                 };
             }
 
+            // With params, the callback takes the same request object as POST /query
+            auto params = args.find("params");
+            if (params != args.end() && !params->is_null()) {
+                query = Json{{"sql", query}, {"params", *params}}.dump();
+            }
+
             std::string result;
             bool success = true;
 
@@ -155,6 +166,28 @@ int DwarfsqlMCPServer::start(int port, QueryCallback query_cb,
         {"dwarfsql_query", "Execute a SQL query against the DWARF debug information database and return results"}
     };
 
+    // Register dwarfsql_status tool - counters are atomic, so it skips the queue
+    if (status_cb_) {
+        const char* status_description =
+            "Report per-table build times, rows, DIEs visited and query latency of this server";
+        fastmcpp::tools::Tool status_tool{
+            "dwarfsql_status",
+            Json{{"type", "object"}, {"properties", Json::object()}},
+            query_output_schema,
+            [this](const Json&) -> Json {
+                return Json{
+                    {"content", Json::array({
+                        Json{{"type", "text"}, {"text", status_cb_()}}
+                    })},
+                    {"isError", false}
+                };
+            }
+        };
+        status_tool.set_description(status_description);
+        impl_->tool_manager.register_tool(status_tool);
+        descriptions["dwarfsql_status"] = status_description;
+    }
+
     auto handler = fastmcpp::mcp::make_mcp_handler(
         "dwarfsql",
         "1.0.0",
@@ -28,8 +28,11 @@
 namespace dwarfsql {
 
 // Callbacks for handling requests
-// QueryCallback: Direct SQL execution
+// QueryCallback: Direct SQL execution; the argument is raw SQL, or the
+// {"sql": ..., "params": [...]} request of a dwarfsql_query call with params
 using QueryCallback = std::function<std::string(const std::string& sql)>;
+// StatusCallback: Server statistics report; must be thread-safe, never queued
+using StatusCallback = std::function<std::string()>;
 
 // Internal command structure for cross-thread execution
 struct MCPPendingCommand {
@@ -101,6 +104,11 @@ public:
      */
     void set_interrupt_check(std::function<bool()> check);
 
+    /**
+     * Enable the dwarfsql_status tool; call before start()
+     */
+    void set_status_callback(StatusCallback cb) { status_cb_ = std::move(cb); }
+
     /**
      * Queue a command for execution on the main thread
      * Called by MCP tool handlers when use_queue=true
@@ -121,6 +129,7 @@ private:
 
     // Callbacks stored for execution
     QueryCallback query_cb_;
+    StatusCallback status_cb_;
 
     // Forward declaration - impl hides fastmcpp
     class Impl;
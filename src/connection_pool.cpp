@@ -0,0 +1,78 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * connection_pool.cpp - Read-only databases sharing one set of tables
+ */
+
+#include <dwarfsql/connection_pool.hpp>
+#include <dwarfsql/dwarf_tables.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace dwarfsql {
+
+ConnectionPool::ConnectionPool(std::vector<TableDef> defs, int size)
+    : defs_(std::move(defs))
+{
+    if (size <= 0) {
+        size = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    size_ = static_cast<size_t>(std::max(size, 1));
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (exclusive_ || idle_.empty()) {
+        if (!exclusive_ && databases_.size() < size_) {
+            auto conn = std::make_unique<Connection>();
+            conn->db = std::make_unique<xsql::Database>();
+            register_tables(*conn->db, defs_);
+            // The DWARF data is immutable; keep requests from writing to the connection
+            sqlite3_exec(conn->db->handle(), "PRAGMA query_only = 1", nullptr, nullptr, nullptr);
+            conn->statements = std::make_unique<StatementCache>(conn->db->handle());
+            databases_.push_back(std::move(conn));
+            return Lease(this, databases_.back().get());
+        }
+        released_.wait(lock);
+    }
+
+    Connection* conn = idle_.back();
+    idle_.pop_back();
+    return Lease(this, conn);
+}
+
+void ConnectionPool::release(Connection* conn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(conn);
+    }
+    // exclusive() may be waiting on this release as well as acquire()
+    released_.notify_all();
+}
+
+void ConnectionPool::exclusive(const std::function<void()>& fn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_.wait(lock, [this] { return !exclusive_; });
+    exclusive_ = true;
+    released_.wait(lock, [this] { return idle_.size() == databases_.size(); });
+    lock.unlock();
+
+    struct Done {
+        ConnectionPool* pool;
+        ~Done() {
+            {
+                std::lock_guard<std::mutex> lock(pool->mutex_);
+                pool->exclusive_ = false;
+            }
+            pool->released_.notify_all();
+        }
+    } done{this};
+    fn();
+}
+
+} // namespace dwarfsql
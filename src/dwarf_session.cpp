@@ -12,10 +12,17 @@
  */
 
 #include <dwarfsql/dwarf_session.hpp>
+#include <dwarfsql/address_index.hpp>
+#include <dwarfsql/index_file.hpp>
+#include <dwarfsql/query_budget.hpp>
+#include <dwarfsql/stats.hpp>
 
 #include <cstring>
 #include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #ifdef DWARFSQL_HAS_LIBDWARF
 #include <fcntl.h>
@@ -36,105 +43,117 @@ namespace dwarfsql {
 
 namespace {
 
-// Get string attribute from DIE
-std::string get_die_string(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr) {
-    Dwarf_Attribute at;
-    Dwarf_Error err = nullptr;
-
-    if (dwarf_attr(die, attr, &at, &err) != DW_DLV_OK) {
-        return "";
-    }
+// Decoders for one attribute, shared by the get_die_* helpers and DieAttrs
 
+bool form_string(Dwarf_Attribute at, std::string& out) {
     char* str = nullptr;
+    Dwarf_Error err = nullptr;
     if (dwarf_formstring(at, &str, &err) != DW_DLV_OK) {
-        dwarf_dealloc_attribute(at);
-        return "";
+        return false;
     }
-
-    std::string result(str);
-    dwarf_dealloc_attribute(at);
-    return result;
+    out = str;
+    return true;
 }
 
-// Get unsigned attribute from DIE
-uint64_t get_die_unsigned(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr, uint64_t default_val = 0) {
-    Dwarf_Attribute at;
+// String attribute as a view of libdwarf's copy of the section; empty if absent
+std::string_view form_view(Dwarf_Attribute at) {
+    char* str = nullptr;
     Dwarf_Error err = nullptr;
-
-    if (dwarf_attr(die, attr, &at, &err) != DW_DLV_OK) {
-        return default_val;
+    if (dwarf_formstring(at, &str, &err) != DW_DLV_OK || !str) {
+        return std::string_view();
     }
+    return std::string_view(str);
+}
 
+// Unsigned constant, or an address
+bool form_unsigned(Dwarf_Attribute at, uint64_t& out) {
+    Dwarf_Error err = nullptr;
     Dwarf_Unsigned val;
-    if (dwarf_formudata(at, &val, &err) != DW_DLV_OK) {
-        // Try as address
-        Dwarf_Addr addr;
-        if (dwarf_formaddr(at, &addr, &err) != DW_DLV_OK) {
-            dwarf_dealloc_attribute(at);
-            return default_val;
-        }
-        dwarf_dealloc_attribute(at);
-        return addr;
+    if (dwarf_formudata(at, &val, &err) == DW_DLV_OK) {
+        out = val;
+        return true;
     }
+    Dwarf_Addr addr;
+    if (dwarf_formaddr(at, &addr, &err) == DW_DLV_OK) {
+        out = addr;
+        return true;
+    }
+    return false;
+}
 
-    dwarf_dealloc_attribute(at);
-    return val;
+// Signed constant, or an unsigned one
+bool form_signed(Dwarf_Attribute at, int64_t& out) {
+    Dwarf_Error err = nullptr;
+    Dwarf_Signed val;
+    if (dwarf_formsdata(at, &val, &err) == DW_DLV_OK) {
+        out = val;
+        return true;
+    }
+    Dwarf_Unsigned uval;
+    if (dwarf_formudata(at, &uval, &err) == DW_DLV_OK) {
+        out = static_cast<int64_t>(uval);
+        return true;
+    }
+    return false;
+}
+
+bool form_flag(Dwarf_Attribute at) {
+    Dwarf_Bool flag = 0;
+    Dwarf_Error err = nullptr;
+    if (dwarf_formflag(at, &flag, &err) != DW_DLV_OK) {
+        return false;
+    }
+    return flag != 0;
 }
 
-// Get signed attribute from DIE
-int64_t get_die_signed(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr, int64_t default_val = -1) {
+// Get string attribute from DIE
+std::string get_die_string(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr) {
     Dwarf_Attribute at;
     Dwarf_Error err = nullptr;
 
     if (dwarf_attr(die, attr, &at, &err) != DW_DLV_OK) {
-        return default_val;
-    }
-
-    Dwarf_Signed val;
-    if (dwarf_formsdata(at, &val, &err) != DW_DLV_OK) {
-        // Try unsigned
-        Dwarf_Unsigned uval;
-        if (dwarf_formudata(at, &uval, &err) != DW_DLV_OK) {
-            dwarf_dealloc_attribute(at);
-            return default_val;
-        }
-        dwarf_dealloc_attribute(at);
-        return static_cast<int64_t>(uval);
+        return "";
     }
 
+    std::string result;
+    form_string(at, result);
     dwarf_dealloc_attribute(at);
-    return val;
+    return result;
 }
 
-// Check if DIE has attribute
-bool has_die_attr(Dwarf_Die die, Dwarf_Half attr) {
-    Dwarf_Bool has_attr = 0;
+// Interned string attribute from DIE
+InternedString get_die_interned(Dwarf_Die die, Dwarf_Half attr, StringPool& strings) {
+    Dwarf_Attribute at;
     Dwarf_Error err = nullptr;
-    if (dwarf_hasattr(die, attr, &has_attr, &err) != DW_DLV_OK) {
-        return false;
+
+    if (dwarf_attr(die, attr, &at, &err) != DW_DLV_OK) {
+        return InternedString();
     }
-    return has_attr != 0;
+
+    InternedString result = strings.intern(form_view(at));
+    dwarf_dealloc_attribute(at);
+    return result;
 }
 
-// Get flag attribute from DIE
-bool get_die_flag(Dwarf_Die die, Dwarf_Half attr) {
-    Dwarf_Bool flag = 0;
+// Get unsigned attribute from DIE
+uint64_t get_die_unsigned(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr, uint64_t default_val = 0) {
+    Dwarf_Attribute at;
     Dwarf_Error err = nullptr;
 
-    Dwarf_Attribute at;
     if (dwarf_attr(die, attr, &at, &err) != DW_DLV_OK) {
-        return false;
-    }
-
-    if (dwarf_formflag(at, &flag, &err) != DW_DLV_OK) {
-        dwarf_dealloc_attribute(at);
-        return false;
+        return default_val;
     }
 
+    uint64_t val = default_val;
+    form_unsigned(at, val);
     dwarf_dealloc_attribute(at);
-    return flag != 0;
+    return val;
 }
 
+// .debug_types (DWARF 4 type units) has an offset space of its own; its
+// DIEs carry this bit in every offset the session hands out
+constexpr uint64_t TYPES_SECTION_BIT = uint64_t(1) << 62;
+
 // Get DIE offset
 uint64_t get_die_offset(Dwarf_Die die) {
     Dwarf_Off off;
@@ -142,7 +161,19 @@ uint64_t get_die_offset(Dwarf_Die die) {
     if (dwarf_dieoffset(die, &off, &err) != DW_DLV_OK) {
         return 0;
     }
-    return off;
+    return dwarf_get_die_infotypes_flag(die) ? off : off | TYPES_SECTION_BIT;
+}
+
+// dwarf_offdie_b() for an offset from get_die_offset()
+int offdie(Dwarf_Debug dbg, uint64_t offset, Dwarf_Die* die, Dwarf_Error* err) {
+    ++decode_counters.offdie_calls;
+    bool is_info = (offset & TYPES_SECTION_BIT) == 0;
+    return dwarf_offdie_b(dbg, offset & ~TYPES_SECTION_BIT, is_info, die, err);
+}
+
+// Next sibling in the section die lives in
+int next_sibling(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Die* sibling, Dwarf_Error* err) {
+    return dwarf_siblingof_b(dbg, die, dwarf_get_die_infotypes_flag(die), sibling, err);
 }
 
 // Get DIE tag
@@ -155,63 +186,237 @@ int get_die_tag(Dwarf_Die die) {
     return tag;
 }
 
-// Get referenced DIE offset (for DW_AT_type, DW_AT_abstract_origin, etc.)
-uint64_t get_die_ref(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr) {
-    Dwarf_Attribute at;
+// Offset of the DIE a reference attribute of die points at, 0 if none.
+// cross_unit, if given, is set when the form can reach into another unit
+// (a signature names content, so a type unit reference does not count).
+uint64_t form_ref(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Attribute at, bool* cross_unit = nullptr) {
     Dwarf_Error err = nullptr;
-
-    if (dwarf_attr(die, attr, &at, &err) != DW_DLV_OK) {
-        return 0;
+    Dwarf_Half form = 0;
+    dwarf_whatform(at, &form, &err);
+    if (cross_unit && (form == DW_FORM_ref_addr || form == DW_FORM_GNU_ref_alt)) {
+        *cross_unit = true;
     }
 
-    Dwarf_Off off;
-    // Try CU-relative ref first, then global ref
-    if (dwarf_formref(at, &off, &err) != DW_DLV_OK) {
-        if (dwarf_global_formref(at, &off, &err) != DW_DLV_OK) {
-            dwarf_dealloc_attribute(at);
-            return 0;
+    // A type unit's type, named by signature (DW_AT_type or DW_AT_signature)
+    if (form == DW_FORM_ref_sig8) {
+        Dwarf_Sig8 sig;
+        Dwarf_Die target;
+        Dwarf_Bool is_info;
+        uint64_t off = 0;
+        if (dwarf_formsig8(at, &sig, &err) == DW_DLV_OK &&
+            dwarf_find_die_given_sig8(dbg, &sig, &target, &is_info, &err) == DW_DLV_OK) {
+            off = get_die_offset(target);
+            dwarf_dealloc_die(target);
         }
+        return off;
     }
 
-    dwarf_dealloc_attribute(at);
-    return off;
-}
-
-// Get high_pc considering both forms (address and offset from low_pc)
-uint64_t get_high_pc(Dwarf_Debug dbg, Dwarf_Die die, uint64_t low_pc) {
-    Dwarf_Attribute at;
-    Dwarf_Error err = nullptr;
-
-    if (dwarf_attr(die, DW_AT_high_pc, &at, &err) != DW_DLV_OK) {
+    // dwarf_formref() yields CU-relative offsets for DW_FORM_ref1..8, which
+    // dwarf_offdie_b() and the table ids do not use; always go global.
+    Dwarf_Off off;
+    if (dwarf_global_formref(at, &off, &err) != DW_DLV_OK) {
         return 0;
     }
+    // Only a unit-local reference stays in the section of die; DW_FORM_ref_addr
+    // points into .debug_info (or, GNU_ref_alt, the alternate file) from a type unit too
+    bool unit_local = form == DW_FORM_ref1 || form == DW_FORM_ref2 || form == DW_FORM_ref4 ||
+                      form == DW_FORM_ref8 || form == DW_FORM_ref_udata;
+    return unit_local && !dwarf_get_die_infotypes_flag(die) ? off | TYPES_SECTION_BIT : off;
+}
 
+// DW_AT_high_pc in either form: an address, or a constant offset from low_pc
+uint64_t form_high_pc(Dwarf_Attribute at, uint64_t low_pc) {
+    Dwarf_Error err = nullptr;
     Dwarf_Half form;
     if (dwarf_whatform(at, &form, &err) != DW_DLV_OK) {
-        dwarf_dealloc_attribute(at);
         return 0;
     }
 
-    uint64_t result = 0;
-
-    // Check if it's an address or a constant (offset)
     if (form == DW_FORM_addr) {
         Dwarf_Addr addr;
         if (dwarf_formaddr(at, &addr, &err) == DW_DLV_OK) {
-            result = addr;
+            return addr;
         }
     } else {
-        // It's a constant offset from low_pc
         Dwarf_Unsigned val;
         if (dwarf_formudata(at, &val, &err) == DW_DLV_OK) {
-            result = low_pc + val;
+            return low_pc + val;
+        }
+    }
+    return 0;
+}
+
+// Entries of DW_AT_ranges, each [low, high) with its base address applied:
+// DWARF 5 .debug_rnglists entries come cooked from libdwarf; DWARF 4
+// .debug_ranges entries are offsets from base (the unit's DW_AT_low_pc)
+// until a base address selection entry replaces it
+void form_ranges(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Attribute at, uint64_t base,
+                 std::vector<AddressRange>& out) {
+    Dwarf_Error err = nullptr;
+    Dwarf_Half form = 0;
+    Dwarf_Half version = 0;
+    Dwarf_Half offset_size = 0;
+    if (dwarf_whatform(at, &form, &err) != DW_DLV_OK ||
+        dwarf_get_version_of_die(die, &version, &offset_size) != DW_DLV_OK) {
+        return;
+    }
+
+    // DW_FORM_rnglistx indexes the unit's offset table; any other form is a section offset
+    Dwarf_Unsigned value = 0;
+    Dwarf_Off section_offset = 0;
+    if (form != DW_FORM_rnglistx && dwarf_global_formref(at, &section_offset, &err) == DW_DLV_OK) {
+        value = section_offset;
+    } else if (dwarf_formudata(at, &value, &err) != DW_DLV_OK) {
+        return;
+    }
+
+    if (form == DW_FORM_rnglistx || version >= 5) {
+        Dwarf_Rnglists_Head head = nullptr;
+        Dwarf_Unsigned count = 0;
+        Dwarf_Unsigned global_offset = 0;
+        if (dwarf_rnglists_get_rle_head(at, form, value, &head, &count, &global_offset, &err) != DW_DLV_OK) {
+            return;
         }
+        for (Dwarf_Unsigned i = 0; i < count; ++i) {
+            unsigned length = 0;
+            unsigned code = 0;
+            Dwarf_Unsigned raw_low = 0, raw_high = 0, low = 0, high = 0;
+            Dwarf_Bool no_addr = false;
+            if (dwarf_get_rnglists_entry_fields_a(head, i, &length, &code, &raw_low, &raw_high, &no_addr,
+                                                  &low, &high, &err) != DW_DLV_OK) {
+                break;
+            }
+            if (code == DW_RLE_end_of_list) break;
+            if (code == DW_RLE_base_address || code == DW_RLE_base_addressx || no_addr) continue;
+            if (low < high) out.push_back({low, high});
+        }
+        dwarf_dealloc_rnglists_head(head);
+        return;
+    }
+
+    Dwarf_Ranges* ranges = nullptr;
+    Dwarf_Signed count = 0;
+    Dwarf_Off real_offset = 0;
+    Dwarf_Unsigned bytes = 0;
+    if (dwarf_get_ranges_b(dbg, value, die, &real_offset, &ranges, &count, &bytes, &err) != DW_DLV_OK) {
+        return;
+    }
+    for (Dwarf_Signed i = 0; i < count; ++i) {
+        const Dwarf_Ranges& r = ranges[i];
+        if (r.dwr_type == DW_RANGES_END) break;
+        if (r.dwr_type == DW_RANGES_ADDRESS_SELECTION) {
+            base = r.dwr_addr2;
+        } else if (r.dwr_addr1 < r.dwr_addr2) {
+            out.push_back({base + r.dwr_addr1, base + r.dwr_addr2});
+        }
+    }
+    dwarf_dealloc_ranges(dbg, ranges, count);
+}
+
+// Get referenced DIE offset (for DW_AT_type, DW_AT_abstract_origin, etc.)
+uint64_t get_die_ref(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr, bool* cross_unit = nullptr) {
+    Dwarf_Attribute at;
+    Dwarf_Error err = nullptr;
+
+    if (dwarf_attr(die, attr, &at, &err) != DW_DLV_OK) {
+        return 0;
     }
 
+    uint64_t off = form_ref(dbg, die, at, cross_unit);
     dwarf_dealloc_attribute(at);
-    return result;
+    return off;
 }
 
+// Every attribute of one DIE, fetched with a single dwarf_attrlist().
+// dwarf_attr() walks the DIE's abbreviation and allocates an attribute on
+// each call; DIEs that read several attributes (the indexed ones read 3 to
+// 10) take them from this list instead. Accessors mirror the get_die_*
+// helpers, defaults included.
+class DieAttrs {
+public:
+    DieAttrs(Dwarf_Debug dbg, Dwarf_Die die) : dbg_(dbg), die_(die) {
+        Dwarf_Error err = nullptr;
+        if (dwarf_attrlist(die, &list_, &count_, &err) != DW_DLV_OK) {
+            list_ = nullptr;
+            count_ = 0;
+        }
+    }
+
+    ~DieAttrs() {
+        for (Dwarf_Signed i = 0; i < count_; ++i) {
+            dwarf_dealloc_attribute(list_[i]);
+        }
+        if (list_) {
+            dwarf_dealloc(dbg_, list_, DW_DLA_LIST);
+        }
+    }
+
+    DieAttrs(const DieAttrs&) = delete;
+    DieAttrs& operator=(const DieAttrs&) = delete;
+
+    Dwarf_Attribute find(Dwarf_Half attr) const {
+        Dwarf_Error err = nullptr;
+        for (Dwarf_Signed i = 0; i < count_; ++i) {
+            Dwarf_Half code;
+            if (dwarf_whatattr(list_[i], &code, &err) == DW_DLV_OK && code == attr) {
+                return list_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    bool has(Dwarf_Half attr) const { return find(attr) != nullptr; }
+
+    std::string string(Dwarf_Half attr) const {
+        std::string result;
+        if (Dwarf_Attribute at = find(attr)) form_string(at, result);
+        return result;
+    }
+
+    // String attribute copied straight into strings, with no std::string on the way
+    InternedString intern(Dwarf_Half attr, StringPool& strings) const {
+        Dwarf_Attribute at = find(attr);
+        return at ? strings.intern(form_view(at)) : InternedString();
+    }
+
+    uint64_t get_unsigned(Dwarf_Half attr, uint64_t default_val = 0) const {
+        uint64_t val = default_val;
+        if (Dwarf_Attribute at = find(attr)) form_unsigned(at, val);
+        return val;
+    }
+
+    int64_t get_signed(Dwarf_Half attr, int64_t default_val = -1) const {
+        int64_t val = default_val;
+        if (Dwarf_Attribute at = find(attr)) form_signed(at, val);
+        return val;
+    }
+
+    bool flag(Dwarf_Half attr) const {
+        Dwarf_Attribute at = find(attr);
+        return at && form_flag(at);
+    }
+
+    uint64_t ref(Dwarf_Half attr, bool* cross_unit = nullptr) const {
+        Dwarf_Attribute at = find(attr);
+        return at ? form_ref(dbg_, die_, at, cross_unit) : 0;
+    }
+
+    uint64_t high_pc(uint64_t low_pc) const {
+        Dwarf_Attribute at = find(DW_AT_high_pc);
+        return at ? form_high_pc(at, low_pc) : 0;
+    }
+
+    void ranges(uint64_t base, std::vector<AddressRange>& out) const {
+        if (Dwarf_Attribute at = find(DW_AT_ranges)) form_ranges(dbg_, die_, at, base, out);
+    }
+
+private:
+    Dwarf_Debug dbg_;
+    Dwarf_Die die_;
+    Dwarf_Attribute* list_ = nullptr;
+    Dwarf_Signed count_ = 0;
+};
+
 // Get location expression as string
 std::string get_location_string(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr) {
     Dwarf_Attribute at;
@@ -255,72 +460,143 @@ std::string get_location_string(Dwarf_Debug dbg, Dwarf_Die die, Dwarf_Half attr)
     return result;
 }
 
-// Get type name by following DW_AT_type reference
-std::string get_type_name(Dwarf_Debug dbg, Dwarf_Die die) {
-    uint64_t type_off = get_die_ref(dbg, die, DW_AT_type);
-    if (type_off == 0) {
-        return "void";
+// Render the type at type_off, memoizing it and every modifier hop on its chain.
+// Qualifiers are spliced in after the inner type's own qualifiers and
+// declarators appended, so "const T*" renders as before without re-walking T.
+const TypeNameCache::Entry& render_type(Dwarf_Debug dbg, uint64_t type_off, TypeNameCache& cache) {
+    auto found = cache.entries.find(type_off);
+    if (found != cache.entries.end()) {
+        ++decode_counters.type_cache_hits;
+        return found->second;
     }
-
-    Dwarf_Die type_die;
-    Dwarf_Bool is_info = true;
+    ++decode_counters.type_cache_misses;
+
+    // Walk inwards until a cached or named type, remembering the modifiers
+    struct Modifier {
+        uint64_t offset;
+        int tag;
+        bool cross_unit;  // Its DW_AT_type may lead into another unit
+    };
+    std::vector<Modifier> modifiers;
+    TypeNameCache::Entry base;
+    uint64_t off = type_off;
     Dwarf_Error err = nullptr;
 
-    if (dwarf_offdie_b(dbg, type_off, is_info, &type_die, &err) != DW_DLV_OK) {
-        return "<unknown>";
-    }
+    while (true) {
+        auto cached = cache.entries.find(off);
+        if (cached != cache.entries.end()) {
+            base = cached->second;
+            break;
+        }
+
+        Dwarf_Die type_die;
+        if (offdie(dbg, off, &type_die, &err) != DW_DLV_OK) {
+            base.text = "<unknown>";
+            cache.entries.emplace(off, base);
+            break;
+        }
 
-    std::string name = get_die_string(dbg, type_die, DW_AT_name);
-    int tag = get_die_tag(type_die);
+        std::string name = get_die_string(dbg, type_die, DW_AT_name);
+        int tag = get_die_tag(type_die);
 
-    // Handle modifiers
-    std::string prefix, suffix;
-    while (name.empty()) {
+        bool is_modifier = false;
         switch (tag) {
             case DW_TAG_pointer_type:
-                suffix = "*" + suffix;
-                break;
             case DW_TAG_reference_type:
-                suffix = "&" + suffix;
-                break;
             case DW_TAG_rvalue_reference_type:
-                suffix = "&&" + suffix;
-                break;
             case DW_TAG_const_type:
-                prefix = "const " + prefix;
-                break;
             case DW_TAG_volatile_type:
-                prefix = "volatile " + prefix;
-                break;
             case DW_TAG_restrict_type:
-                prefix = "restrict " + prefix;
-                break;
             case DW_TAG_array_type:
-                suffix = "[]" + suffix;
+                is_modifier = name.empty();
                 break;
             default:
-                dwarf_dealloc_die(type_die);
-                return prefix + "<anonymous>" + suffix;
+                break;
+        }
+
+        if (!is_modifier) {
+            base.text = name.empty() ? "<anonymous>" : std::move(name);
+            dwarf_dealloc_die(type_die);
+            cache.entries.emplace(off, base);
+            break;
         }
 
         // Follow the chain
-        type_off = get_die_ref(dbg, type_die, DW_AT_type);
+        bool cross_unit = false;
+        uint64_t next = get_die_ref(dbg, type_die, DW_AT_type, &cross_unit);
+        modifiers.push_back({off, tag, cross_unit});
         dwarf_dealloc_die(type_die);
 
-        if (type_off == 0) {
-            return prefix + "void" + suffix;
+        if (next == 0) {
+            base.text = "void";
+            break;
         }
+        off = next;
+    }
 
-        if (dwarf_offdie_b(dbg, type_off, is_info, &type_die, &err) != DW_DLV_OK) {
-            return prefix + "<unknown>" + suffix;
+    // Apply modifiers innermost first, caching each intermediate type
+    for (auto it = modifiers.rbegin(); it != modifiers.rend(); ++it) {
+        const char* qualifier = nullptr;
+        switch (it->tag) {
+            case DW_TAG_pointer_type:           base.text += "*"; break;
+            case DW_TAG_reference_type:         base.text += "&"; break;
+            case DW_TAG_rvalue_reference_type:  base.text += "&&"; break;
+            case DW_TAG_array_type:             base.text += "[]"; break;
+            case DW_TAG_const_type:             qualifier = "const "; break;
+            case DW_TAG_volatile_type:          qualifier = "volatile "; break;
+            case DW_TAG_restrict_type:          qualifier = "restrict "; break;
+        }
+        if (qualifier) {
+            base.text.insert(base.prefix_len, qualifier);
+            base.prefix_len += std::strlen(qualifier);
         }
+        base.cross_unit = base.cross_unit || it->cross_unit;
+        cache.entries[it->offset] = base;
+    }
+
+    return cache.entries[type_off];
+}
 
-        name = get_die_string(dbg, type_die, DW_AT_name);
-        tag = get_die_tag(type_die);
+// Interned type name from a DW_AT_type reference (0 when the DIE has none).
+// cross_unit, if given, is set when the name was read from another unit.
+InternedString get_type_name(Dwarf_Debug dbg, uint64_t type_off, TypeNameCache& cache,
+                             StringPool& strings, bool* cross_unit = nullptr) {
+    if (type_off == 0) {
+        return strings.intern("void");
     }
+    const TypeNameCache::Entry& entry = render_type(dbg, type_off, cache);
+    if (cross_unit && entry.cross_unit) *cross_unit = true;
+    return strings.intern(entry.text);
+}
+
+// DW_TAG_member row as get_struct_members() returns it
+DieInfo member_info(Dwarf_Debug dbg, Dwarf_Die die, TypeNameCache& type_names, StringPool& strings,
+                    bool* cross_unit = nullptr) {
+    DieAttrs attrs(dbg, die);
+    DieInfo info;
+    info.offset = get_die_offset(die);
+    info.tag = DW_TAG_member;
+    info.name = attrs.intern(DW_AT_name, strings);
+    info.type = get_type_name(dbg, attrs.ref(DW_AT_type, cross_unit), type_names, strings, cross_unit);
+
+    // Data member location (offset in struct), stored in low_pc
+    info.low_pc = attrs.get_unsigned(DW_AT_data_member_location, 0);
+
+    // Bit field info
+    info.byte_size = attrs.get_signed(DW_AT_bit_size, 0);
+    info.decl_line = static_cast<int>(attrs.get_signed(DW_AT_bit_offset, 0));
+    return info;
+}
 
-    dwarf_dealloc_die(type_die);
-    return prefix + name + suffix;
+// DW_TAG_enumerator row as get_enum_values() returns it
+DieInfo enumerator_info(Dwarf_Debug dbg, Dwarf_Die die, StringPool& strings) {
+    DieAttrs attrs(dbg, die);
+    DieInfo info;
+    info.offset = get_die_offset(die);
+    info.tag = DW_TAG_enumerator;
+    info.name = attrs.intern(DW_AT_name, strings);
+    info.byte_size = attrs.get_signed(DW_AT_const_value, 0);  // const_value stored in byte_size
+    return info;
 }
 
 // Access specifier to string
@@ -333,184 +609,752 @@ std::string access_to_string(int access) {
     }
 }
 
-// Recursive DIE traversal helper
-void traverse_die(Dwarf_Debug dbg, Dwarf_Die die, int depth,
-                  std::function<void(Dwarf_Die, int)> callback) {
-    callback(die, depth);
-
-    Dwarf_Die child;
+// One level of an explicit-stack DIE walk: the DIE visited at this depth
+// and the state its parent handed down to it and its siblings
+template <typename State>
+struct DieLevel {
+    Dwarf_Die die;
+    State state;
+};
+
+// Depth-first walk of every DIE below root, in DWARF order, without recursion.
+// enter(die, state, child) sees each DIE with the state it shares with its
+// siblings; child starts as a copy of state and becomes the state of die's
+// children, which are skipped if enter returns false. stack is scratch
+// space: reused across walks, it stops allocating once as deep as the
+// deepest tree. Stops early once query_cancelled(), which the caller
+// checks to tell a cut walk from a finished one.
+template <typename State, typename Enter>
+void walk_dies(Dwarf_Debug dbg, Dwarf_Die root, const State& root_state,
+               std::vector<DieLevel<State>>& stack, Enter&& enter) {
     Dwarf_Error err = nullptr;
+    stack.clear();
 
-    if (dwarf_child(die, &child, &err) == DW_DLV_OK) {
-        traverse_die(dbg, child, depth + 1, callback);
+    Dwarf_Die first;
+    if (dwarf_child(root, &first, &err) != DW_DLV_OK) {
+        return;
+    }
+    stack.push_back({first, root_state});
+
+    State child_state;
+    uint32_t visited = 0;
+    while (!stack.empty()) {
+        // Often enough to stop within milliseconds, rarely enough to cost nothing
+        if ((++visited & 1023) == 0 && query_cancelled()) {
+            for (auto& open : stack) {
+                dwarf_dealloc_die(open.die);
+            }
+            stack.clear();
+            return;
+        }
+        DieLevel<State>& level = stack.back();
+        ++decode_counters.dies_visited;
+        child_state = level.state;
+        if (enter(level.die, level.state, child_state)) {
+            Dwarf_Die child;
+            if (dwarf_child(level.die, &child, &err) == DW_DLV_OK) {
+                stack.push_back({child, child_state});
+                continue;
+            }
+        }
 
-        Dwarf_Die sibling;
-        while (dwarf_siblingof_b(dbg, child, true, &sibling, &err) == DW_DLV_OK) {
-            dwarf_dealloc_die(child);
-            child = sibling;
-            traverse_die(dbg, child, depth + 1, callback);
+        // Subtree done: step to the next sibling, closing finished levels
+        while (!stack.empty()) {
+            DieLevel<State>& top = stack.back();
+            Dwarf_Die sibling;
+            int res = next_sibling(dbg, top.die, &sibling, &err);
+            dwarf_dealloc_die(top.die);
+            if (res == DW_DLV_OK) {
+                top.die = sibling;
+                break;
+            }
+            stack.pop_back();
         }
-        dwarf_dealloc_die(child);
     }
 }
 
-} // anonymous namespace
-
-#endif // DWARFSQL_HAS_LIBDWARF
+constexpr size_t NO_ROW = static_cast<size_t>(-1);
+
+// Enclosing-scope state carried down the tree by the indexing walk
+struct IndexScope {
+    int tag = 0;                             // Of the DIE whose children this scope covers
+    uint64_t offset = 0;                     // Of that DIE
+    uint64_t cu_offset = 0;
+    uint64_t func_offset = 0;                // Innermost DW_TAG_subprogram
+    size_t func_row = NO_ROW;                // Its DwarfIndex::functions row
+    int param_index = 0;                     // Next formal_parameter index among these siblings
+    uint64_t scope_low_pc = 0;               // Innermost subprogram/lexical block range
+    uint64_t scope_high_pc = 0;
+    uint64_t class_offset = 0;               // Innermost struct/class, for DW_TAG_inheritance
+    size_t class_row = NO_ROW;               // Its DwarfIndex::structs row
+    uint64_t namespace_offset = 0;
+    uint64_t inline_offset = 0;              // Innermost DW_TAG_inlined_subroutine of that subprogram
+};
+
+// Per-thread state of an indexing walk
+struct IndexContext {
+    Dwarf_Debug dbg;
+    TypeNameCache& type_names;
+    StringPool& strings;
+    DwarfIndex& out;
+    ElfObject* object = nullptr;   // Holds dbg's sections, if mapped; for unit_hash()
+    bool cross_unit = false;       // The unit being indexed read DIEs of other units
+    std::vector<DieLevel<IndexScope>> stack = {};
+    std::unordered_map<uint64_t, InternedString> origin_names = {};  // See origin_name()
+    std::unordered_map<uint64_t, uint64_t> unit_bases = {};          // See unit_base()
+
+    InternedString type_of(const DieAttrs& attrs) {
+        return get_type_name(dbg, attrs.ref(DW_AT_type, &cross_unit), type_names, strings, &cross_unit);
+    }
 
-// ============================================================================
-// DwarfSession implementation
-// ============================================================================
+    InternedString name_of(const DieAttrs& attrs, Dwarf_Half attr = DW_AT_name) {
+        return attrs.intern(attr, strings);
+    }
 
-DwarfSession::~DwarfSession() {
-    close();
-}
+    // For references whose offset lands in a row. A type unit's name is
+    // fixed by its signature, but its offset moves with the units before it.
+    uint64_t ref(const DieAttrs& attrs, Dwarf_Half attr) {
+        Dwarf_Attribute at = attrs.find(attr);
+        Dwarf_Half form = 0;
+        Dwarf_Error err = nullptr;
+        if (at && dwarf_whatform(at, &form, &err) == DW_DLV_OK && form == DW_FORM_ref_sig8) {
+            cross_unit = true;
+        }
+        return attrs.ref(attr, &cross_unit);
+    }
 
-DwarfSession::DwarfSession(DwarfSession&& other) noexcept
-    : dbg_(other.dbg_)
-    , fd_(other.fd_)
-    , is_open_(other.is_open_)
-    , path_(std::move(other.path_))
-    , last_error_(std::move(other.last_error_))
-{
-    other.dbg_ = nullptr;
-    other.fd_ = -1;
-    other.is_open_ = false;
-}
+    // DW_AT_name of a call site's callee or an inlined call's origin. The
+    // same few callees recur across a unit, so each DIE is read once a walk.
+    InternedString origin_name(uint64_t offset) {
+        auto it = origin_names.find(offset);
+        if (it != origin_names.end()) return it->second;
 
-DwarfSession& DwarfSession::operator=(DwarfSession&& other) noexcept {
-    if (this != &other) {
-        close();
-        dbg_ = other.dbg_;
-        fd_ = other.fd_;
-        is_open_ = other.is_open_;
-        path_ = std::move(other.path_);
-        last_error_ = std::move(other.last_error_);
-        other.dbg_ = nullptr;
-        other.fd_ = -1;
-        other.is_open_ = false;
+        InternedString name;
+        Dwarf_Die die;
+        Dwarf_Error err = nullptr;
+        if (offdie(dbg, offset, &die, &err) == DW_DLV_OK) {
+            name = get_die_interned(die, DW_AT_name, strings);
+            dwarf_dealloc_die(die);
+        }
+        return origin_names.emplace(offset, name).first->second;
     }
-    return *this;
-}
 
-bool DwarfSession::open(const std::string& path) {
-#ifdef DWARFSQL_HAS_LIBDWARF
-    close();
+    // DW_AT_low_pc of the unit at cu_offset: the base of its DWARF 4 range lists
+    uint64_t unit_base(uint64_t cu_offset) {
+        auto it = unit_bases.find(cu_offset);
+        if (it != unit_bases.end()) return it->second;
 
-    fd_ = ::open(path.c_str(), O_RDONLY);
-    if (fd_ < 0) {
-        last_error_ = "Failed to open file: " + path;
-        return false;
+        uint64_t base = 0;
+        Dwarf_Die cu_die;
+        Dwarf_Error err = nullptr;
+        if (offdie(dbg, cu_offset, &cu_die, &err) == DW_DLV_OK) {
+            base = get_die_unsigned(dbg, cu_die, DW_AT_low_pc, 0);
+            dwarf_dealloc_die(cu_die);
+        }
+        return unit_bases.emplace(cu_offset, base).first->second;
+    }
+
+    // Record the DW_AT_ranges entries of the DIE at offset in
+    // out.address_ranges, and widen low/high to span them
+    void add_ranges(const DieAttrs& attrs, uint64_t offset, uint64_t cu_offset, uint64_t& low, uint64_t& high) {
+        std::vector<AddressRange> ranges;
+        attrs.ranges(unit_base(cu_offset), ranges);
+        if (ranges.empty()) return;
+
+        low = ranges[0].low;
+        high = ranges[0].high;
+        for (const AddressRange& r : ranges) {
+            low = std::min(low, r.low);
+            high = std::max(high, r.high);
+        }
+        out.address_ranges[offset] = std::move(ranges);
     }
+};
+
+bool index_die(IndexContext& ctx, Dwarf_Die die, IndexScope& scope, IndexScope& inner);
+
+// Index every DIE below die, whose children are covered by scope
+void index_children(IndexContext& ctx, Dwarf_Die die, const IndexScope& scope) {
+    walk_dies(ctx.dbg, die, scope, ctx.stack,
+              [&ctx](Dwarf_Die child, IndexScope& siblings, IndexScope& inner) {
+                  return index_die(ctx, child, siblings, inner);
+              });
+}
 
+// Record one DIE in every table it belongs to and set up inner, the scope
+// of its children. Each DIE is decoded once here; all DwarfIndex vectors
+// are filled together.
+// @return false if nothing below die is indexed, so the walk skips it
+bool index_die(IndexContext& ctx, Dwarf_Die die, IndexScope& scope, IndexScope& inner) {
+    Dwarf_Debug dbg = ctx.dbg;
+    DwarfIndex& out = ctx.out;
     Dwarf_Error err = nullptr;
-    unsigned int group_number = DW_GROUPNUMBER_ANY;
+    int tag = get_die_tag(die);
+    uint64_t offset = get_die_offset(die);
+    int parent_tag = scope.tag;
 
-    int res = dwarf_init_b(fd_, DW_DLC_READ, group_number, nullptr, nullptr, &dbg_, &err);
+    inner.tag = tag;
+    inner.offset = offset;
 
-    if (res == DW_DLV_NO_ENTRY) {
-        last_error_ = "No DWARF debug info found in: " + path;
-        ::close(fd_);
-        fd_ = -1;
-        return false;
-    }
+    switch (tag) {
+        case DW_TAG_subprogram: {
+            DieAttrs attrs(dbg, die);
+            DieInfo info;
+            info.offset = offset;
+            info.cu_offset = scope.cu_offset;
+            info.tag = tag;
+            info.name = ctx.name_of(attrs);
+            info.linkage_name = ctx.name_of(attrs, DW_AT_linkage_name);
+            if (info.linkage_name.empty()) {
+                info.linkage_name = ctx.name_of(attrs, DW_AT_MIPS_linkage_name);
+            }
+            info.low_pc = attrs.get_unsigned(DW_AT_low_pc, 0);
+            info.high_pc = attrs.high_pc(info.low_pc);
+            if (attrs.has(DW_AT_ranges)) {
+                ctx.add_ranges(attrs, offset, scope.cu_offset, info.low_pc, info.high_pc);
+            }
+            info.type = ctx.type_of(attrs);
+            info.decl_line = static_cast<int>(attrs.get_signed(DW_AT_decl_line, 0));
+            info.is_external = attrs.flag(DW_AT_external);
+            info.is_declaration = attrs.flag(DW_AT_declaration);
+            info.origin_offset = ctx.ref(attrs, DW_AT_specification);
+            if (info.origin_offset == 0) {
+                info.origin_offset = ctx.ref(attrs, DW_AT_abstract_origin);
+            }
 
-    if (res != DW_DLV_OK) {
-        last_error_ = "Failed to initialize DWARF: ";
-        if (err) {
-            last_error_ += dwarf_errmsg(err);
-            dwarf_dealloc_error(dbg_, err);
+            uint64_t inl = attrs.get_unsigned(DW_AT_inline, DW_INL_not_inlined);
+            info.is_inline = (inl == DW_INL_declared_inlined || inl == DW_INL_declared_not_inlined);
+
+            inner.func_offset = offset;
+            inner.func_row = out.functions.size();
+            inner.inline_offset = 0;
+            inner.param_index = 0;
+            inner.scope_low_pc = info.low_pc;
+            inner.scope_high_pc = info.high_pc;
+
+            out.functions.push_back(std::move(info));
+            break;
         }
-        ::close(fd_);
-        fd_ = -1;
-        return false;
+
+        case DW_TAG_lexical_block: {
+            DieAttrs attrs(dbg, die);
+            inner.scope_low_pc = attrs.get_unsigned(DW_AT_low_pc, 0);
+            inner.scope_high_pc = attrs.high_pc(inner.scope_low_pc);
+            break;
+        }
+
+        case DW_TAG_variable:
+        case DW_TAG_formal_parameter: {
+            DieAttrs attrs(dbg, die);
+            DieInfo info;
+            info.offset = offset;
+            info.cu_offset = scope.cu_offset;
+            info.func_offset = scope.func_offset;
+            info.tag = tag;
+            info.name = ctx.name_of(attrs);
+            info.type = ctx.type_of(attrs);
+            info.decl_line = static_cast<int>(attrs.get_signed(DW_AT_decl_line, 0));
+            info.is_external = attrs.flag(DW_AT_external);
+
+            // Only direct children of a subprogram are its parameters;
+            // subroutine types and inlined copies carry their own.
+            if (tag == DW_TAG_formal_parameter && parent_tag == DW_TAG_subprogram) {
+                ParameterInfo param;
+                param.offset = offset;
+                param.func_offset = scope.func_offset;
+                param.name = info.name;
+                param.type = info.type;
+                param.index = scope.param_index++;
+                out.parameters.push_back(std::move(param));
+            } else if (tag == DW_TAG_variable && scope.func_offset != 0) {
+                LocalVarInfo local;
+                local.offset = offset;
+                local.func_offset = scope.func_offset;
+                local.name = info.name;
+                local.type = info.type;
+                local.decl_line = info.decl_line;
+                local.scope_low_pc = scope.scope_low_pc;
+                local.scope_high_pc = scope.scope_high_pc;
+                out.local_variables.push_back(std::move(local));
+            }
+
+            out.variables.push_back(std::move(info));
+            break;
+        }
+
+        case DW_TAG_base_type:
+        case DW_TAG_typedef:
+        case DW_TAG_pointer_type:
+        case DW_TAG_reference_type:
+        case DW_TAG_rvalue_reference_type:
+        case DW_TAG_const_type:
+        case DW_TAG_volatile_type:
+        case DW_TAG_array_type: {
+            DieAttrs attrs(dbg, die);
+            DieInfo info;
+            info.offset = offset;
+            info.cu_offset = scope.cu_offset;
+            info.tag = tag;
+            info.name = ctx.name_of(attrs);
+            info.byte_size = attrs.get_signed(DW_AT_byte_size, -1);
+            out.types.push_back(std::move(info));
+            // Below these are only subranges and the like, none indexed
+            return false;
+        }
+
+        case DW_TAG_structure_type:
+        case DW_TAG_class_type:
+        case DW_TAG_union_type: {
+            DieAttrs attrs(dbg, die);
+            DieInfo info;
+            info.offset = offset;
+            info.cu_offset = scope.cu_offset;
+            info.tag = tag;
+            info.name = ctx.name_of(attrs);
+            info.byte_size = attrs.get_signed(DW_AT_byte_size, -1);
+            info.is_declaration = attrs.flag(DW_AT_declaration);
+
+            // A stub naming its type unit; the unit holds the one definition row
+            bool stub = attrs.has(DW_AT_signature);
+
+            if (tag != DW_TAG_union_type) {
+                inner.class_offset = offset;
+                inner.class_row = stub ? NO_ROW : out.structs.size();
+            }
+
+            if (!stub) {
+                out.structs.push_back(std::move(info));
+            }
+            break;
+        }
+
+        case DW_TAG_enumeration_type: {
+            DieAttrs attrs(dbg, die);
+            DieInfo info;
+            info.offset = offset;
+            info.cu_offset = scope.cu_offset;
+            info.tag = tag;
+            info.name = ctx.name_of(attrs);
+            info.byte_size = attrs.get_signed(DW_AT_byte_size, -1);
+            if (!attrs.has(DW_AT_signature)) {
+                out.enums.push_back(std::move(info));
+            }
+            break;
+        }
+
+        case DW_TAG_member:
+            if (parent_tag == DW_TAG_structure_type || parent_tag == DW_TAG_class_type ||
+                parent_tag == DW_TAG_union_type) {
+                out.struct_members[scope.offset].push_back(
+                    member_info(dbg, die, ctx.type_names, ctx.strings, &ctx.cross_unit));
+            }
+            return false;
+
+        case DW_TAG_enumerator:
+            if (parent_tag == DW_TAG_enumeration_type) {
+                out.enum_values[scope.offset].push_back(enumerator_info(dbg, die, ctx.strings));
+            }
+            return false;
+
+        case DW_TAG_inheritance: {
+            DieAttrs attrs(dbg, die);
+            BaseClassInfo info;
+            info.derived_offset = scope.class_offset;
+            if (scope.class_row != NO_ROW) info.derived_name = out.structs[scope.class_row].name;
+            info.base_offset = ctx.ref(attrs, DW_AT_type);
+
+            // Get base class name by following the type reference
+            Dwarf_Die base_die;
+            if (offdie(dbg, info.base_offset, &base_die, &err) == DW_DLV_OK) {
+                info.base_name = get_die_interned(base_die, DW_AT_name, ctx.strings);
+                dwarf_dealloc_die(base_die);
+            }
+
+            info.data_member_offset = attrs.get_signed(DW_AT_data_member_location, 0);
+            info.is_virtual = attrs.has(DW_AT_virtuality);
+            info.access = static_cast<int>(attrs.get_unsigned(DW_AT_accessibility, DW_ACCESS_private));
+            out.base_classes.push_back(std::move(info));
+            break;
+        }
+
+        case DW_TAG_call_site:
+        case DW_TAG_GNU_call_site: {
+            DieAttrs attrs(dbg, die);
+            CallInfo info;
+            info.caller_offset = scope.func_offset;
+            if (scope.func_row != NO_ROW) info.caller_name = out.functions[scope.func_row].name;
+
+            // Get callee through DW_AT_call_origin
+            uint64_t callee_off = ctx.ref(attrs, DW_AT_call_origin);
+            if (callee_off == 0) {
+                callee_off = ctx.ref(attrs, DW_AT_abstract_origin);
+            }
+
+            if (callee_off != 0) {
+                info.callee_offset = callee_off;
+                info.callee_name = ctx.origin_name(callee_off);
+            }
+
+            info.call_pc = attrs.get_unsigned(DW_AT_call_return_pc, 0);
+            if (info.call_pc == 0) {
+                info.call_pc = attrs.get_unsigned(DW_AT_low_pc, 0);
+            }
+            info.call_line = static_cast<int>(attrs.get_signed(DW_AT_call_line, 0));
+            info.is_tail_call = attrs.flag(DW_AT_call_tail_call);
+            out.calls.push_back(std::move(info));
+            // Its DW_TAG_call_site_parameter children are not indexed
+            return false;
+        }
+
+        case DW_TAG_inlined_subroutine: {
+            DieAttrs attrs(dbg, die);
+            InlinedCallInfo info;
+            info.offset = offset;
+            info.abstract_origin = ctx.ref(attrs, DW_AT_abstract_origin);
+            info.caller_offset = scope.func_offset;
+            info.parent_offset = scope.inline_offset;
+            inner.inline_offset = offset;
+
+            // Get name from abstract origin
+            if (info.abstract_origin != 0) {
+                info.name = ctx.origin_name(info.abstract_origin);
+            }
+
+            info.low_pc = attrs.get_unsigned(DW_AT_low_pc, 0);
+            info.high_pc = attrs.high_pc(info.low_pc);
+            if (attrs.has(DW_AT_ranges)) {
+                ctx.add_ranges(attrs, offset, scope.cu_offset, info.low_pc, info.high_pc);
+            }
+            info.call_line = static_cast<int>(attrs.get_signed(DW_AT_call_line, 0));
+            info.call_column = static_cast<int>(attrs.get_signed(DW_AT_call_column, 0));
+            out.inlined_calls.push_back(std::move(info));
+            break;
+        }
+
+        case DW_TAG_namespace: {
+            DieAttrs attrs(dbg, die);
+            NamespaceInfo info;
+            info.offset = offset;
+            info.name = ctx.name_of(attrs);
+            info.parent_offset = scope.namespace_offset;
+            info.is_anonymous = info.name.empty();
+            out.namespaces.push_back(std::move(info));
+
+            inner.namespace_offset = offset;
+            break;
+        }
+
+        default:
+            break;
     }
 
-    path_ = path;
-    is_open_ = true;
     return true;
-#else
-    last_error_ = "libdwarf not available";
-    return false;
-#endif
 }
 
-void DwarfSession::close() {
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (dbg_) {
-        Dwarf_Error err = nullptr;
-        dwarf_finish(dbg_, &err);
-        dbg_ = nullptr;
+// ============================================================================
+// Unit fingerprints (see DwarfSession::reload())
+// ============================================================================
+
+// FNV-1a over 8-byte words, then the tail bytes; only ever compared with itself
+uint64_t hash_bytes(const uint8_t* p, uint64_t n, uint64_t h = 0xcbf29ce484222325ULL) {
+    constexpr uint64_t prime = 0x100000001b3ULL;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ word) * prime;
+        h ^= h >> 29;
     }
-    if (fd_ >= 0) {
-#ifdef _WIN32
-        _close(fd_);
-#else
-        ::close(fd_);
-#endif
-        fd_ = -1;
+    for (; n > 0; ++p, --n) {
+        h = (h ^ *p) * prime;
     }
-#endif
-    is_open_ = false;
-    path_.clear();
+    return h;
 }
 
-std::vector<CompilationUnit> DwarfSession::get_compilation_units() const {
-    std::vector<CompilationUnit> result;
+// Section of a main binary or, failing that, of a split package
+const uint8_t* unit_section(ElfObject& object, const char* name, uint64_t& size) {
+    const uint8_t* data = object.section_data(name, size);
+    if (!data) data = object.section_data((std::string(name) + ".dwo").c_str(), size);
+    return data;
+}
 
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+// Hash of the bytes the unit's rows are decoded from that belong to the
+// unit alone: the unit itself and its DWARF 5 .debug_addr contribution.
+// 0 if the sections are not mapped.
+uint64_t unit_hash(ElfObject* object, Dwarf_Die cu_die) {
+    if (!object) return 0;
 
     Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
+    Dwarf_Off begin = 0;
+    Dwarf_Off length = 0;
+    if (dwarf_die_CU_offset_range(cu_die, &begin, &length, &err) != DW_DLV_OK) {
+        return 0;
+    }
 
-    bool is_info = true;
+    uint64_t size = 0;
+    const char* name = dwarf_get_die_infotypes_flag(cu_die) ? ".debug_info" : ".debug_types";
+    const uint8_t* data = unit_section(*object, name, size);
+    if (!data || begin > size || length > size - begin) return 0;
+    uint64_t h = hash_bytes(data + begin, length);
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+    // DW_FORM_addrx values index the contribution at DW_AT_addr_base, which
+    // follows its 8-byte header (32-bit unit_length, version, sizes)
+    Dwarf_Attribute at;
+    if (dwarf_attr(cu_die, DW_AT_addr_base, &at, &err) == DW_DLV_OK) {
+        Dwarf_Off base = 0;
+        bool found = dwarf_global_formref(at, &base, &err) == DW_DLV_OK;
+        dwarf_dealloc_attribute(at);
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
+        uint64_t addr_size = 0;
+        const uint8_t* addr = found ? object->section_data(".debug_addr", addr_size) : nullptr;
+        if (!addr || base < 8 || base > addr_size) return 0;
+
+        const uint8_t* p = addr + base - 8;
+        uint64_t unit_length = object->little_endian()
+            ? (uint64_t(p[0]) | uint64_t(p[1]) << 8 | uint64_t(p[2]) << 16 | uint64_t(p[3]) << 24)
+            : (uint64_t(p[3]) | uint64_t(p[2]) << 8 | uint64_t(p[1]) << 16 | uint64_t(p[0]) << 24);
+        uint64_t end = base - 4 + unit_length;
+        if (end < base || end > addr_size) end = addr_size;  // 64-bit DWARF or malformed: the rest
+        h = hash_bytes(addr + base, end - base, h);
+    }
+    return h;
+}
+
+// Hash of the sections units share, which unit_hash() leaves out: strings
+// and abbreviations, and for a split package the skeleton units and the
+// addresses they resolve. 0 if any of it is not mapped.
+uint64_t shared_sections_hash(ElfObject* object, ElfObject* skeletons, bool split) {
+    if (!object || (split && !skeletons)) return 0;
+
+    static const char* const shared[] = {
+        ".debug_abbrev", ".debug_str", ".debug_line_str", ".debug_str_offsets",
+    };
+    uint64_t h = hash_bytes(nullptr, 0);
+    for (const char* name : shared) {
+        uint64_t size = 0;
+        const uint8_t* data = unit_section(*object, name, size);
+        h = data ? hash_bytes(data, size, h ^ size) : h * 31;
+    }
+    if (split) {
+        for (const char* name : {".debug_info", ".debug_addr"}) {
+            uint64_t size = 0;
+            const uint8_t* data = skeletons->section_data(name, size);
+            h = data ? hash_bytes(data, size, h ^ size) : h * 31;
+        }
+    }
+    return h == 0 ? 1 : h;
+}
+
+// True if rows of a and b, before and after a rebuild, are the same.
+// Offsets must match too: every row holds absolute DIE offsets.
+bool same_unit(const CompilationUnit& a, const CompilationUnit& b) {
+    return a.offset == b.offset && a.content_hash != 0 && a.content_hash == b.content_hash &&
+           a.name == b.name && a.producer == b.producer;
+}
+
+// Split an index built in unit order into one index per compilation_units
+// row; each row goes to the last unit whose DIE offset is not above the row's
+std::vector<DwarfIndex> split_index(DwarfIndex&& index) {
+    std::vector<uint64_t> starts;
+    for (const auto& cu : index.compilation_units) {
+        starts.push_back(cu.offset);
+    }
+    std::vector<DwarfIndex> parts(starts.size());
+    if (parts.empty()) return parts;
+
+    auto unit_of = [&starts](uint64_t offset) {
+        auto it = std::upper_bound(starts.begin(), starts.end(), offset);
+        return it == starts.begin() ? 0 : static_cast<size_t>(it - starts.begin()) - 1;
+    };
+    auto deal = [&](auto& rows, auto member, auto key) {
+        for (auto& row : rows) {
+            (parts[unit_of(key(row))].*member).push_back(std::move(row));
         }
+    };
+    auto deal_groups = [&](auto& groups, auto member) {
+        for (auto& group : groups) {
+            (parts[unit_of(group.first)].*member).emplace(group.first, std::move(group.second));
+        }
+    };
+    auto die_cu = [](const DieInfo& d) { return d.cu_offset; };
+
+    deal(index.compilation_units, &DwarfIndex::compilation_units, [](const CompilationUnit& c) { return c.offset; });
+    deal(index.functions, &DwarfIndex::functions, die_cu);
+    deal(index.variables, &DwarfIndex::variables, die_cu);
+    deal(index.types, &DwarfIndex::types, die_cu);
+    deal(index.structs, &DwarfIndex::structs, die_cu);
+    deal(index.enums, &DwarfIndex::enums, die_cu);
+    deal(index.parameters, &DwarfIndex::parameters, [](const ParameterInfo& p) { return p.offset; });
+    deal(index.local_variables, &DwarfIndex::local_variables, [](const LocalVarInfo& v) { return v.offset; });
+    deal(index.base_classes, &DwarfIndex::base_classes, [](const BaseClassInfo& b) { return b.derived_offset; });
+    deal(index.calls, &DwarfIndex::calls, [](const CallInfo& c) { return c.caller_offset; });
+    deal(index.inlined_calls, &DwarfIndex::inlined_calls, [](const InlinedCallInfo& i) { return i.offset; });
+    deal(index.namespaces, &DwarfIndex::namespaces, [](const NamespaceInfo& n) { return n.offset; });
+    deal_groups(index.struct_members, &DwarfIndex::struct_members);
+    deal_groups(index.enum_values, &DwarfIndex::enum_values);
+    deal_groups(index.address_ranges, &DwarfIndex::address_ranges);
+    return parts;
+}
+
+// The CU record of a unit DIE
+CompilationUnit unit_record(Dwarf_Debug dbg, Dwarf_Die cu_die) {
+    CompilationUnit cu;
+    cu.offset = get_die_offset(cu_die);
+    DieAttrs attrs(dbg, cu_die);
+    cu.name = attrs.string(DW_AT_name);
+    cu.comp_dir = attrs.string(DW_AT_comp_dir);
+    cu.producer = attrs.string(DW_AT_producer);
+    cu.language = static_cast<int>(attrs.get_unsigned(DW_AT_language, 0));
+    cu.low_pc = attrs.get_unsigned(DW_AT_low_pc, 0);
+    cu.high_pc = attrs.high_pc(cu.low_pc);
+    return cu;
+}
+
+// Index one compilation unit: its CU record plus every DIE below it
+void index_cu(IndexContext& ctx, Dwarf_Die cu_die) {
+    CompilationUnit cu = unit_record(ctx.dbg, cu_die);
+
+    IndexScope scope;
+    scope.tag = DW_TAG_compile_unit;
+    scope.offset = cu.offset;
+    scope.cu_offset = cu.offset;
+    ctx.unit_bases[cu.offset] = cu.low_pc;
+    size_t row = ctx.out.compilation_units.size();
+    ctx.out.compilation_units.push_back(std::move(cu));
+
+    ctx.cross_unit = false;
+    index_children(ctx, cu_die, scope);
+
+    // Rows built from other units' DIEs can go stale while this one's bytes stay put
+    ctx.out.compilation_units[row].content_hash = ctx.cross_unit ? 0 : unit_hash(ctx.object, cu_die);
+}
+
+// Index the compilation unit whose CU DIE is at cu_offset
+bool index_cu_at(IndexContext& ctx, uint64_t cu_offset) {
+    Dwarf_Die cu_die;
+    Dwarf_Error err = nullptr;
 
-        CompilationUnit cu;
-        cu.offset = get_die_offset(cu_die);
-        cu.name = get_die_string(dbg_, cu_die, DW_AT_name);
-        cu.comp_dir = get_die_string(dbg_, cu_die, DW_AT_comp_dir);
-        cu.producer = get_die_string(dbg_, cu_die, DW_AT_producer);
-        cu.language = static_cast<int>(get_die_unsigned(dbg_, cu_die, DW_AT_language, 0));
-        cu.low_pc = get_die_unsigned(dbg_, cu_die, DW_AT_low_pc, 0);
-        cu.high_pc = get_high_pc(dbg_, cu_die, cu.low_pc);
+    if (offdie(ctx.dbg, cu_offset, &cu_die, &err) != DW_DLV_OK) {
+        return false;
+    }
 
-        result.push_back(cu);
+    // Offsets may come straight from SQL; anything but a unit DIE is not a CU
+    int tag = get_die_tag(cu_die);
+    if (tag != DW_TAG_compile_unit && tag != DW_TAG_partial_unit &&
+        tag != DW_TAG_type_unit && tag != DW_TAG_skeleton_unit) {
         dwarf_dealloc_die(cu_die);
+        return false;
     }
-#endif
 
-    return result;
+    index_cu(ctx, cu_die);
+    dwarf_dealloc_die(cu_die);
+    return true;
 }
 
-std::vector<DieInfo> DwarfSession::get_functions(int64_t cu_filter) const {
-    std::vector<DieInfo> result;
+// Index one subprogram subtree: the function, its parameters, locals, calls
+// and inlined calls, exactly as the full walk would record them
+bool index_subprogram_at(IndexContext& ctx, uint64_t func_offset) {
+    Dwarf_Die die;
+    Dwarf_Error err = nullptr;
 
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+    if (offdie(ctx.dbg, func_offset, &die, &err) != DW_DLV_OK) {
+        return false;
+    }
+
+    if (get_die_tag(die) != DW_TAG_subprogram) {
+        dwarf_dealloc_die(die);
+        return false;
+    }
+
+    IndexScope scope;
+    Dwarf_Off cu_offset = 0;
+    if (dwarf_CU_dieoffset_given_die(die, &cu_offset, &err) == DW_DLV_OK) {
+        scope.cu_offset = dwarf_get_die_infotypes_flag(die) ? cu_offset : cu_offset | TYPES_SECTION_BIT;
+    }
+
+    IndexScope inner = scope;
+    if (index_die(ctx, die, scope, inner)) {
+        index_children(ctx, die, inner);
+    }
+    dwarf_dealloc_die(die);
+    return true;
+}
+
+template <typename T>
+void move_append(std::vector<T>& dst, std::vector<T>&& src) {
+    // Keep a reservation big enough for what follows (see merge_index())
+    if (dst.empty() && dst.capacity() < src.size()) {
+        dst = std::move(src);
+        return;
+    }
+    dst.insert(dst.end(),
+               std::make_move_iterator(src.begin()),
+               std::make_move_iterator(src.end()));
+}
+
+// Groups of different CUs never share a parent offset
+template <typename K, typename V>
+void move_append(std::unordered_map<K, V>& dst, std::unordered_map<K, V>&& src) {
+    if (dst.empty()) {
+        dst = std::move(src);
+        return;
+    }
+    dst.insert(std::make_move_iterator(src.begin()),
+               std::make_move_iterator(src.end()));
+}
+
+// Append a per-CU index to the session index, preserving CU order
+void append_index(DwarfIndex& dst, DwarfIndex&& src) {
+    move_append(dst.compilation_units, std::move(src.compilation_units));
+    move_append(dst.functions, std::move(src.functions));
+    move_append(dst.variables, std::move(src.variables));
+    move_append(dst.types, std::move(src.types));
+    move_append(dst.structs, std::move(src.structs));
+    move_append(dst.enums, std::move(src.enums));
+    move_append(dst.parameters, std::move(src.parameters));
+    move_append(dst.local_variables, std::move(src.local_variables));
+    move_append(dst.base_classes, std::move(src.base_classes));
+    move_append(dst.calls, std::move(src.calls));
+    move_append(dst.inlined_calls, std::move(src.inlined_calls));
+    move_append(dst.namespaces, std::move(src.namespaces));
+    move_append(dst.struct_members, std::move(src.struct_members));
+    move_append(dst.enum_values, std::move(src.enum_values));
+    move_append(dst.address_ranges, std::move(src.address_ranges));
+}
+
+// Append per-CU indexes to the session index in CU order. Each row vector is
+// sized once from the parts, so rows move once rather than on every regrowth.
+void merge_index(DwarfIndex& dst, std::vector<DwarfIndex>& parts) {
+    auto reserve = [&](auto member) {
+        size_t n = (dst.*member).size();
+        for (const auto& part : parts) {
+            n += (part.*member).size();
+        }
+        (dst.*member).reserve(n);
+    };
+    reserve(&DwarfIndex::compilation_units);
+    reserve(&DwarfIndex::functions);
+    reserve(&DwarfIndex::variables);
+    reserve(&DwarfIndex::types);
+    reserve(&DwarfIndex::structs);
+    reserve(&DwarfIndex::enums);
+    reserve(&DwarfIndex::parameters);
+    reserve(&DwarfIndex::local_variables);
+    reserve(&DwarfIndex::base_classes);
+    reserve(&DwarfIndex::calls);
+    reserve(&DwarfIndex::inlined_calls);
+    reserve(&DwarfIndex::namespaces);
+
+    for (auto& part : parts) {
+        append_index(dst, std::move(part));
+    }
+}
 
+// Visit the unit DIE of every unit in .debug_info, then .debug_types.
+// A type unit whose signature was already seen is a duplicate copy of the
+// same type (one per object file when the linker does not fold them) and
+// is skipped, so each type is indexed once.
+template <typename Visit>
+void for_each_unit(Dwarf_Debug dbg, Visit visit) {
     Dwarf_Error err = nullptr;
     Dwarf_Unsigned cu_header_length;
     Dwarf_Half version_stamp;
@@ -523,72 +1367,148 @@ std::vector<DieInfo> DwarfSession::get_functions(int64_t cu_filter) const {
     Dwarf_Unsigned next_cu_header;
     Dwarf_Half header_cu_type;
 
-    bool is_info = true;
+    std::unordered_set<uint64_t> signatures;
+
+    for (bool is_info : {true, false}) {
+        while (dwarf_next_cu_header_d(dbg, is_info,
+                                      &cu_header_length, &version_stamp,
+                                      &abbrev_offset, &address_size,
+                                      &length_size, &extension_size,
+                                      &type_signature, &typeoffset,
+                                      &next_cu_header, &header_cu_type,
+                                      &err) == DW_DLV_OK) {
+
+            if (!is_info || header_cu_type == DW_UT_type || header_cu_type == DW_UT_split_type) {
+                uint64_t signature;
+                std::memcpy(&signature, type_signature.signature, sizeof(signature));
+                if (!signatures.insert(signature).second) {
+                    continue;
+                }
+            }
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+            Dwarf_Die cu_die;
+            if (dwarf_siblingof_b(dbg, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
+                continue;
+            }
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
+            visit(cu_die);
+            dwarf_dealloc_die(cu_die);
         }
+    }
+}
 
-        uint64_t cu_offset = get_die_offset(cu_die);
+// A private libdwarf handle on the session binary, owned by one worker thread
+struct WorkerHandle {
+    int fd = -1;
+    Dwarf_Debug dbg = nullptr;
+    bool mapped = false;
 
-        // Skip if filtering by CU and this isn't the one
-        if (cu_filter >= 0 && cu_offset != static_cast<uint64_t>(cu_filter)) {
-            dwarf_dealloc_die(cu_die);
-            continue;
+    WorkerHandle() = default;
+    WorkerHandle(const WorkerHandle&) = delete;
+    WorkerHandle& operator=(const WorkerHandle&) = delete;
+
+    // object, when the session has one, is shared: its sections are read-only views
+    bool open(const std::string& path, ElfObject* object) {
+        Dwarf_Error err = nullptr;
+        if (object) {
+            if (dwarf_object_init_b(object->access(), nullptr, nullptr, DW_GROUPNUMBER_ANY, &dbg, &err) != DW_DLV_OK) {
+                if (err) dwarf_dealloc_error(dbg, err);
+                dbg = nullptr;
+                return false;
+            }
+            mapped = true;
+            return true;
         }
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
-            if (tag != DW_TAG_subprogram) return;
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
 
-            DieInfo info;
-            info.offset = get_die_offset(die);
-            info.tag = tag;
-            info.name = get_die_string(dbg_, die, DW_AT_name);
-            info.linkage_name = get_die_string(dbg_, die, DW_AT_linkage_name);
-            if (info.linkage_name.empty()) {
-                info.linkage_name = get_die_string(dbg_, die, DW_AT_MIPS_linkage_name);
-            }
-            info.low_pc = get_die_unsigned(dbg_, die, DW_AT_low_pc, 0);
-            info.high_pc = get_high_pc(dbg_, die, info.low_pc);
-            info.decl_line = static_cast<int>(get_die_signed(dbg_, die, DW_AT_decl_line, 0));
-            info.is_external = get_die_flag(die, DW_AT_external);
-            info.is_declaration = get_die_flag(die, DW_AT_declaration);
-
-            // Check for inline
-            Dwarf_Attribute at;
-            if (dwarf_attr(die, DW_AT_inline, &at, &err) == DW_DLV_OK) {
-                Dwarf_Unsigned val;
-                if (dwarf_formudata(at, &val, &err) == DW_DLV_OK) {
-                    info.is_declaration = (val == DW_INL_declared_inlined || val == DW_INL_declared_not_inlined);
-                }
-                dwarf_dealloc_attribute(at);
+        if (dwarf_init_b(fd, DW_DLC_READ, DW_GROUPNUMBER_ANY, nullptr, nullptr, &dbg, &err) != DW_DLV_OK) {
+            if (err) dwarf_dealloc_error(dbg, err);
+            dbg = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    ~WorkerHandle() {
+        if (dbg) {
+            Dwarf_Error err = nullptr;
+            if (mapped) {
+                dwarf_object_finish(dbg, &err);
+            } else {
+                dwarf_finish(dbg, &err);
             }
+        }
+        if (fd >= 0) {
+#ifdef _WIN32
+            _close(fd);
+#else
+            ::close(fd);
+#endif
+        }
+    }
+};
 
-            result.push_back(info);
-        });
+// Open a binary for libdwarf: sections are served from a mapping when the
+// image allows it, otherwise (or if libdwarf rejects the object) libdwarf
+// reads the file itself. On success exactly one of object and fd is set.
+bool open_debug(const std::string& path, std::unique_ptr<ElfObject>& object, int& fd,
+                Dwarf_Debug& dbg, std::string& error) {
+    Dwarf_Error err = nullptr;
+    unsigned int group_number = DW_GROUPNUMBER_ANY;
+    int res = DW_DLV_ERROR;
+
+    object = std::make_unique<ElfObject>();
+    if (object->open(path)) {
+        res = dwarf_object_init_b(object->access(), nullptr, nullptr, group_number, &dbg, &err);
+        if (res == DW_DLV_ERROR && err) {
+            dwarf_dealloc_error(dbg, err);
+            err = nullptr;
+        }
+    }
 
-        dwarf_dealloc_die(cu_die);
+    if (res == DW_DLV_ERROR) {
+        object.reset();
+        dbg = nullptr;
+
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "Failed to open file: " + path;
+            return false;
+        }
+        res = dwarf_init_b(fd, DW_DLC_READ, group_number, nullptr, nullptr, &dbg, &err);
     }
-#endif
 
-    return result;
+    if (res == DW_DLV_OK) {
+        return true;
+    }
+
+    if (res == DW_DLV_NO_ENTRY) {
+        error = "No DWARF debug info found in: " + path;
+    } else {
+        error = "Failed to initialize DWARF: ";
+        if (err) {
+            error += dwarf_errmsg(err);
+            dwarf_dealloc_error(dbg, err);
+        }
+    }
+    object.reset();
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    dbg = nullptr;
+    return false;
 }
 
-std::vector<DieInfo> DwarfSession::get_variables(int64_t cu_filter, int64_t func_filter) const {
-    std::vector<DieInfo> result;
+struct DwoUnit {
+    uint64_t offset;  // CU DIE offset
+    uint64_t dwo_id;  // 0 if the unit is not a skeleton or split unit
+};
 
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+// Every unit of dbg with the id that pairs skeleton and split units: the
+// header signature in DWARF 5, DW_AT_GNU_dwo_id in the GNU DWARF 4 extension
+std::vector<DwoUnit> list_dwo_units(Dwarf_Debug dbg) {
+    std::vector<DwoUnit> units;
 
     Dwarf_Error err = nullptr;
     Dwarf_Unsigned cu_header_length;
@@ -603,9 +1523,8 @@ std::vector<DieInfo> DwarfSession::get_variables(int64_t cu_filter, int64_t func
     Dwarf_Half header_cu_type;
 
     bool is_info = true;
-    uint64_t current_func = 0;
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
+    while (dwarf_next_cu_header_d(dbg, is_info,
                                   &cu_header_length, &version_stamp,
                                   &abbrev_offset, &address_size,
                                   &length_size, &extension_size,
@@ -614,611 +1533,933 @@ std::vector<DieInfo> DwarfSession::get_variables(int64_t cu_filter, int64_t func
                                   &err) == DW_DLV_OK) {
 
         Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
+        if (dwarf_siblingof_b(dbg, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
             continue;
         }
 
-        uint64_t cu_offset = get_die_offset(cu_die);
-
-        if (cu_filter >= 0 && cu_offset != static_cast<uint64_t>(cu_filter)) {
-            dwarf_dealloc_die(cu_die);
-            continue;
+        DwoUnit unit{get_die_offset(cu_die), 0};
+        if (header_cu_type == DW_UT_skeleton || header_cu_type == DW_UT_split_compile) {
+            std::memcpy(&unit.dwo_id, type_signature.signature, sizeof(unit.dwo_id));
+        } else {
+            unit.dwo_id = get_die_unsigned(dbg, cu_die, DW_AT_GNU_dwo_id, 0);
         }
+        units.push_back(unit);
+        dwarf_dealloc_die(cu_die);
+    }
+    return units;
+}
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
-
-            // Track current function
-            if (tag == DW_TAG_subprogram) {
-                current_func = get_die_offset(die);
-            }
-
-            if (tag != DW_TAG_variable && tag != DW_TAG_formal_parameter) return;
+} // anonymous namespace
 
-            // Filter by function if requested
-            if (func_filter >= 0 && current_func != static_cast<uint64_t>(func_filter)) {
-                return;
-            }
+#endif // DWARFSQL_HAS_LIBDWARF
 
-            DieInfo info;
-            info.offset = get_die_offset(die);
-            info.tag = tag;
-            info.name = get_die_string(dbg_, die, DW_AT_name);
-            info.decl_line = static_cast<int>(get_die_signed(dbg_, die, DW_AT_decl_line, 0));
-            info.is_external = get_die_flag(die, DW_AT_external);
+namespace {
 
-            result.push_back(info);
-        });
+// Offset filters use -1 to mean "no filter"
+bool matches(int64_t filter, uint64_t offset) {
+    return filter < 0 || offset == static_cast<uint64_t>(filter);
+}
 
-        dwarf_dealloc_die(cu_die);
+// Copy the rows of an index vector that satisfy pred
+template <typename T, typename Pred>
+std::vector<T> select_rows(const std::vector<T>& rows, Pred pred) {
+    std::vector<T> result;
+    for (const auto& row : rows) {
+        if (pred(row)) result.push_back(row);
     }
-#endif
-
     return result;
 }
 
-std::vector<DieInfo> DwarfSession::get_types(int64_t cu_filter) const {
-    std::vector<DieInfo> result;
-
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
-
-    Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
-
-    bool is_info = true;
+// Same, for a temporary: moves the kept rows instead of copying them
+template <typename T, typename Pred>
+std::vector<T> select_rows(std::vector<T>&& rows, Pred pred) {
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [&](const T& row) { return !pred(row); }),
+               rows.end());
+    return std::move(rows);
+}
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+} // anonymous namespace
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
-        }
+// ============================================================================
+// DwarfSession implementation
+// ============================================================================
 
-        uint64_t cu_offset = get_die_offset(cu_die);
+DwarfSession::~DwarfSession() {
+    close();
+}
 
-        if (cu_filter >= 0 && cu_offset != static_cast<uint64_t>(cu_filter)) {
-            dwarf_dealloc_die(cu_die);
-            continue;
-        }
+DwarfSession::DwarfSession(DwarfSession&& other) noexcept
+    : dbg_(other.dbg_)
+    , split_dbg_(other.split_dbg_)
+    , dies_(other.dies_)
+    , fd_(other.fd_)
+    , object_(std::move(other.object_))
+    , split_fd_(other.split_fd_)
+    , split_object_(std::move(other.split_object_))
+    , split_path_(std::move(other.split_path_))
+    , split_units_(std::move(other.split_units_))
+    , jobs_(other.jobs_)
+    , is_open_(other.is_open_)
+    , path_(std::move(other.path_))
+    , last_error_(std::move(other.last_error_))
+    , key_(std::move(other.key_))
+    , index_(std::move(other.index_))
+    , partial_index_(std::move(other.partial_index_))
+    , type_names_(std::move(other.type_names_))
+    , locations_(std::move(other.locations_))
+    , units_(std::move(other.units_))
+    , strings_(std::move(other.strings_))
+    , line_files_(std::move(other.line_files_))
+    , details_(std::move(other.details_))
+    , lines_(std::move(other.lines_))
+    , partial_lines_(std::move(other.partial_lines_))
+    , function_bounds_(std::move(other.function_bounds_))
+    , inline_bounds_(std::move(other.inline_bounds_))
+    , function_ranges_(std::move(other.function_ranges_))
+    , inline_ranges_(std::move(other.inline_ranges_))
+    , line_ranges_(std::move(other.line_ranges_))
+    , graph_(std::move(other.graph_))
+    , names_(std::move(other.names_))
+{
+    other.dbg_ = nullptr;
+    other.split_dbg_ = nullptr;
+    other.dies_ = nullptr;
+    other.fd_ = -1;
+    other.split_fd_ = -1;
+    other.is_open_ = false;
+}
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
+DwarfSession& DwarfSession::operator=(DwarfSession&& other) noexcept {
+    if (this != &other) {
+        close();
+        dbg_ = other.dbg_;
+        split_dbg_ = other.split_dbg_;
+        dies_ = other.dies_;
+        fd_ = other.fd_;
+        object_ = std::move(other.object_);
+        split_fd_ = other.split_fd_;
+        split_object_ = std::move(other.split_object_);
+        split_path_ = std::move(other.split_path_);
+        split_units_ = std::move(other.split_units_);
+        jobs_ = other.jobs_;
+        is_open_ = other.is_open_;
+        path_ = std::move(other.path_);
+        last_error_ = std::move(other.last_error_);
+        key_ = std::move(other.key_);
+        index_ = std::move(other.index_);
+        partial_index_ = std::move(other.partial_index_);
+        type_names_ = std::move(other.type_names_);
+        details_ = std::move(other.details_);
+        lines_ = std::move(other.lines_);
+        partial_lines_ = std::move(other.partial_lines_);
+        function_bounds_ = std::move(other.function_bounds_);
+        inline_bounds_ = std::move(other.inline_bounds_);
+        function_ranges_ = std::move(other.function_ranges_);
+        inline_ranges_ = std::move(other.inline_ranges_);
+        line_ranges_ = std::move(other.line_ranges_);
+        graph_ = std::move(other.graph_);
+        names_ = std::move(other.names_);
+        locations_ = std::move(other.locations_);
+        units_ = std::move(other.units_);
+        strings_ = std::move(other.strings_);
+        line_files_ = std::move(other.line_files_);
+        other.dbg_ = nullptr;
+        other.split_dbg_ = nullptr;
+        other.dies_ = nullptr;
+        other.fd_ = -1;
+        other.split_fd_ = -1;
+        other.is_open_ = false;
+    }
+    return *this;
+}
 
-            // Type tags we care about
-            if (tag != DW_TAG_base_type &&
-                tag != DW_TAG_typedef &&
-                tag != DW_TAG_pointer_type &&
-                tag != DW_TAG_reference_type &&
-                tag != DW_TAG_rvalue_reference_type &&
-                tag != DW_TAG_const_type &&
-                tag != DW_TAG_volatile_type &&
-                tag != DW_TAG_array_type) {
-                return;
-            }
+bool DwarfSession::open(const std::string& path) {
+#ifdef DWARFSQL_HAS_LIBDWARF
+    close();
 
-            DieInfo info;
-            info.offset = get_die_offset(die);
-            info.tag = tag;
-            info.name = get_die_string(dbg_, die, DW_AT_name);
-            info.byte_size = get_die_signed(dbg_, die, DW_AT_byte_size, -1);
+    if (!open_debug(path, object_, fd_, dbg_, last_error_)) {
+        return false;
+    }
 
-            result.push_back(info);
-        });
+    dies_ = dbg_;
+    path_ = path;
+    is_open_ = true;
+    open_split_package();
 
-        dwarf_dealloc_die(cu_die);
-    }
+    auto key = std::make_unique<IndexFileKey>();
+    if (read_key(*key)) key_ = std::move(key);
+    return true;
+#else
+    last_error_ = "libdwarf not available";
+    return false;
 #endif
-
-    return result;
 }
 
-std::vector<DieInfo> DwarfSession::get_structs(int64_t cu_filter) const {
-    std::vector<DieInfo> result;
-
+void DwarfSession::open_split_package() {
 #ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
-
-    Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
+    // Only when every unit is a skeleton: the package then holds all the
+    // DIEs, and no offset can refer to two files
+    std::vector<DwoUnit> skeletons = list_dwo_units(dbg_);
+    if (skeletons.empty()) return;
+    for (const auto& unit : skeletons) {
+        if (unit.dwo_id == 0) return;
+    }
 
-    bool is_info = true;
+    std::string package = path_ + ".dwp";
+    std::string error;
+    if (!open_debug(package, split_object_, split_fd_, split_dbg_, error)) {
+        return;
+    }
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+    Dwarf_Error err = nullptr;
+    if (dwarf_set_tied_dbg(split_dbg_, dbg_, &err) != DW_DLV_OK) {
+        if (err) dwarf_dealloc_error(split_dbg_, err);
+        close_split_package();
+        return;
+    }
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
+    std::unordered_map<uint64_t, uint64_t> split_by_id;
+    for (const auto& unit : list_dwo_units(split_dbg_)) {
+        if (unit.dwo_id != 0) split_by_id.emplace(unit.dwo_id, unit.offset);
+    }
+    for (const auto& unit : skeletons) {
+        auto it = split_by_id.find(unit.dwo_id);
+        if (it == split_by_id.end()) {
+            // A package from some other build
+            close_split_package();
+            return;
         }
+        split_units_.emplace(unit.offset, it->second);
+    }
 
-        uint64_t cu_offset = get_die_offset(cu_die);
+    split_path_ = package;
+    dies_ = split_dbg_;
+#endif
+}
 
-        if (cu_filter >= 0 && cu_offset != static_cast<uint64_t>(cu_filter)) {
-            dwarf_dealloc_die(cu_die);
-            continue;
+void DwarfSession::close_split_package() {
+#ifdef DWARFSQL_HAS_LIBDWARF
+    if (split_dbg_) {
+        Dwarf_Error err = nullptr;
+        if (split_object_) {
+            dwarf_object_finish(split_dbg_, &err);
+        } else {
+            dwarf_finish(split_dbg_, &err);
         }
-
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
-
-            if (tag != DW_TAG_structure_type &&
-                tag != DW_TAG_class_type &&
-                tag != DW_TAG_union_type) {
-                return;
-            }
-
-            DieInfo info;
-            info.offset = get_die_offset(die);
-            info.tag = tag;
-            info.name = get_die_string(dbg_, die, DW_AT_name);
-            info.byte_size = get_die_signed(dbg_, die, DW_AT_byte_size, -1);
-            info.is_declaration = get_die_flag(die, DW_AT_declaration);
-
-            result.push_back(info);
-        });
-
-        dwarf_dealloc_die(cu_die);
+        split_dbg_ = nullptr;
+    }
+    split_object_.reset();
+    if (split_fd_ >= 0) {
+#ifdef _WIN32
+        _close(split_fd_);
+#else
+        ::close(split_fd_);
+#endif
+        split_fd_ = -1;
     }
 #endif
-
-    return result;
+    split_path_.clear();
+    split_units_.clear();
+    dies_ = dbg_;
 }
 
-std::vector<DieInfo> DwarfSession::get_struct_members(uint64_t struct_offset) const {
-    std::vector<DieInfo> result;
-
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+bool DwarfSession::is_current() const {
+    IndexFileKey key;
+    return key_ && read_key(key) && key == *key_;
+}
 
-    Dwarf_Error err = nullptr;
-    Dwarf_Die struct_die;
-    Dwarf_Bool is_info = true;
+bool DwarfSession::read_key(IndexFileKey& key) const {
+    if (!read_index_key(path_, key)) return false;
 
-    if (dwarf_offdie_b(dbg_, struct_offset, is_info, &struct_die, &err) != DW_DLV_OK) {
-        return result;
+    // An index of a split build holds the package's DIEs, so it keys on both files
+    if (split_dbg_) {
+        IndexFileKey package;
+        if (!read_index_key(split_path_, package)) return false;
+        key.build_id += "+" + package.build_id;
+        key.file_size += package.file_size;
+        key.mtime = std::max(key.mtime, package.mtime);
     }
+    return true;
+}
 
-    Dwarf_Die child;
-    if (dwarf_child(struct_die, &child, &err) == DW_DLV_OK) {
-        do {
-            int tag = get_die_tag(child);
-            if (tag == DW_TAG_member) {
-                DieInfo info;
-                info.offset = get_die_offset(child);
-                info.tag = tag;
-                info.name = get_die_string(dbg_, child, DW_AT_name);
-
-                // Get data member location (offset in struct)
-                Dwarf_Attribute at;
-                if (dwarf_attr(child, DW_AT_data_member_location, &at, &err) == DW_DLV_OK) {
-                    Dwarf_Unsigned loc;
-                    if (dwarf_formudata(at, &loc, &err) == DW_DLV_OK) {
-                        info.low_pc = loc;  // Using low_pc to store offset
-                    }
-                    dwarf_dealloc_attribute(at);
-                }
-
-                // Bit field info
-                info.byte_size = get_die_signed(dbg_, child, DW_AT_bit_size, 0);
-                info.decl_line = static_cast<int>(get_die_signed(dbg_, child, DW_AT_bit_offset, 0));
-
-                result.push_back(info);
-            }
-
-            Dwarf_Die sibling;
-            if (dwarf_siblingof_b(dbg_, child, true, &sibling, &err) != DW_DLV_OK) {
-                dwarf_dealloc_die(child);
-                break;
-            }
-            dwarf_dealloc_die(child);
-            child = sibling;
-        } while (true);
+void DwarfSession::close() {
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        index_.reset();
+        partial_index_.reset();
+        details_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(lines_mutex_);
+        lines_.reset();
+        partial_lines_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(function_bounds_mutex_);
+        function_bounds_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(inline_bounds_mutex_);
+        inline_bounds_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(function_ranges_mutex_);
+        function_ranges_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(inline_ranges_mutex_);
+        inline_ranges_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(line_ranges_mutex_);
+        line_ranges_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(graph_mutex_);
+        graph_.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(names_mutex_);
+        names_.reset();
+    }
+    {
+        // Last: everything above holds handles into the pool
+        std::lock_guard<std::mutex> lock(type_names_mutex_);
+        type_names_.entries.clear();
+        locations_.clear();
+        units_.reset();
+        line_files_.clear();
+        strings_.clear();
     }
 
-    dwarf_dealloc_die(struct_die);
+#ifdef DWARFSQL_HAS_LIBDWARF
+    // The package is tied to dbg_, so it goes first
+    close_split_package();
+    dies_ = nullptr;
+    if (dbg_) {
+        Dwarf_Error err = nullptr;
+        if (object_) {
+            dwarf_object_finish(dbg_, &err);
+        } else {
+            dwarf_finish(dbg_, &err);
+        }
+        dbg_ = nullptr;
+    }
+    object_.reset();
+    if (fd_ >= 0) {
+#ifdef _WIN32
+        _close(fd_);
+#else
+        ::close(fd_);
 #endif
-
-    return result;
+        fd_ = -1;
+    }
+#endif
+    is_open_ = false;
+    path_.clear();
+    key_.reset();
 }
 
-std::vector<DieInfo> DwarfSession::get_enums(int64_t cu_filter) const {
-    std::vector<DieInfo> result;
-
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+const DwarfIndex& DwarfSession::index() const {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    if (!index_) {
+        auto index = std::make_unique<DwarfIndex>();
+        build_index(*index);
+        index_ = std::move(index);
+    }
+    return *index_;
+}
 
-    Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
+bool DwarfSession::load_index(const std::string& index_path) {
+    if (!is_open_) {
+        last_error_ = "No binary open";
+        return false;
+    }
 
-    bool is_info = true;
+    IndexFileKey key;
+    if (!read_key(key)) {
+        last_error_ = "Failed to read file: " + path_;
+        return false;
+    }
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+    auto index = std::make_unique<DwarfIndex>();
+    auto details = std::make_unique<IndexDetails>();
+    StringPool strings;
+    std::vector<InternedString> files;
+    if (!read_index_file(index_path, key, *index, *details, strings, files, last_error_)) {
+        return false;
+    }
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
+    {
+        // Renumber the file's source files into line_files_
+        std::lock_guard<std::mutex> lock(type_names_mutex_);
+        strings_.adopt(std::move(strings));
+        std::vector<uint32_t> numbers;
+        numbers.reserve(files.size());
+        for (const auto& file : files) {
+            numbers.push_back(line_files_.add(file));
         }
-
-        uint64_t cu_offset = get_die_offset(cu_die);
-
-        if (cu_filter >= 0 && cu_offset != static_cast<uint64_t>(cu_filter)) {
-            dwarf_dealloc_die(cu_die);
-            continue;
+        for (auto& line : details->lines) {
+            line.file = numbers[line.file];
         }
+    }
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    index_ = std::move(index);
+    details_ = std::move(details);
+    return true;
+}
 
-            if (tag != DW_TAG_enumeration_type) return;
+bool DwarfSession::save_index(const std::string& index_path) {
+    if (!is_open_) {
+        last_error_ = "No binary open";
+        return false;
+    }
 
-            DieInfo info;
-            info.offset = get_die_offset(die);
-            info.tag = tag;
-            info.name = get_die_string(dbg_, die, DW_AT_name);
-            info.byte_size = get_die_signed(dbg_, die, DW_AT_byte_size, -1);
+    IndexFileKey key;
+    if (!read_key(key)) {
+        last_error_ = "Failed to read file: " + path_;
+        return false;
+    }
 
-            result.push_back(info);
-        });
+    const DwarfIndex& idx = index();
 
-        dwarf_dealloc_die(cu_die);
+    IndexDetails details;
+    if (details_) {
+        details = *details_;
+    } else {
+        details.lines = collect_line_info(-1, &details.line_ranges);
+        for (const auto& p : idx.parameters) {
+            details.locations[p.offset] = get_location(p.offset);
+        }
+        for (const auto& v : idx.local_variables) {
+            details.locations[v.offset] = get_location(v.offset);
+        }
     }
-#endif
 
-    return result;
+    return write_index_file(index_path, key, idx, details, line_files_, last_error_);
 }
 
-std::vector<DieInfo> DwarfSession::get_enum_values(uint64_t enum_offset) const {
-    std::vector<DieInfo> result;
+void DwarfSession::build_index(DwarfIndex& out) const {
+#ifdef DWARFSQL_HAS_LIBDWARF
+    if (!is_open_) return;
+
+    // Caller holds index_mutex_, which guards partial_index_
+    const std::vector<uint64_t>& cu_offsets = get_unit_offsets();
+    PartialIndex partial;
+    if (partial_index_) {
+        partial = std::move(*partial_index_);
+        partial_index_.reset();
+    } else {
+        partial.units.resize(cu_offsets.size());
+        partial.done.assign(cu_offsets.size(), 0);
+    }
+    index_units(cu_offsets, partial.units, partial.done);
+    if (std::find(partial.done.begin(), partial.done.end(), 0) != partial.done.end()) {
+        partial_index_ = std::make_unique<PartialIndex>(std::move(partial));
+        throw QueryCancelled();
+    }
+    merge_index(out, partial.units);
+    out.shared_sections_hash = shared_sections_hash(dies_object(), object_.get(), split_dbg_ != nullptr);
+#endif
+}
 
+void DwarfSession::index_units(const std::vector<uint64_t>& cu_offsets, std::vector<DwarfIndex>& parts,
+                               std::vector<char>& done) const {
 #ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+    // Units already done are skipped. One whose walk the query budget cut
+    // short stays not done and is walked again from scratch next time; one
+    // that cannot be read is done, with no rows.
+    auto index_here = [&](size_t i) {
+        parts[i] = DwarfIndex();
+        IndexContext ctx{dies_, type_names_, strings_, parts[i], dies_object()};
+        index_cu_at(ctx, cu_offsets[i]);
+        if (!query_cancelled()) done[i] = 1;
+    };
+
+    if (jobs_ <= 1) {
+        std::lock_guard<std::mutex> lock(type_names_mutex_);
+        for (size_t i = 0; i < cu_offsets.size() && !query_cancelled(); ++i) {
+            if (!done[i]) index_here(i);
+        }
+        return;
+    }
 
-    Dwarf_Error err = nullptr;
-    Dwarf_Die enum_die;
-    Dwarf_Bool is_info = true;
+    // Parallel mode: workers pull CUs off a shared counter. Each worker owns
+    // a libdwarf handle (Dwarf_Debug is not thread-safe) and a type-name
+    // cache, and fills one DwarfIndex per CU; caches are then folded into
+    // the session's.
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < cu_offsets.size(); ++i) {
+        if (!done[i]) pending.push_back(i);
+    }
+    if (pending.empty()) return;
+    std::atomic<size_t> next_cu{0};
+    QueryBudget* budget = QueryBudget::current();
+
+    size_t thread_count = std::min(static_cast<size_t>(jobs_), pending.size());
+    std::vector<TypeNameCache> worker_type_names(thread_count);
+    std::vector<StringPool> worker_strings(thread_count);
+    std::vector<DecodeCounters> worker_counts(thread_count);
+
+    auto worker = [&](size_t t) {
+        // Counts made on this thread go to the one waiting on the workers
+        struct Handoff {
+            DecodeCounters& out;
+            DecodeCounters before = decode_counters;
+            ~Handoff() { out = decode_counters - before; }
+        } handoff{worker_counts[t]};
+        QueryScope scope(budget);  // Stops with the query that started the build
+
+        WorkerHandle handle;
+        if (!handle.open(path_, object_.get())) return;
+
+        // Split units are read through a package handle tied to this worker's own
+        WorkerHandle split;
+        if (split_dbg_) {
+            Dwarf_Error err = nullptr;
+            if (!split.open(split_path_, split_object_.get())) return;
+            if (dwarf_set_tied_dbg(split.dbg, handle.dbg, &err) != DW_DLV_OK) {
+                if (err) dwarf_dealloc_error(split.dbg, err);
+                return;
+            }
+        }
+        Dwarf_Debug dies = split_dbg_ ? split.dbg : handle.dbg;
+
+        size_t next;
+        while ((next = next_cu.fetch_add(1)) < pending.size() && !query_cancelled()) {
+            size_t i = pending[next];
+            parts[i] = DwarfIndex();
+            IndexContext ctx{dies, worker_type_names[t], worker_strings[t], parts[i], dies_object()};
+            if (index_cu_at(ctx, cu_offsets[i]) && !query_cancelled()) {
+                done[i] = 1;
+            }
+        }
+    };
 
-    if (dwarf_offdie_b(dbg_, enum_offset, is_info, &enum_die, &err) != DW_DLV_OK) {
-        return result;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (const auto& counts : worker_counts) {
+        decode_counters += counts;
+    }
+
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+    for (size_t i : pending) {
+        // Pick up anything a worker could not process (e.g. its handle failed to open)
+        if (query_cancelled()) break;
+        if (!done[i]) index_here(i);
+    }
+    for (auto& cache : worker_type_names) {
+        type_names_.entries.insert(std::make_move_iterator(cache.entries.begin()),
+                                   std::make_move_iterator(cache.entries.end()));
+    }
+    // Row strings are only read through their handles from here on, so the
+    // worker pools are taken over block by block rather than string by string
+    for (auto& strings : worker_strings) {
+        strings_.absorb(std::move(strings));
     }
+#endif
+}
 
-    Dwarf_Die child;
-    if (dwarf_child(enum_die, &child, &err) == DW_DLV_OK) {
-        do {
-            int tag = get_die_tag(child);
-            if (tag == DW_TAG_enumerator) {
-                DieInfo info;
-                info.offset = get_die_offset(child);
-                info.tag = tag;
-                info.name = get_die_string(dbg_, child, DW_AT_name);
-                info.byte_size = get_die_signed(dbg_, child, DW_AT_const_value, 0);
+void DwarfSession::update_index(DwarfIndex&& old, DwarfIndex& out, ReloadResult& result) const {
+#ifdef DWARFSQL_HAS_LIBDWARF
+    const std::vector<uint64_t>& cu_offsets = get_unit_offsets();
+    uint64_t shared = shared_sections_hash(dies_object(), object_.get(), split_dbg_ != nullptr);
 
-                result.push_back(info);
+    // Old rows can only be dealt back to their units if those are in offset order
+    bool reusable = shared != 0 && old.shared_sections_hash == shared;
+    for (size_t i = 1; reusable && i < old.compilation_units.size(); ++i) {
+        reusable = old.compilation_units[i - 1].offset < old.compilation_units[i].offset;
+    }
+    std::vector<DwarfIndex> old_parts;
+    if (reusable) old_parts = split_index(std::move(old));
+
+    std::vector<DwarfIndex> parts(cu_offsets.size());
+    std::vector<uint64_t> pending;
+    std::vector<size_t> pending_slots;
+    {
+        std::lock_guard<std::mutex> lock(type_names_mutex_);
+        auto first = old_parts.begin();
+        for (size_t i = 0; i < cu_offsets.size(); ++i) {
+            // Both lists are in offset order
+            while (first != old_parts.end() && first->compilation_units[0].offset < cu_offsets[i]) ++first;
+
+            bool same = false;
+            Dwarf_Die cu_die;
+            Dwarf_Error err = nullptr;
+            if (first != old_parts.end() && offdie(dies_, cu_offsets[i], &cu_die, &err) == DW_DLV_OK) {
+                CompilationUnit cu = unit_record(dies_, cu_die);
+                cu.content_hash = unit_hash(dies_object(), cu_die);
+                same = same_unit(first->compilation_units[0], cu);
+                dwarf_dealloc_die(cu_die);
             }
 
-            Dwarf_Die sibling;
-            if (dwarf_siblingof_b(dbg_, child, true, &sibling, &err) != DW_DLV_OK) {
-                dwarf_dealloc_die(child);
-                break;
+            if (same) {
+                parts[i] = std::move(*first++);
+                ++result.units_reused;
+            } else {
+                pending.push_back(cu_offsets[i]);
+                pending_slots.push_back(i);
             }
-            dwarf_dealloc_die(child);
-            child = sibling;
-        } while (true);
+        }
     }
 
-    dwarf_dealloc_die(enum_die);
-#endif
+    std::vector<DwarfIndex> fresh(pending.size());
+    std::vector<char> done(pending.size(), 0);
+    index_units(pending, fresh, done);
+    for (size_t i = 0; i < fresh.size(); ++i) {
+        parts[pending_slots[i]] = std::move(fresh[i]);
+    }
+    result.units_indexed = pending.size();
 
-    return result;
+    merge_index(out, parts);
+    out.shared_sections_hash = shared;
+#endif
 }
 
-std::vector<LineInfo> DwarfSession::get_line_info(int64_t cu_filter) const {
-    std::vector<LineInfo> result;
+bool DwarfSession::reload(ReloadResult* result) {
+    ReloadResult summary;
+    if (!is_open_) {
+        last_error_ = "No binary open";
+        return false;
+    }
 
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+    if (is_current()) {
+        if (result) *result = summary;
+        return true;
+    }
 
-    Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
+    DwarfSession next;
+    next.set_jobs(jobs_);
+    if (!next.open(path_)) {
+        last_error_ = next.last_error_;
+        return false;
+    }
+    summary.changed = true;
 
-    bool is_info = true;
+    std::unique_ptr<DwarfIndex> old;
+    {
+        std::lock_guard<std::mutex> lock(index_mutex_);
+        old = std::move(index_);
+    }
+    if (old) {
+        // Carried-over rows point into this session's strings
+        {
+            std::lock_guard<std::mutex> lock(type_names_mutex_);
+            next.strings_.adopt(std::move(strings_));
+        }
+        auto index = std::make_unique<DwarfIndex>();
+        next.update_index(std::move(*old), *index, summary);
+        next.index_ = std::move(index);
+    }
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+    *this = std::move(next);
+    if (result) *result = summary;
+    return true;
+}
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
-        }
+const std::vector<uint64_t>& DwarfSession::get_unit_offsets() const {
+    // A loaded session may not touch libdwarf; its index has every CU.
+    // Fetched first: building an index takes type_names_mutex_ itself.
+    const DwarfIndex* loaded = details_ ? &index() : nullptr;
 
-        uint64_t cu_offset = get_die_offset(cu_die);
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+    if (units_) {
+        return *units_;
+    }
 
-        if (cu_filter >= 0 && cu_offset != static_cast<uint64_t>(cu_filter)) {
-            dwarf_dealloc_die(cu_die);
-            continue;
+    auto units = std::make_unique<std::vector<uint64_t>>();
+    if (loaded) {
+        for (const auto& cu : loaded->compilation_units) {
+            units->push_back(cu.offset);
         }
+    }
+#ifdef DWARFSQL_HAS_LIBDWARF
+    else if (is_open_) {
+        for_each_unit(dies_, [&](Dwarf_Die cu_die) { units->push_back(get_die_offset(cu_die)); });
+    }
+#endif
 
-        // Get line context
-        Dwarf_Line_Context line_context;
-        Dwarf_Unsigned line_version;
-        Dwarf_Small table_count;
+    units_ = std::move(units);
+    return *units_;
+}
 
-        int res = dwarf_srclines_b(cu_die, &line_version, &table_count, &line_context, &err);
-        if (res != DW_DLV_OK) {
-            dwarf_dealloc_die(cu_die);
-            continue;
-        }
+bool DwarfSession::has_index() const {
+    std::lock_guard<std::mutex> lock(index_mutex_);
+    return index_ != nullptr;
+}
 
-        Dwarf_Line* lines;
-        Dwarf_Signed line_count;
+DwarfIndex DwarfSession::index_unit(uint64_t cu_offset) const {
+    DwarfIndex out;
+#ifdef DWARFSQL_HAS_LIBDWARF
+    if (!is_open_) return out;
 
-        res = dwarf_srclines_from_linecontext(line_context, &lines, &line_count, &err);
-        if (res == DW_DLV_OK) {
-            for (Dwarf_Signed i = 0; i < line_count; ++i) {
-                LineInfo info;
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+    IndexContext ctx{dies_, type_names_, strings_, out, dies_object()};
+    index_cu_at(ctx, cu_offset);
+#endif
+    return out;
+}
 
-                Dwarf_Addr addr;
-                if (dwarf_lineaddr(lines[i], &addr, &err) == DW_DLV_OK) {
-                    info.address = addr;
-                }
+DwarfIndex DwarfSession::index_subprogram(uint64_t func_offset) const {
+    DwarfIndex out;
+#ifdef DWARFSQL_HAS_LIBDWARF
+    if (!is_open_) return out;
 
-                char* filename;
-                if (dwarf_linesrc(lines[i], &filename, &err) == DW_DLV_OK) {
-                    info.file = filename;
-                }
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+    IndexContext ctx{dies_, type_names_, strings_, out};
+    index_subprogram_at(ctx, func_offset);
+#endif
+    return out;
+}
 
-                Dwarf_Unsigned lineno;
-                if (dwarf_lineno(lines[i], &lineno, &err) == DW_DLV_OK) {
-                    info.line = static_cast<int>(lineno);
-                }
+void DwarfSession::set_jobs(int jobs) {
+    if (jobs <= 0) {
+        jobs = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    jobs_ = std::max(jobs, 1);
+}
 
-                Dwarf_Unsigned col;
-                if (dwarf_lineoff_b(lines[i], &col, &err) == DW_DLV_OK) {
-                    info.column = static_cast<int>(col);
-                }
+std::vector<CompilationUnit> DwarfSession::get_compilation_units() const {
+    return index().compilation_units;
+}
 
-                Dwarf_Bool is_stmt;
-                if (dwarf_linebeginstatement(lines[i], &is_stmt, &err) == DW_DLV_OK) {
-                    info.is_stmt = is_stmt != 0;
-                }
+// Filtered getters decode just the requested CU or subprogram until the
+// full index exists, so point lookups never pay for the whole walk.
 
-                Dwarf_Bool bb;
-                if (dwarf_lineblock(lines[i], &bb, &err) == DW_DLV_OK) {
-                    info.basic_block = bb != 0;
-                }
+std::vector<DieInfo> DwarfSession::get_functions(int64_t cu_filter) const {
+    auto pred = [&](const DieInfo& f) { return matches(cu_filter, f.cu_offset); };
+    if (cu_filter >= 0 && !has_index()) {
+        return select_rows(index_unit(cu_filter).functions, pred);
+    }
+    return select_rows(index().functions, pred);
+}
 
-                Dwarf_Bool end_seq;
-                if (dwarf_lineendsequence(lines[i], &end_seq, &err) == DW_DLV_OK) {
-                    info.end_sequence = end_seq != 0;
-                }
+std::vector<DieInfo> DwarfSession::get_variables(int64_t cu_filter, int64_t func_filter) const {
+    auto pred = [&](const DieInfo& v) {
+        return matches(cu_filter, v.cu_offset) && matches(func_filter, v.func_offset);
+    };
+    if (func_filter >= 0 && !has_index()) {
+        return select_rows(index_subprogram(func_filter).variables, pred);
+    }
+    if (cu_filter >= 0 && !has_index()) {
+        return select_rows(index_unit(cu_filter).variables, pred);
+    }
+    return select_rows(index().variables, pred);
+}
 
-                result.push_back(info);
-            }
+std::vector<DieInfo> DwarfSession::get_types(int64_t cu_filter) const {
+    auto pred = [&](const DieInfo& t) { return matches(cu_filter, t.cu_offset); };
+    if (cu_filter >= 0 && !has_index()) {
+        return select_rows(index_unit(cu_filter).types, pred);
+    }
+    return select_rows(index().types, pred);
+}
+
+std::vector<DieInfo> DwarfSession::get_structs(int64_t cu_filter) const {
+    auto pred = [&](const DieInfo& s) { return matches(cu_filter, s.cu_offset); };
+    if (cu_filter >= 0 && !has_index()) {
+        return select_rows(index_unit(cu_filter).structs, pred);
+    }
+    return select_rows(index().structs, pred);
+}
+
+const NameIndex& DwarfSession::name_index() const {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    if (names_) {
+        return *names_;
+    }
+
+    // A split build's tables describe the skeleton units, not the package's
+    auto names = std::make_unique<NameIndex>();
+    ElfObject* object = split_dbg_ ? nullptr : object_.get();
+    if (object) {
+        uint64_t size = 0;
+        uint64_t str_size = 0;
+        const uint8_t* data = object->section_data(".debug_names", size);
+        const uint8_t* str = data ? object->section_data(".debug_str", str_size) : nullptr;
+        bool loaded = data && str && names->load_debug_names(data, size, object->little_endian(), str, str_size);
+        if (!loaded) {
+            data = object->section_data(".gdb_index", size);
+            loaded = data && names->load_gdb_index(data, size);
         }
+        if (!loaded) names = std::make_unique<NameIndex>();
+    }
+    names_ = std::move(names);
+    return *names_;
+}
 
-        dwarf_srclines_dealloc_b(line_context);
-        dwarf_dealloc_die(cu_die);
+bool DwarfSession::find_named(NameKind kind, const NameKey& key, std::vector<DieInfo>& rows) const {
+    rows.clear();
+    // Unnamed DIEs are in no accelerator table
+    if (!is_open_ || details_ || key.text.empty() || has_index()) return false;
+    const NameIndex& names = name_index();
+    if (!names.covers(kind)) return false;
+
+    // The tables list unit headers; units are keyed by the offset of their
+    // DIE, which is the first one past the header
+    std::vector<uint64_t> units = get_unit_offsets();
+    std::sort(units.begin(), units.end());
+    for (uint64_t header : names.units(key, kind)) {
+        auto unit = std::upper_bound(units.begin(), units.end(), header);
+        if (unit == units.end()) continue;
+
+        DwarfIndex part = index_unit(*unit);
+        std::vector<DieInfo>& candidates = kind == NameKind::Function ? part.functions
+                                         : kind == NameKind::Struct   ? part.structs
+                                         : kind == NameKind::Type     ? part.types
+                                                                      : part.variables;
+        for (auto& d : candidates) {
+            if (key.matches(d.name)) rows.push_back(std::move(d));
+        }
     }
-#endif
+    return true;
+}
 
+std::vector<DieInfo> DwarfSession::get_struct_members(uint64_t struct_offset) const {
+    std::vector<DieInfo> result;
+    get_struct_members(struct_offset, [&result](DieInfo&& m) { result.push_back(std::move(m)); });
     return result;
 }
 
-std::vector<ParameterInfo> DwarfSession::get_parameters(int64_t func_filter) const {
-    std::vector<ParameterInfo> result;
+void DwarfSession::get_struct_members(uint64_t struct_offset,
+                                      const std::function<void(DieInfo&&)>& sink) const {
+    // Once the walk has run, members come from the index instead of a seek per struct
+    if (has_index()) {
+        const auto& members = index().struct_members;
+        auto it = members.find(struct_offset);
+        if (it == members.end()) return;
+        for (const auto& m : it->second) sink(DieInfo(m));
+        return;
+    }
 
 #ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+    if (!is_open_) return;
 
     Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
-
-    bool is_info = true;
-
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
-
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
-        }
-
-        uint64_t current_func = 0;
-        int param_index = 0;
+    Dwarf_Die struct_die;
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+    if (offdie(dies_, struct_offset, &struct_die, &err) != DW_DLV_OK) {
+        return;
+    }
 
-            if (tag == DW_TAG_subprogram) {
-                current_func = get_die_offset(die);
-                param_index = 0;
-                return;
+    Dwarf_Die child;
+    if (dwarf_child(struct_die, &child, &err) == DW_DLV_OK) {
+        do {
+            ++decode_counters.dies_visited;
+            if (get_die_tag(child) == DW_TAG_member) {
+                sink(member_info(dies_, child, type_names_, strings_));
             }
 
-            if (tag != DW_TAG_formal_parameter) return;
-
-            if (func_filter >= 0 && current_func != static_cast<uint64_t>(func_filter)) {
-                return;
+            Dwarf_Die sibling;
+            if (next_sibling(dies_, child, &sibling, &err) != DW_DLV_OK) {
+                dwarf_dealloc_die(child);
+                break;
             }
+            dwarf_dealloc_die(child);
+            child = sibling;
+        } while (true);
+    }
 
-            ParameterInfo info;
-            info.offset = get_die_offset(die);
-            info.func_offset = current_func;
-            info.name = get_die_string(dbg_, die, DW_AT_name);
-            info.type = get_type_name(dbg_, die);
-            info.index = param_index++;
-            info.location = get_location_string(dbg_, die, DW_AT_location);
-
-            result.push_back(info);
-        });
+    dwarf_dealloc_die(struct_die);
+#endif
+}
 
-        dwarf_dealloc_die(cu_die);
+std::vector<DieInfo> DwarfSession::get_enums(int64_t cu_filter) const {
+    auto pred = [&](const DieInfo& e) { return matches(cu_filter, e.cu_offset); };
+    if (cu_filter >= 0 && !has_index()) {
+        return select_rows(index_unit(cu_filter).enums, pred);
     }
-#endif
+    return select_rows(index().enums, pred);
+}
 
+std::vector<DieInfo> DwarfSession::get_enum_values(uint64_t enum_offset) const {
+    std::vector<DieInfo> result;
+    get_enum_values(enum_offset, [&result](DieInfo&& v) { result.push_back(std::move(v)); });
     return result;
 }
 
-std::vector<LocalVarInfo> DwarfSession::get_local_variables(int64_t func_filter) const {
-    std::vector<LocalVarInfo> result;
+void DwarfSession::get_enum_values(uint64_t enum_offset,
+                                   const std::function<void(DieInfo&&)>& sink) const {
+    if (has_index()) {
+        const auto& values = index().enum_values;
+        auto it = values.find(enum_offset);
+        if (it == values.end()) return;
+        for (const auto& v : it->second) sink(DieInfo(v));
+        return;
+    }
 
 #ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+    if (!is_open_) return;
 
     Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
-
-    bool is_info = true;
-
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
-
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
-        }
-
-        uint64_t current_func = 0;
-        uint64_t scope_low = 0;
-        uint64_t scope_high = 0;
-
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
+    Dwarf_Die enum_die;
 
-            if (tag == DW_TAG_subprogram) {
-                current_func = get_die_offset(die);
-                scope_low = get_die_unsigned(dbg_, die, DW_AT_low_pc, 0);
-                scope_high = get_high_pc(dbg_, die, scope_low);
-                return;
-            }
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+    if (offdie(dies_, enum_offset, &enum_die, &err) != DW_DLV_OK) {
+        return;
+    }
 
-            if (tag == DW_TAG_lexical_block) {
-                scope_low = get_die_unsigned(dbg_, die, DW_AT_low_pc, 0);
-                scope_high = get_high_pc(dbg_, die, scope_low);
-                return;
+    Dwarf_Die child;
+    if (dwarf_child(enum_die, &child, &err) == DW_DLV_OK) {
+        do {
+            ++decode_counters.dies_visited;
+            if (get_die_tag(child) == DW_TAG_enumerator) {
+                sink(enumerator_info(dies_, child, strings_));
             }
 
-            if (tag != DW_TAG_variable) return;
-
-            // Skip if at CU level (global variable)
-            if (depth <= 1) return;
-
-            if (func_filter >= 0 && current_func != static_cast<uint64_t>(func_filter)) {
-                return;
+            Dwarf_Die sibling;
+            if (next_sibling(dies_, child, &sibling, &err) != DW_DLV_OK) {
+                dwarf_dealloc_die(child);
+                break;
             }
+            dwarf_dealloc_die(child);
+            child = sibling;
+        } while (true);
+    }
 
-            LocalVarInfo info;
-            info.offset = get_die_offset(die);
-            info.func_offset = current_func;
-            info.name = get_die_string(dbg_, die, DW_AT_name);
-            info.type = get_type_name(dbg_, die);
-            info.location = get_location_string(dbg_, die, DW_AT_location);
-            info.decl_line = static_cast<int>(get_die_signed(dbg_, die, DW_AT_decl_line, 0));
-            info.scope_low_pc = scope_low;
-            info.scope_high_pc = scope_high;
+    dwarf_dealloc_die(enum_die);
+#endif
+}
 
-            result.push_back(info);
-        });
+std::vector<LineInfo> DwarfSession::get_line_info(int64_t cu_filter) const {
+    if (cu_filter < 0) {
+        return line_table();
+    }
 
-        dwarf_dealloc_die(cu_die);
+    if (!details_) {
+        return collect_line_info(cu_filter, nullptr);
     }
-#endif
 
+    std::vector<LineInfo> result;
+    for (const auto& range : details_->line_ranges) {
+        if (matches(cu_filter, range.cu_offset)) {
+            result.insert(result.end(), details_->lines.begin() + range.begin, details_->lines.begin() + range.end);
+        }
+    }
     return result;
 }
 
-std::vector<BaseClassInfo> DwarfSession::get_base_classes() const {
-    std::vector<BaseClassInfo> result;
+std::vector<LineInfo> DwarfSession::collect_line_info(int64_t cu_filter, std::vector<LineTableRange>* ranges,
+                                                      PartialLines* resume) const {
+    std::vector<LineInfo> result;
 
 #ifdef DWARFSQL_HAS_LIBDWARF
     if (!is_open_) return result;
 
+    // Picks up after the units of a collection the query budget stopped
+    size_t units = 0;  // Read, or skipped as already in result
+    bool stopped = false;
+    if (resume) result = std::move(resume->rows);
+
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+
     Dwarf_Error err = nullptr;
     Dwarf_Unsigned cu_header_length;
     Dwarf_Half version_stamp;
@@ -1241,263 +2482,541 @@ std::vector<BaseClassInfo> DwarfSession::get_base_classes() const {
                                   &next_cu_header, &header_cu_type,
                                   &err) == DW_DLV_OK) {
 
+        if (resume && units < resume->units) {
+            ++units;
+            continue;
+        }
+        if (resume && query_cancelled()) {
+            // Runs the unit cursor to its end, where the next walk restarts it
+            stopped = true;
+            continue;
+        }
+        ++units;
+
         Dwarf_Die cu_die;
         if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
             continue;
         }
 
-        uint64_t current_class = 0;
-        std::string current_class_name;
+        uint64_t cu_offset = get_die_offset(cu_die);
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
+        // With a package, rows belong to the split unit the skeleton stands for
+        auto split = split_units_.find(cu_offset);
+        if (split != split_units_.end()) {
+            cu_offset = split->second;
+        }
 
-            if (tag == DW_TAG_structure_type || tag == DW_TAG_class_type) {
-                current_class = get_die_offset(die);
-                current_class_name = get_die_string(dbg_, die, DW_AT_name);
-                return;
-            }
+        if (cu_filter >= 0 && cu_offset != static_cast<uint64_t>(cu_filter)) {
+            dwarf_dealloc_die(cu_die);
+            continue;
+        }
 
-            if (tag != DW_TAG_inheritance) return;
+        // Get line context
+        Dwarf_Line_Context line_context;
+        Dwarf_Unsigned line_version;
+        Dwarf_Small table_count;
 
-            BaseClassInfo info;
-            info.derived_offset = current_class;
-            info.derived_name = current_class_name;
-            info.base_offset = get_die_ref(dbg_, die, DW_AT_type);
+        auto start = std::chrono::steady_clock::now();
+        int res = dwarf_srclines_b(cu_die, &line_version, &table_count, &line_context, &err);
+        if (res != DW_DLV_OK) {
+            decode_counters.srclines_ns += elapsed_ns(start);
+            dwarf_dealloc_die(cu_die);
+            continue;
+        }
 
-            // Get base class name by following the type reference
-            Dwarf_Die base_die;
-            if (dwarf_offdie_b(dbg_, info.base_offset, true, &base_die, &err) == DW_DLV_OK) {
-                info.base_name = get_die_string(dbg_, base_die, DW_AT_name);
-                dwarf_dealloc_die(base_die);
-            }
+        Dwarf_Line* lines;
+        Dwarf_Signed line_count;
+
+        res = dwarf_srclines_from_linecontext(line_context, &lines, &line_count, &err);
+        decode_counters.srclines_ns += elapsed_ns(start);
+        size_t begin = result.size();
+        std::unordered_map<Dwarf_Unsigned, uint32_t> files;
+        if (res == DW_DLV_OK) {
+            for (Dwarf_Signed i = 0; i < line_count; ++i) {
+                LineInfo info;
+
+                Dwarf_Addr addr;
+                if (dwarf_lineaddr(lines[i], &addr, &err) == DW_DLV_OK) {
+                    info.set_address(addr);
+                }
+
+                // Rows of one file share a file number; resolve and intern each once
+                Dwarf_Unsigned fileno = 0;
+                bool have_fileno = dwarf_line_srcfileno(lines[i], &fileno, &err) == DW_DLV_OK;
+                auto known = have_fileno ? files.find(fileno) : files.end();
+                if (known != files.end()) {
+                    info.file = known->second;
+                } else {
+                    char* filename;
+                    if (dwarf_linesrc(lines[i], &filename, &err) == DW_DLV_OK) {
+                        info.file = line_files_.add(strings_.intern(filename));
+                        dwarf_dealloc(dbg_, filename, DW_DLA_STRING);
+                    }
+                    if (have_fileno) files.emplace(fileno, info.file);
+                }
+
+                Dwarf_Unsigned lineno;
+                if (dwarf_lineno(lines[i], &lineno, &err) == DW_DLV_OK) {
+                    info.line = static_cast<int>(lineno);
+                }
+
+                Dwarf_Unsigned col;
+                if (dwarf_lineoff_b(lines[i], &col, &err) == DW_DLV_OK) {
+                    info.column = static_cast<uint32_t>(std::min<Dwarf_Unsigned>(col, (1u << 29) - 1));
+                }
+
+                Dwarf_Bool is_stmt;
+                if (dwarf_linebeginstatement(lines[i], &is_stmt, &err) == DW_DLV_OK) {
+                    info.is_stmt = is_stmt != 0;
+                }
+
+                Dwarf_Bool bb;
+                if (dwarf_lineblock(lines[i], &bb, &err) == DW_DLV_OK) {
+                    info.basic_block = bb != 0;
+                }
 
-            info.data_member_offset = get_die_signed(dbg_, die, DW_AT_data_member_location, 0);
-            info.is_virtual = has_die_attr(die, DW_AT_virtuality);
-            info.access = static_cast<int>(get_die_unsigned(dbg_, die, DW_AT_accessibility, DW_ACCESS_private));
+                Dwarf_Bool end_seq;
+                if (dwarf_lineendsequence(lines[i], &end_seq, &err) == DW_DLV_OK) {
+                    info.end_sequence = end_seq != 0;
+                }
 
-            result.push_back(info);
-        });
+                result.push_back(info);
+            }
+        }
+        if (ranges) {
+            ranges->push_back({cu_offset, begin, result.size()});
+        }
 
+        dwarf_srclines_dealloc_b(line_context);
         dwarf_dealloc_die(cu_die);
     }
+
+    if (stopped) {
+        resume->rows = std::move(result);
+        resume->units = units;
+        throw QueryCancelled();
+    }
 #endif
 
     return result;
 }
 
-std::vector<CallInfo> DwarfSession::get_calls() const {
-    std::vector<CallInfo> result;
+std::vector<ParameterInfo> DwarfSession::get_parameters(int64_t func_filter) const {
+    auto pred = [&](const ParameterInfo& p) { return matches(func_filter, p.func_offset); };
+    if (func_filter >= 0 && !has_index()) {
+        return select_rows(index_subprogram(func_filter).parameters, pred);
+    }
+    return select_rows(index().parameters, pred);
+}
 
+std::vector<LocalVarInfo> DwarfSession::get_local_variables(int64_t func_filter) const {
+    auto pred = [&](const LocalVarInfo& v) { return matches(func_filter, v.func_offset); };
+    if (func_filter >= 0 && !has_index()) {
+        return select_rows(index_subprogram(func_filter).local_variables, pred);
+    }
+    return select_rows(index().local_variables, pred);
+}
+
+InternedString DwarfSession::get_location(uint64_t die_offset) const {
+    if (details_) {
+        auto it = details_->locations.find(die_offset);
+        return it != details_->locations.end() ? it->second : InternedString();
+    }
+
+    InternedString location;
 #ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+    if (!is_open_) return location;
+
+    std::lock_guard<std::mutex> lock(type_names_mutex_);
+    auto it = locations_.find(die_offset);
+    if (it != locations_.end()) {
+        return it->second;
+    }
 
+    Dwarf_Die die;
     Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
+    if (offdie(dies_, die_offset, &die, &err) == DW_DLV_OK) {
+        location = strings_.intern(get_location_string(dies_, die, DW_AT_location));
+        dwarf_dealloc_die(die);
+    }
+    locations_.emplace(die_offset, location);
+#endif
+    return location;
+}
 
-    bool is_info = true;
+std::vector<BaseClassInfo> DwarfSession::get_base_classes() const {
+    return index().base_classes;
+}
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+std::vector<CallInfo> DwarfSession::get_calls() const {
+    return index().calls;
+}
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
-        }
+std::vector<InlinedCallInfo> DwarfSession::get_inlined_calls() const {
+    return index().inlined_calls;
+}
 
-        uint64_t current_func = 0;
-        std::string current_func_name;
+std::vector<NamespaceInfo> DwarfSession::get_namespaces() const {
+    return index().namespaces;
+}
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
+// ============================================================================
+// Address lookups
+// ============================================================================
 
-            if (tag == DW_TAG_subprogram) {
-                current_func = get_die_offset(die);
-                current_func_name = get_die_string(dbg_, die, DW_AT_name);
-                return;
-            }
+const std::vector<LineInfo>& DwarfSession::line_table() const {
+    if (details_) {
+        return details_->lines;
+    }
 
-            // DWARF 5 call site
-            if (tag != DW_TAG_call_site && tag != DW_TAG_GNU_call_site) return;
+    std::lock_guard<std::mutex> lock(lines_mutex_);
+    if (!lines_) {
+        if (!partial_lines_) partial_lines_ = std::make_unique<PartialLines>();
+        lines_ = std::make_unique<std::vector<LineInfo>>(collect_line_info(-1, nullptr, partial_lines_.get()));
+        partial_lines_.reset();
+    }
+    return *lines_;
+}
 
-            CallInfo info;
-            info.caller_offset = current_func;
-            info.caller_name = current_func_name;
+namespace {
 
-            // Get callee through DW_AT_call_origin
-            uint64_t callee_off = get_die_ref(dbg_, die, DW_AT_call_origin);
-            if (callee_off == 0) {
-                callee_off = get_die_ref(dbg_, die, DW_AT_abstract_origin);
+// Rows by [low_pc, high_pc) or, given ranges, by each DW_AT_ranges entry
+// of the rows that have one. Keys are the int64 values the tables expose,
+// so SQL bounds compare the same way.
+template <typename Row>
+std::unique_ptr<IntervalIndex> pc_index(const std::vector<Row>& rows,
+                                        const std::unordered_map<uint64_t, std::vector<AddressRange>>* ranges) {
+    auto index = std::make_unique<IntervalIndex>();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const Row& r = rows[i];
+        const std::vector<AddressRange>* pieces = nullptr;
+        if (ranges) {
+            auto it = ranges->find(r.offset);
+            if (it != ranges->end()) pieces = &it->second;
+        }
+        if (pieces) {
+            for (const AddressRange& range : *pieces) {
+                index->add(static_cast<int64_t>(range.low), static_cast<int64_t>(range.high), static_cast<uint32_t>(i));
             }
+        } else {
+            index->add(static_cast<int64_t>(r.low_pc), static_cast<int64_t>(r.high_pc), static_cast<uint32_t>(i));
+        }
+    }
+    index->finish();
+    return index;
+}
 
-            if (callee_off != 0) {
-                info.callee_offset = callee_off;
-                Dwarf_Die callee_die;
-                if (dwarf_offdie_b(dbg_, callee_off, true, &callee_die, &err) == DW_DLV_OK) {
-                    info.callee_name = get_die_string(dbg_, callee_die, DW_AT_name);
-                    dwarf_dealloc_die(callee_die);
-                }
-            }
+} // anonymous namespace
 
-            info.call_pc = get_die_unsigned(dbg_, die, DW_AT_call_return_pc, 0);
-            if (info.call_pc == 0) {
-                info.call_pc = get_die_unsigned(dbg_, die, DW_AT_low_pc, 0);
-            }
-            info.call_line = static_cast<int>(get_die_signed(dbg_, die, DW_AT_call_line, 0));
-            info.is_tail_call = get_die_flag(die, DW_AT_call_tail_call);
+const IntervalIndex& DwarfSession::function_bounds() const {
+    const DwarfIndex& idx = index();
 
-            result.push_back(info);
-        });
+    std::lock_guard<std::mutex> lock(function_bounds_mutex_);
+    if (!function_bounds_) function_bounds_ = pc_index(idx.functions, nullptr);
+    return *function_bounds_;
+}
 
-        dwarf_dealloc_die(cu_die);
-    }
-#endif
+const IntervalIndex& DwarfSession::inline_bounds() const {
+    const DwarfIndex& idx = index();
 
-    return result;
+    std::lock_guard<std::mutex> lock(inline_bounds_mutex_);
+    if (!inline_bounds_) inline_bounds_ = pc_index(idx.inlined_calls, nullptr);
+    return *inline_bounds_;
 }
 
-std::vector<InlinedCallInfo> DwarfSession::get_inlined_calls() const {
-    std::vector<InlinedCallInfo> result;
+const IntervalIndex& DwarfSession::function_ranges() const {
+    const DwarfIndex& idx = index();
 
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+    std::lock_guard<std::mutex> lock(function_ranges_mutex_);
+    if (!function_ranges_) function_ranges_ = pc_index(idx.functions, &idx.address_ranges);
+    return *function_ranges_;
+}
 
-    Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
+const IntervalIndex& DwarfSession::inline_ranges() const {
+    const DwarfIndex& idx = index();
 
-    bool is_info = true;
+    std::lock_guard<std::mutex> lock(inline_ranges_mutex_);
+    if (!inline_ranges_) inline_ranges_ = pc_index(idx.inlined_calls, &idx.address_ranges);
+    return *inline_ranges_;
+}
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+const SortedIndex& DwarfSession::line_ranges() const {
+    const std::vector<LineInfo>& lines = line_table();
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
-            continue;
+    std::lock_guard<std::mutex> lock(line_ranges_mutex_);
+    if (!line_ranges_) {
+        auto ranges = std::make_unique<SortedIndex>();
+        for (size_t i = 0; i < lines.size(); ++i) {
+            ranges->add(static_cast<int64_t>(lines[i].address()), static_cast<uint32_t>(i));
         }
+        ranges->finish();
+        line_ranges_ = std::move(ranges);
+    }
+    return *line_ranges_;
+}
 
-        uint64_t current_func = 0;
-
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
-
-            if (tag == DW_TAG_subprogram) {
-                current_func = get_die_offset(die);
-                return;
-            }
+const CallGraph& DwarfSession::call_graph() const {
+    const DwarfIndex& idx = index();
 
-            if (tag != DW_TAG_inlined_subroutine) return;
+    std::lock_guard<std::mutex> lock(graph_mutex_);
+    if (graph_) {
+        return *graph_;
+    }
 
-            InlinedCallInfo info;
-            info.offset = get_die_offset(die);
-            info.abstract_origin = get_die_ref(dbg_, die, DW_AT_abstract_origin);
-            info.caller_offset = current_func;
+    auto graph = std::make_unique<CallGraph>();
+    std::unordered_map<uint64_t, const DieInfo*> by_offset;
+    for (const auto& f : idx.functions) {
+        by_offset.emplace(f.offset, &f);
+    }
 
-            // Get name from abstract origin
-            if (info.abstract_origin != 0) {
-                Dwarf_Die origin_die;
-                if (dwarf_offdie_b(dbg_, info.abstract_origin, true, &origin_die, &err) == DW_DLV_OK) {
-                    info.name = get_die_string(dbg_, origin_die, DW_AT_name);
-                    dwarf_dealloc_die(origin_die);
-                }
-            }
+    // One node per function: follow DW_AT_specification / DW_AT_abstract_origin
+    // to the DIE that names it, and key external functions by linkage name
+    // so their declarations in every unit meet
+    std::unordered_map<std::string_view, uint32_t> external;
+    std::unordered_map<uint64_t, uint32_t> local;
+    uint32_t count = 0;
+    auto node_for = [&](const DieInfo& f) {
+        const DieInfo* root = &f;
+        bool is_external = f.is_external;
+        InternedString linkage = f.linkage_name;
+        for (int hops = 0; root->origin_offset != 0 && hops < 8; ++hops) {
+            auto it = by_offset.find(root->origin_offset);
+            if (it == by_offset.end()) break;
+            root = it->second;
+            is_external = is_external || root->is_external;
+            if (linkage.empty()) linkage = root->linkage_name;
+        }
+        if (linkage.empty()) linkage = root->name;
 
-            info.low_pc = get_die_unsigned(dbg_, die, DW_AT_low_pc, 0);
-            info.high_pc = get_high_pc(dbg_, die, info.low_pc);
-            info.call_line = static_cast<int>(get_die_signed(dbg_, die, DW_AT_call_line, 0));
-            info.call_column = static_cast<int>(get_die_signed(dbg_, die, DW_AT_call_column, 0));
+        if (is_external && !linkage.empty()) {
+            return external.emplace(linkage, count).first->second;
+        }
+        return local.emplace(root->offset, count).first->second;
+    };
+    for (const auto& f : idx.functions) {
+        uint32_t node = node_for(f);
+        if (node == count) ++count;
+        graph->nodes.emplace(f.offset, node);
+    }
 
-            result.push_back(info);
-        });
+    // Call sites whose ends were not indexed (e.g. a unit that failed to
+    // decode) still get a node of their own
+    auto node_at = [&](uint64_t offset) {
+        auto it = graph->nodes.find(offset);
+        if (it != graph->nodes.end()) return it->second;
+        uint32_t node = local.emplace(offset, count).first->second;
+        if (node == count) ++count;
+        graph->nodes.emplace(offset, node);
+        return node;
+    };
+    graph->callers.resize(idx.calls.size());
+    graph->callees.resize(idx.calls.size());
+    for (size_t i = 0; i < idx.calls.size(); ++i) {
+        const CallInfo& c = idx.calls[i];
+        graph->callers[i] = node_at(c.caller_offset);
+        graph->callees[i] = c.callee_offset != 0 ? node_at(c.callee_offset) : CallGraph::NO_NODE;
+    }
+    for (size_t i = 0; i < idx.calls.size(); ++i) {
+        graph->calls_from.add(graph->callers[i], static_cast<uint32_t>(i));
+        if (graph->callees[i] != CallGraph::NO_NODE) {
+            graph->calls_to.add(graph->callees[i], static_cast<uint32_t>(i));
+        }
+    }
+    graph->calls_from.finish(count);
+    graph->calls_to.finish(count);
 
-        dwarf_dealloc_die(cu_die);
+    for (size_t i = 0; i < idx.inlined_calls.size(); ++i) {
+        graph->inlined.emplace(idx.inlined_calls[i].offset, static_cast<uint32_t>(i));
+    }
+    graph->inline_parents.resize(idx.inlined_calls.size(), UINT32_MAX);
+    for (size_t i = 0; i < idx.inlined_calls.size(); ++i) {
+        auto it = graph->inlined.find(idx.inlined_calls[i].parent_offset);
+        if (it != graph->inlined.end()) graph->inline_parents[i] = it->second;
     }
-#endif
 
-    return result;
+    graph_ = std::move(graph);
+    return *graph_;
 }
 
-std::vector<NamespaceInfo> DwarfSession::get_namespaces() const {
-    std::vector<NamespaceInfo> result;
+namespace {
 
-#ifdef DWARFSQL_HAS_LIBDWARF
-    if (!is_open_) return result;
+// Breadth-first walk over one direction of the call graph
+std::vector<CallEdge> walk_calls(const DwarfIndex& idx, const CallGraph& graph, const Adjacency& edges,
+                                 const std::vector<uint32_t>& next, uint64_t func_offset, int depth) {
+    std::vector<CallEdge> result;
+    uint32_t start = graph.node_of(func_offset);
+    if (start == CallGraph::NO_NODE) return result;
+
+    std::vector<bool> seen;
+    std::vector<uint32_t> frontier = {start};
+    auto visit = [&seen](uint32_t node) {
+        if (node >= seen.size()) seen.resize(node + 1, false);
+        if (seen[node]) return false;
+        seen[node] = true;
+        return true;
+    };
+    visit(start);
+
+    for (int level = 1; !frontier.empty() && (depth <= 0 || level <= depth); ++level) {
+        std::vector<uint32_t> following;
+        for (uint32_t node : frontier) {
+            RowPositions rows = edges.of(node);
+            for (size_t i = 0; i < rows.size; ++i) {
+                uint32_t row = rows.data()[i];
+                result.push_back({level, &idx.calls[row]});
+                uint32_t other = next[row];
+                if (other != CallGraph::NO_NODE && visit(other)) {
+                    following.push_back(other);
+                }
+            }
+        }
+        frontier = std::move(following);
+    }
+    return result;
+}
 
-    Dwarf_Error err = nullptr;
-    Dwarf_Unsigned cu_header_length;
-    Dwarf_Half version_stamp;
-    Dwarf_Off abbrev_offset;
-    Dwarf_Half address_size;
-    Dwarf_Half length_size;
-    Dwarf_Half extension_size;
-    Dwarf_Sig8 type_signature;
-    Dwarf_Unsigned typeoffset;
-    Dwarf_Unsigned next_cu_header;
-    Dwarf_Half header_cu_type;
+} // anonymous namespace
 
-    bool is_info = true;
+std::vector<CallEdge> DwarfSession::callees_of(uint64_t func_offset, int depth) const {
+    const CallGraph& graph = call_graph();
+    return walk_calls(index(), graph, graph.calls_from, graph.callees, func_offset, depth);
+}
 
-    while (dwarf_next_cu_header_d(dbg_, is_info,
-                                  &cu_header_length, &version_stamp,
-                                  &abbrev_offset, &address_size,
-                                  &length_size, &extension_size,
-                                  &type_signature, &typeoffset,
-                                  &next_cu_header, &header_cu_type,
-                                  &err) == DW_DLV_OK) {
+std::vector<CallEdge> DwarfSession::callers_of(uint64_t func_offset, int depth) const {
+    const CallGraph& graph = call_graph();
+    return walk_calls(index(), graph, graph.calls_to, graph.callers, func_offset, depth);
+}
 
-        Dwarf_Die cu_die;
-        if (dwarf_siblingof_b(dbg_, nullptr, is_info, &cu_die, &err) != DW_DLV_OK) {
+std::vector<InlineFrame> DwarfSession::inline_stack(uint64_t pc) const {
+    const DwarfIndex& idx = index();
+    const CallGraph& graph = call_graph();
+
+    // The innermost inlined call covering pc has the smallest range; its
+    // parents carry on out to the function it was inlined into
+    uint32_t innermost = UINT32_MAX;
+    RowPositions rows = inline_ranges().covering(static_cast<int64_t>(pc));
+    for (size_t i = 0; i < rows.size; ++i) {
+        uint32_t row = rows.data()[i];
+        const InlinedCallInfo& c = idx.inlined_calls[row];
+        if (innermost == UINT32_MAX) {
+            innermost = row;
             continue;
         }
+        // On a tie the nested call comes later in the walk
+        const InlinedCallInfo& best = idx.inlined_calls[innermost];
+        uint64_t size = c.high_pc - c.low_pc;
+        uint64_t best_size = best.high_pc - best.low_pc;
+        if (size < best_size || (size == best_size && row > innermost)) {
+            innermost = row;
+        }
+    }
+
+    std::vector<InlineFrame> frames;
+    for (uint32_t row = innermost; row != UINT32_MAX && frames.size() < idx.inlined_calls.size();
+         row = graph.inline_parents[row]) {
+        frames.push_back({static_cast<int>(frames.size()), &idx.inlined_calls[row]});
+    }
+    return frames;
+}
 
-        uint64_t parent_ns = 0;
+namespace {
 
-        traverse_die(dbg_, cu_die, 0, [&](Dwarf_Die die, int depth) {
-            int tag = get_die_tag(die);
+std::vector<SymbolFrame> symbolize_at(const DwarfIndex& idx, const std::vector<LineInfo>& lines,
+                                      const StringTable& files, const IntervalIndex& function_ranges,
+                                      const IntervalIndex& inline_ranges, const SortedIndex& line_ranges,
+                                      uint64_t pc) {
+    // Smallest function whose code covers pc
+    const DieInfo* func = nullptr;
+    RowPositions funcs = function_ranges.covering(static_cast<int64_t>(pc));
+    for (size_t i = 0; i < funcs.size; ++i) {
+        const DieInfo& f = idx.functions[funcs.data()[i]];
+        if (!func || f.high_pc - f.low_pc < func->high_pc - func->low_pc) {
+            func = &f;
+        }
+    }
 
-            if (tag == DW_TAG_namespace) {
-                NamespaceInfo info;
-                info.offset = get_die_offset(die);
-                info.name = get_die_string(dbg_, die, DW_AT_name);
-                info.parent_offset = parent_ns;
-                info.is_anonymous = info.name.empty();
+    // Inlined subroutines of that function containing pc, outermost first
+    std::vector<const InlinedCallInfo*> chain;
+    RowPositions inlines = inline_ranges.covering(static_cast<int64_t>(pc));
+    for (size_t i = 0; i < inlines.size; ++i) {
+        const InlinedCallInfo& c = idx.inlined_calls[inlines.data()[i]];
+        if (func && c.caller_offset != func->offset) continue;
+        chain.push_back(&c);
+    }
+    std::stable_sort(chain.begin(), chain.end(), [](const InlinedCallInfo* a, const InlinedCallInfo* b) {
+        if (a->low_pc != b->low_pc) return a->low_pc < b->low_pc;
+        return a->high_pc > b->high_pc;
+    });
+
+    // Innermost source position from the line table row at or before pc
+    InternedString file;
+    int line = 0;
+    int column = 0;
+    bool have_line = false;
+    uint32_t row = 0;
+    if (line_ranges.last_at_or_before(static_cast<int64_t>(pc), row) && !lines[row].end_sequence) {
+        file = files[lines[row].file];
+        line = lines[row].line;
+        column = lines[row].column;
+        have_line = true;
+    }
 
-                result.push_back(info);
-                parent_ns = info.offset;
-            }
-        });
+    std::vector<SymbolFrame> frames;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        SymbolFrame frame;
+        frame.depth = static_cast<int>(frames.size());
+        frame.is_inline = true;
+        frame.offset = (*it)->offset;
+        frame.name = (*it)->name;
+        frame.low_pc = (*it)->low_pc;
+        frame.high_pc = (*it)->high_pc;
+        frame.file = file;
+        frame.line = line;
+        frame.column = column;
+        frames.push_back(std::move(frame));
+
+        // The enclosing frame is positioned at this call site
+        file = InternedString();
+        line = (*it)->call_line;
+        column = (*it)->call_column;
+    }
 
-        dwarf_dealloc_die(cu_die);
+    if (func || (frames.empty() && have_line)) {
+        SymbolFrame frame;
+        frame.depth = static_cast<int>(frames.size());
+        if (func) {
+            frame.offset = func->offset;
+            frame.name = func->name;
+            frame.low_pc = func->low_pc;
+            frame.high_pc = func->high_pc;
+        }
+        frame.file = file;
+        frame.line = line;
+        frame.column = column;
+        frames.push_back(std::move(frame));
     }
-#endif
 
+    return frames;
+}
+
+} // anonymous namespace
+
+std::vector<SymbolFrame> DwarfSession::symbolize(uint64_t pc) const {
+    return symbolize_at(index(), line_table(), line_files_, function_ranges(), inline_ranges(), line_ranges(), pc);
+}
+
+std::vector<std::vector<SymbolFrame>> DwarfSession::symbolize(const std::vector<uint64_t>& pcs) const {
+    const DwarfIndex& idx = index();
+    const std::vector<LineInfo>& lines = line_table();
+    const IntervalIndex& functions = function_ranges();
+    const IntervalIndex& inlines = inline_ranges();
+    const SortedIndex& line_rows = line_ranges();
+
+    std::vector<std::vector<SymbolFrame>> result;
+    result.reserve(pcs.size());
+    for (uint64_t pc : pcs) {
+        result.push_back(symbolize_at(idx, lines, line_files_, functions, inlines, line_rows, pc));
+    }
     return result;
 }
 
@@ -13,156 +13,226 @@
 
 #include <dwarfsql/dwarf_tables.hpp>
 #include <dwarfsql/dwarf_session.hpp>
-#include <xsql/vtable.hpp>
+#include <dwarfsql/dwarf_vtable.hpp>
+#include <dwarfsql/address_index.hpp>
+
+#include <algorithm>
+#include <cstdint>
 
 namespace dwarfsql {
 
+namespace {
+
+// ============================================================================
+// Column helpers
+// ============================================================================
+
+// Offsets and addresses are exposed to SQL as signed 64-bit integers
+int64_t sql_int(uint64_t v) {
+    return static_cast<int64_t>(v);
+}
+
+std::string struct_kind(const DieInfo& s) {
+    switch (s.tag) {
+        case 0x02: return "class";  // DW_TAG_class_type
+        case 0x17: return "union";  // DW_TAG_union_type
+        default: return "struct";   // DW_TAG_structure_type
+    }
+}
+
+std::string access_name(const BaseClassInfo& b) {
+    switch (b.access) {
+        case 1: return "public";
+        case 2: return "protected";
+        case 3: return "private";
+        default: return "";
+    }
+}
+
+// Member and enumerator rows carry the DIE of their parent, which DieInfo has no field for
+
+StructMemberRow struct_member_row(uint64_t struct_offset, DieInfo&& m) {
+    StructMemberRow row;
+    row.id = sql_int(m.offset);
+    row.struct_id = sql_int(struct_offset);
+    row.name = m.name;
+    row.type = m.type;
+    row.offset = sql_int(m.low_pc);
+    row.bit_offset = m.decl_line;
+    row.bit_size = static_cast<int>(m.byte_size);
+    return row;
+}
+
+EnumValueRow enum_value_row(uint64_t enum_offset, DieInfo&& v) {
+    EnumValueRow row;
+    row.id = sql_int(v.offset);
+    row.enum_id = sql_int(enum_offset);
+    row.name = v.name;
+    row.value = v.byte_size;  // const_value stored in byte_size
+    return row;
+}
+
+} // anonymous namespace
+
 // ============================================================================
 // Virtual table registration
 // ============================================================================
 
-void register_tables(xsql::Database& db, DwarfSession& session) {
+std::vector<TableDef> build_tables(DwarfSession& session) {
+    std::vector<TableDef> defs;
+
     // Shared cache: DWARF debug info is immutable for the session, so caching across queries is safe.
+    // Every DIE-backed table reads its rows in place from session.index(), which walks .debug_info
+    // once; line_info reads session.line_table(). Nothing is copied into a per-table cache.
+    // Until the index exists, a scan with a LIMIT decodes one CU at a time and stops with the query.
+    // Locations are decoded per row, only when a query reads the column.
+    // Equality on cu_id/func_id/struct_id/enum_id is pushed down: until the index exists,
+    // such lookups decode only the CU, subprogram, struct or enum they name.
+    // Address bounds on functions, inlined_calls and line_info use session.function_bounds(),
+    // inline_bounds() and line_ranges().
+    // Name equality and prefixes on functions, variables, types and structs use a sorted index
+    // over the rows; until the index exists, definitions are found through the binary's
+    // .debug_names or .gdb_index, which list no declarations (hence the is_declaration gate).
+
+    auto units = [&session]() -> const std::vector<uint64_t>& { return session.get_unit_offsets(); };
 
     // compilation_units table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<CompilationUnitRow>("compilation_units")
-            .column_int64("id", [](const CompilationUnitRow& r) { return r.id; })
-            .column_text("name", [](const CompilationUnitRow& r) { return r.name; })
-            .column_text("comp_dir", [](const CompilationUnitRow& r) { return r.comp_dir; })
-            .column_text("producer", [](const CompilationUnitRow& r) { return r.producer; })
-            .column_int("language", [](const CompilationUnitRow& r) { return r.language; })
-            .column_int64("low_pc", [](const CompilationUnitRow& r) { return r.low_pc; })
-            .column_int64("high_pc", [](const CompilationUnitRow& r) { return r.high_pc; })
-            .cache_builder([&session](std::vector<CompilationUnitRow>& rows) {
-                auto cus = session.get_compilation_units();
-                for (const auto& cu : cus) {
-                    CompilationUnitRow row;
-                    row.id = static_cast<int64_t>(cu.offset);
-                    row.name = cu.name;
-                    row.comp_dir = cu.comp_dir;
-                    row.producer = cu.producer;
-                    row.language = cu.language;
-                    row.low_pc = static_cast<int64_t>(cu.low_pc);
-                    row.high_pc = static_cast<int64_t>(cu.high_pc);
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<CompilationUnit>("compilation_units")
+            .column_int64("id", [](const CompilationUnit& r) { return sql_int(r.offset); })
+            .column_text("name", [](const CompilationUnit& r) { return r.name; })
+            .column_text("comp_dir", [](const CompilationUnit& r) { return r.comp_dir; })
+            .column_text("producer", [](const CompilationUnit& r) { return r.producer; })
+            .column_int("language", [](const CompilationUnit& r) { return r.language; })
+            .column_int64("low_pc", [](const CompilationUnit& r) { return sql_int(r.low_pc); })
+            .column_int64("high_pc", [](const CompilationUnit& r) { return sql_int(r.high_pc); })
+            .cache_source([&session]() -> const std::vector<CompilationUnit>& {
+                return session.index().compilation_units;
             })
+            .scan_units(units, [&session](uint64_t cu, std::vector<CompilationUnit>& rows) {
+                rows = session.index_unit(cu).compilation_units;
+            })
+            .cache_when([&session] { return session.has_index(); })
             .build()
     );
 
     // functions table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<FunctionRow>("functions")
-            .column_int64("id", [](const FunctionRow& r) { return r.id; })
-            .column_int64("cu_id", [](const FunctionRow& r) { return r.cu_id; })
-            .column_text("name", [](const FunctionRow& r) { return r.name; })
-            .column_text("linkage_name", [](const FunctionRow& r) { return r.linkage_name; })
-            .column_int64("low_pc", [](const FunctionRow& r) { return r.low_pc; })
-            .column_int64("high_pc", [](const FunctionRow& r) { return r.high_pc; })
-            .column_text("return_type", [](const FunctionRow& r) { return r.return_type; })
-            .column_int("is_external", [](const FunctionRow& r) { return r.is_external ? 1 : 0; })
-            .column_int("is_declaration", [](const FunctionRow& r) { return r.is_declaration ? 1 : 0; })
-            .column_int("is_inline", [](const FunctionRow& r) { return r.is_inline ? 1 : 0; })
-            .column_int("line", [](const FunctionRow& r) { return r.line; })
-            .cache_builder([&session](std::vector<FunctionRow>& rows) {
-                auto funcs = session.get_functions();
-                for (const auto& f : funcs) {
-                    FunctionRow row;
-                    row.id = static_cast<int64_t>(f.offset);
-                    row.cu_id = 0;  // TODO: track CU relationship
-                    row.name = f.name;
-                    row.linkage_name = f.linkage_name;
-                    row.low_pc = static_cast<int64_t>(f.low_pc);
-                    row.high_pc = static_cast<int64_t>(f.high_pc);
-                    row.is_external = f.is_external;
-                    row.is_declaration = f.is_declaration;
-                    row.line = f.decl_line;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<DieInfo>("functions")
+            .column_int64("id", [](const DieInfo& r) { return sql_int(r.offset); })
+            .column_int64("cu_id", [](const DieInfo& r) { return sql_int(r.cu_offset); })
+            .column_text("name", [](const DieInfo& r) { return r.name; })
+            .column_text("linkage_name", [](const DieInfo& r) { return r.linkage_name; })
+            .column_int64("low_pc", [](const DieInfo& r) { return sql_int(r.low_pc); })
+            .column_int64("high_pc", [](const DieInfo& r) { return sql_int(r.high_pc); })
+            .column_text("return_type", [](const DieInfo& r) { return r.type; })
+            .column_int("is_external", [](const DieInfo& r) { return r.is_external ? 1 : 0; })
+            .column_int("is_declaration", [](const DieInfo& r) { return r.is_declaration ? 1 : 0; })
+            .column_int("is_inline", [](const DieInfo& r) { return r.is_inline ? 1 : 0; })
+            .column_int("line", [](const DieInfo& r) { return r.decl_line; })
+            .cache_source([&session]() -> const std::vector<DieInfo>& {
+                return session.index().functions;
+            })
+            .scan_units(units, [&session](uint64_t cu, std::vector<DieInfo>& rows) {
+                rows = session.index_unit(cu).functions;
+            })
+            .cache_when([&session] { return session.has_index(); })
+            .filter_eq("cu_id", [&session](int64_t cu_id, std::vector<DieInfo>& rows) {
+                rows = session.get_functions(cu_id);
+            })
+            .filter_name("name", [&session](const NameKey& key, std::vector<DieInfo>& rows) {
+                return session.find_named(NameKind::Function, key, rows);
+            }, "is_declaration", 0)
+            .filter_range("low_pc", "high_pc", [&session](int64_t low_max, int64_t high_min) {
+                return session.function_bounds().find(low_max, high_min);
             })
             .build()
     );
 
     // variables table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<VariableRow>("variables")
-            .column_int64("id", [](const VariableRow& r) { return r.id; })
-            .column_int64("cu_id", [](const VariableRow& r) { return r.cu_id; })
-            .column_int64("func_id", [](const VariableRow& r) { return r.func_id; })
-            .column_text("name", [](const VariableRow& r) { return r.name; })
-            .column_text("type", [](const VariableRow& r) { return r.type; })
-            .column_text("location", [](const VariableRow& r) { return r.location; })
-            .column_int("is_parameter", [](const VariableRow& r) { return r.is_parameter ? 1 : 0; })
-            .column_int("line", [](const VariableRow& r) { return r.line; })
-            .cache_builder([&session](std::vector<VariableRow>& rows) {
-                auto vars = session.get_variables();
-                for (const auto& v : vars) {
-                    VariableRow row;
-                    row.id = static_cast<int64_t>(v.offset);
-                    row.name = v.name;
-                    row.line = v.decl_line;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<DieInfo>("variables")
+            .column_int64("id", [](const DieInfo& r) { return sql_int(r.offset); })
+            .column_int64("cu_id", [](const DieInfo& r) { return sql_int(r.cu_offset); })
+            .column_int64("func_id", [](const DieInfo& r) {
+                return r.func_offset != 0 ? sql_int(r.func_offset) : -1;  // -1 for global
+            })
+            .column_text("name", [](const DieInfo& r) { return r.name; })
+            .column_text("type", [](const DieInfo& r) { return r.type; })
+            .column_text("location", [](const DieInfo&) { return std::string(); })
+            .column_int("is_parameter", [](const DieInfo& r) {
+                return r.tag == 0x05 ? 1 : 0;  // DW_TAG_formal_parameter
+            })
+            .column_int("line", [](const DieInfo& r) { return r.decl_line; })
+            .cache_source([&session]() -> const std::vector<DieInfo>& {
+                return session.index().variables;
+            })
+            .scan_units(units, [&session](uint64_t cu, std::vector<DieInfo>& rows) {
+                rows = session.index_unit(cu).variables;
+            })
+            .cache_when([&session] { return session.has_index(); })
+            .filter_eq("func_id", [&session](int64_t func_id, std::vector<DieInfo>& rows) {
+                rows = session.get_variables(-1, func_id);
             })
+            .filter_eq("cu_id", [&session](int64_t cu_id, std::vector<DieInfo>& rows) {
+                rows = session.get_variables(cu_id);
+            })
+            .filter_name("name")  // Locals and extern declarations are in no accelerator table
             .build()
     );
 
     // types table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<TypeRow>("types")
-            .column_int64("id", [](const TypeRow& r) { return r.id; })
-            .column_int64("cu_id", [](const TypeRow& r) { return r.cu_id; })
-            .column_text("name", [](const TypeRow& r) { return r.name; })
-            .column_int("tag", [](const TypeRow& r) { return r.tag; })
-            .column_int64("byte_size", [](const TypeRow& r) { return r.byte_size; })
-            .cache_builder([&session](std::vector<TypeRow>& rows) {
-                auto types = session.get_types();
-                for (const auto& t : types) {
-                    TypeRow row;
-                    row.id = static_cast<int64_t>(t.offset);
-                    row.name = t.name;
-                    row.tag = t.tag;
-                    row.byte_size = t.byte_size;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<DieInfo>("types")
+            .column_int64("id", [](const DieInfo& r) { return sql_int(r.offset); })
+            .column_int64("cu_id", [](const DieInfo& r) { return sql_int(r.cu_offset); })
+            .column_text("name", [](const DieInfo& r) { return r.name; })
+            .column_int("tag", [](const DieInfo& r) { return r.tag; })
+            .column_int64("byte_size", [](const DieInfo& r) { return r.byte_size; })
+            .cache_source([&session]() -> const std::vector<DieInfo>& {
+                return session.index().types;
+            })
+            .scan_units(units, [&session](uint64_t cu, std::vector<DieInfo>& rows) {
+                rows = session.index_unit(cu).types;
+            })
+            .cache_when([&session] { return session.has_index(); })
+            .filter_eq("cu_id", [&session](int64_t cu_id, std::vector<DieInfo>& rows) {
+                rows = session.get_types(cu_id);
+            })
+            .filter_name("name", [&session](const NameKey& key, std::vector<DieInfo>& rows) {
+                return session.find_named(NameKind::Type, key, rows);
             })
             .build()
     );
 
     // structs table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<StructRow>("structs")
-            .column_int64("id", [](const StructRow& r) { return r.id; })
-            .column_int64("cu_id", [](const StructRow& r) { return r.cu_id; })
-            .column_text("name", [](const StructRow& r) { return r.name; })
-            .column_text("kind", [](const StructRow& r) { return r.kind; })
-            .column_int64("byte_size", [](const StructRow& r) { return r.byte_size; })
-            .column_int("is_declaration", [](const StructRow& r) { return r.is_declaration ? 1 : 0; })
-            .cache_builder([&session](std::vector<StructRow>& rows) {
-                auto structs = session.get_structs();
-                for (const auto& s : structs) {
-                    StructRow row;
-                    row.id = static_cast<int64_t>(s.offset);
-                    row.name = s.name;
-                    row.byte_size = s.byte_size;
-                    row.is_declaration = s.is_declaration;
-                    // Determine kind from tag
-                    switch (s.tag) {
-                        case 0x13: row.kind = "struct"; break;  // DW_TAG_structure_type
-                        case 0x02: row.kind = "class"; break;   // DW_TAG_class_type
-                        case 0x17: row.kind = "union"; break;   // DW_TAG_union_type
-                        default: row.kind = "struct"; break;
-                    }
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<DieInfo>("structs")
+            .column_int64("id", [](const DieInfo& r) { return sql_int(r.offset); })
+            .column_int64("cu_id", [](const DieInfo& r) { return sql_int(r.cu_offset); })
+            .column_text("name", [](const DieInfo& r) { return r.name; })
+            .column_text("kind", [](const DieInfo& r) { return struct_kind(r); })
+            .column_int64("byte_size", [](const DieInfo& r) { return r.byte_size; })
+            .column_int("is_declaration", [](const DieInfo& r) { return r.is_declaration ? 1 : 0; })
+            .cache_source([&session]() -> const std::vector<DieInfo>& {
+                return session.index().structs;
+            })
+            .scan_units(units, [&session](uint64_t cu, std::vector<DieInfo>& rows) {
+                rows = session.index_unit(cu).structs;
+            })
+            .cache_when([&session] { return session.has_index(); })
+            .filter_eq("cu_id", [&session](int64_t cu_id, std::vector<DieInfo>& rows) {
+                rows = session.get_structs(cu_id);
             })
+            .filter_name("name", [&session](const NameKey& key, std::vector<DieInfo>& rows) {
+                return session.find_named(NameKind::Struct, key, rows);
+            }, "is_declaration", 0)
             .build()
     );
 
     // struct_members table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<StructMemberRow>("struct_members")
+    defs.push_back(
+        TableBuilder<StructMemberRow>("struct_members")
             .column_int64("id", [](const StructMemberRow& r) { return r.id; })
             .column_int64("struct_id", [](const StructMemberRow& r) { return r.struct_id; })
             .column_text("name", [](const StructMemberRow& r) { return r.name; })
@@ -171,258 +241,306 @@ void register_tables(xsql::Database& db, DwarfSession& session) {
             .column_int("bit_offset", [](const StructMemberRow& r) { return r.bit_offset; })
             .column_int("bit_size", [](const StructMemberRow& r) { return r.bit_size; })
             .cache_builder([&session](std::vector<StructMemberRow>& rows) {
-                auto structs = session.get_structs();
-                for (const auto& s : structs) {
+                for (const auto& s : session.index().structs) {
                     if (s.is_declaration) continue;
-                    auto members = session.get_struct_members(s.offset);
-                    for (const auto& m : members) {
-                        StructMemberRow row;
-                        row.id = static_cast<int64_t>(m.offset);
-                        row.struct_id = static_cast<int64_t>(s.offset);
-                        row.name = m.name;
-                        row.offset = static_cast<int64_t>(m.low_pc);
-                        row.bit_offset = m.decl_line;
-                        row.bit_size = static_cast<int>(m.byte_size);
-                        rows.push_back(row);
-                    }
+                    session.get_struct_members(s.offset, [&](DieInfo&& m) {
+                        rows.push_back(struct_member_row(s.offset, std::move(m)));
+                    });
                 }
             })
+            .filter_eq("struct_id", [&session](int64_t struct_id, std::vector<StructMemberRow>& rows) {
+                uint64_t offset = static_cast<uint64_t>(struct_id);
+                session.get_struct_members(offset, [&](DieInfo&& m) {
+                    rows.push_back(struct_member_row(offset, std::move(m)));
+                });
+            })
             .build()
     );
 
     // enums table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<EnumRow>("enums")
-            .column_int64("id", [](const EnumRow& r) { return r.id; })
-            .column_int64("cu_id", [](const EnumRow& r) { return r.cu_id; })
-            .column_text("name", [](const EnumRow& r) { return r.name; })
-            .column_int64("byte_size", [](const EnumRow& r) { return r.byte_size; })
-            .cache_builder([&session](std::vector<EnumRow>& rows) {
-                auto enums = session.get_enums();
-                for (const auto& e : enums) {
-                    EnumRow row;
-                    row.id = static_cast<int64_t>(e.offset);
-                    row.name = e.name;
-                    row.byte_size = e.byte_size;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<DieInfo>("enums")
+            .column_int64("id", [](const DieInfo& r) { return sql_int(r.offset); })
+            .column_int64("cu_id", [](const DieInfo& r) { return sql_int(r.cu_offset); })
+            .column_text("name", [](const DieInfo& r) { return r.name; })
+            .column_int64("byte_size", [](const DieInfo& r) { return r.byte_size; })
+            .cache_source([&session]() -> const std::vector<DieInfo>& {
+                return session.index().enums;
+            })
+            .scan_units(units, [&session](uint64_t cu, std::vector<DieInfo>& rows) {
+                rows = session.index_unit(cu).enums;
+            })
+            .cache_when([&session] { return session.has_index(); })
+            .filter_eq("cu_id", [&session](int64_t cu_id, std::vector<DieInfo>& rows) {
+                rows = session.get_enums(cu_id);
             })
             .build()
     );
 
     // enum_values table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<EnumValueRow>("enum_values")
+    defs.push_back(
+        TableBuilder<EnumValueRow>("enum_values")
             .column_int64("id", [](const EnumValueRow& r) { return r.id; })
             .column_int64("enum_id", [](const EnumValueRow& r) { return r.enum_id; })
             .column_text("name", [](const EnumValueRow& r) { return r.name; })
             .column_int64("value", [](const EnumValueRow& r) { return r.value; })
             .cache_builder([&session](std::vector<EnumValueRow>& rows) {
-                auto enums = session.get_enums();
-                for (const auto& e : enums) {
-                    auto values = session.get_enum_values(e.offset);
-                    for (const auto& v : values) {
-                        EnumValueRow row;
-                        row.id = static_cast<int64_t>(v.offset);
-                        row.enum_id = static_cast<int64_t>(e.offset);
-                        row.name = v.name;
-                        row.value = v.byte_size;  // const_value stored in byte_size
-                        rows.push_back(row);
-                    }
+                for (const auto& e : session.index().enums) {
+                    session.get_enum_values(e.offset, [&](DieInfo&& v) {
+                        rows.push_back(enum_value_row(e.offset, std::move(v)));
+                    });
                 }
             })
+            .filter_eq("enum_id", [&session](int64_t enum_id, std::vector<EnumValueRow>& rows) {
+                uint64_t offset = static_cast<uint64_t>(enum_id);
+                session.get_enum_values(offset, [&](DieInfo&& v) {
+                    rows.push_back(enum_value_row(offset, std::move(v)));
+                });
+            })
             .build()
     );
 
     // line_info table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<LineInfoRow>("line_info")
-            .column_int64("address", [](const LineInfoRow& r) { return r.address; })
-            .column_text("file", [](const LineInfoRow& r) { return r.file; })
-            .column_int("line", [](const LineInfoRow& r) { return r.line; })
-            .column_int("column", [](const LineInfoRow& r) { return r.column; })
-            .column_int("is_stmt", [](const LineInfoRow& r) { return r.is_stmt ? 1 : 0; })
-            .column_int("basic_block", [](const LineInfoRow& r) { return r.basic_block ? 1 : 0; })
-            .column_int("end_sequence", [](const LineInfoRow& r) { return r.end_sequence ? 1 : 0; })
-            .cache_builder([&session](std::vector<LineInfoRow>& rows) {
-                auto lines = session.get_line_info();
-                for (const auto& l : lines) {
-                    LineInfoRow row;
-                    row.address = static_cast<int64_t>(l.address);
-                    row.file = l.file;
-                    row.line = l.line;
-                    row.column = l.column;
-                    row.is_stmt = l.is_stmt;
-                    row.basic_block = l.basic_block;
-                    row.end_sequence = l.end_sequence;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<LineInfo>("line_info")
+            .column_int64("address", [](const LineInfo& r) { return sql_int(r.address()); })
+            .column_text("file", [&session](const LineInfo& r) { return session.line_files()[r.file]; })
+            .column_int("line", [](const LineInfo& r) { return r.line; })
+            .column_int("column", [](const LineInfo& r) { return static_cast<int>(r.column); })
+            .column_int("is_stmt", [](const LineInfo& r) { return r.is_stmt ? 1 : 0; })
+            .column_int("basic_block", [](const LineInfo& r) { return r.basic_block ? 1 : 0; })
+            .column_int("end_sequence", [](const LineInfo& r) { return r.end_sequence ? 1 : 0; })
+            .cache_source([&session]() -> const std::vector<LineInfo>& {
+                return session.line_table();
+            })
+            .filter_range("address", "address", [&session](int64_t low_max, int64_t high_min) {
+                return session.line_ranges().find(high_min, low_max);
             })
             .build()
     );
 
     // parameters table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<ParameterRow>("parameters")
-            .column_int64("id", [](const ParameterRow& r) { return r.id; })
-            .column_int64("func_id", [](const ParameterRow& r) { return r.func_id; })
-            .column_text("name", [](const ParameterRow& r) { return r.name; })
-            .column_text("type", [](const ParameterRow& r) { return r.type; })
-            .column_int("param_index", [](const ParameterRow& r) { return r.index; })
-            .column_text("location", [](const ParameterRow& r) { return r.location; })
-            .cache_builder([&session](std::vector<ParameterRow>& rows) {
-                auto params = session.get_parameters();
-                for (const auto& p : params) {
-                    ParameterRow row;
-                    row.id = static_cast<int64_t>(p.offset);
-                    row.func_id = static_cast<int64_t>(p.func_offset);
-                    row.name = p.name;
-                    row.type = p.type;
-                    row.index = p.index;
-                    row.location = p.location;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<ParameterInfo>("parameters")
+            .column_int64("id", [](const ParameterInfo& r) { return sql_int(r.offset); })
+            .column_int64("func_id", [](const ParameterInfo& r) { return sql_int(r.func_offset); })
+            .column_text("name", [](const ParameterInfo& r) { return r.name; })
+            .column_text("type", [](const ParameterInfo& r) { return r.type; })
+            .column_int("param_index", [](const ParameterInfo& r) { return r.index; })
+            .column_text("location", [&session](const ParameterInfo& r) { return session.get_location(r.offset); })
+            .cache_source([&session]() -> const std::vector<ParameterInfo>& {
+                return session.index().parameters;
+            })
+            .scan_units(units, [&session](uint64_t cu, std::vector<ParameterInfo>& rows) {
+                rows = session.index_unit(cu).parameters;
+            })
+            .cache_when([&session] { return session.has_index(); })
+            .filter_eq("func_id", [&session](int64_t func_id, std::vector<ParameterInfo>& rows) {
+                rows = session.get_parameters(func_id);
             })
             .build()
     );
 
     // local_variables table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<LocalVariableRow>("local_variables")
-            .column_int64("id", [](const LocalVariableRow& r) { return r.id; })
-            .column_int64("func_id", [](const LocalVariableRow& r) { return r.func_id; })
-            .column_text("name", [](const LocalVariableRow& r) { return r.name; })
-            .column_text("type", [](const LocalVariableRow& r) { return r.type; })
-            .column_text("location", [](const LocalVariableRow& r) { return r.location; })
-            .column_int("line", [](const LocalVariableRow& r) { return r.line; })
-            .column_int64("scope_low_pc", [](const LocalVariableRow& r) { return r.scope_low_pc; })
-            .column_int64("scope_high_pc", [](const LocalVariableRow& r) { return r.scope_high_pc; })
-            .cache_builder([&session](std::vector<LocalVariableRow>& rows) {
-                auto vars = session.get_local_variables();
-                for (const auto& v : vars) {
-                    LocalVariableRow row;
-                    row.id = static_cast<int64_t>(v.offset);
-                    row.func_id = static_cast<int64_t>(v.func_offset);
-                    row.name = v.name;
-                    row.type = v.type;
-                    row.location = v.location;
-                    row.line = v.decl_line;
-                    row.scope_low_pc = static_cast<int64_t>(v.scope_low_pc);
-                    row.scope_high_pc = static_cast<int64_t>(v.scope_high_pc);
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<LocalVarInfo>("local_variables")
+            .column_int64("id", [](const LocalVarInfo& r) { return sql_int(r.offset); })
+            .column_int64("func_id", [](const LocalVarInfo& r) { return sql_int(r.func_offset); })
+            .column_text("name", [](const LocalVarInfo& r) { return r.name; })
+            .column_text("type", [](const LocalVarInfo& r) { return r.type; })
+            .column_text("location", [&session](const LocalVarInfo& r) { return session.get_location(r.offset); })
+            .column_int("line", [](const LocalVarInfo& r) { return r.decl_line; })
+            .column_int64("scope_low_pc", [](const LocalVarInfo& r) { return sql_int(r.scope_low_pc); })
+            .column_int64("scope_high_pc", [](const LocalVarInfo& r) { return sql_int(r.scope_high_pc); })
+            .cache_source([&session]() -> const std::vector<LocalVarInfo>& {
+                return session.index().local_variables;
+            })
+            .scan_units(units, [&session](uint64_t cu, std::vector<LocalVarInfo>& rows) {
+                rows = session.index_unit(cu).local_variables;
+            })
+            .cache_when([&session] { return session.has_index(); })
+            .filter_eq("func_id", [&session](int64_t func_id, std::vector<LocalVarInfo>& rows) {
+                rows = session.get_local_variables(func_id);
             })
             .build()
     );
 
     // base_classes table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<BaseClassRow>("base_classes")
-            .column_int64("derived_id", [](const BaseClassRow& r) { return r.derived_id; })
-            .column_text("derived_name", [](const BaseClassRow& r) { return r.derived_name; })
-            .column_int64("base_id", [](const BaseClassRow& r) { return r.base_id; })
-            .column_text("base_name", [](const BaseClassRow& r) { return r.base_name; })
-            .column_int64("offset", [](const BaseClassRow& r) { return r.offset; })
-            .column_int("is_virtual", [](const BaseClassRow& r) { return r.is_virtual ? 1 : 0; })
-            .column_text("access", [](const BaseClassRow& r) { return r.access; })
-            .cache_builder([&session](std::vector<BaseClassRow>& rows) {
-                auto bases = session.get_base_classes();
-                for (const auto& b : bases) {
-                    BaseClassRow row;
-                    row.derived_id = static_cast<int64_t>(b.derived_offset);
-                    row.derived_name = b.derived_name;
-                    row.base_id = static_cast<int64_t>(b.base_offset);
-                    row.base_name = b.base_name;
-                    row.offset = b.data_member_offset;
-                    row.is_virtual = b.is_virtual;
-                    switch (b.access) {
-                        case 1: row.access = "public"; break;
-                        case 2: row.access = "protected"; break;
-                        case 3: row.access = "private"; break;
-                        default: row.access = ""; break;
-                    }
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<BaseClassInfo>("base_classes")
+            .column_int64("derived_id", [](const BaseClassInfo& r) { return sql_int(r.derived_offset); })
+            .column_text("derived_name", [](const BaseClassInfo& r) { return r.derived_name; })
+            .column_int64("base_id", [](const BaseClassInfo& r) { return sql_int(r.base_offset); })
+            .column_text("base_name", [](const BaseClassInfo& r) { return r.base_name; })
+            .column_int64("offset", [](const BaseClassInfo& r) { return r.data_member_offset; })
+            .column_int("is_virtual", [](const BaseClassInfo& r) { return r.is_virtual ? 1 : 0; })
+            .column_text("access", [](const BaseClassInfo& r) { return access_name(r); })
+            .cache_source([&session]() -> const std::vector<BaseClassInfo>& {
+                return session.index().base_classes;
             })
             .build()
     );
 
     // calls table (DWARF 5 call sites)
-    db.register_cached_table(
-        xsql::CachedTableBuilder<CallRow>("calls")
-            .column_int64("caller_id", [](const CallRow& r) { return r.caller_id; })
-            .column_text("caller_name", [](const CallRow& r) { return r.caller_name; })
-            .column_int64("callee_id", [](const CallRow& r) { return r.callee_id; })
-            .column_text("callee_name", [](const CallRow& r) { return r.callee_name; })
-            .column_int64("call_pc", [](const CallRow& r) { return r.call_pc; })
-            .column_int("call_line", [](const CallRow& r) { return r.call_line; })
-            .column_int("is_tail_call", [](const CallRow& r) { return r.is_tail_call ? 1 : 0; })
-            .cache_builder([&session](std::vector<CallRow>& rows) {
-                auto calls = session.get_calls();
-                for (const auto& c : calls) {
-                    CallRow row;
-                    row.caller_id = static_cast<int64_t>(c.caller_offset);
-                    row.caller_name = c.caller_name;
-                    row.callee_id = static_cast<int64_t>(c.callee_offset);
-                    row.callee_name = c.callee_name;
-                    row.call_pc = static_cast<int64_t>(c.call_pc);
-                    row.call_line = c.call_line;
-                    row.is_tail_call = c.is_tail_call;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<CallInfo>("calls")
+            .column_int64("caller_id", [](const CallInfo& r) { return sql_int(r.caller_offset); })
+            .column_text("caller_name", [](const CallInfo& r) { return r.caller_name; })
+            .column_int64("callee_id", [](const CallInfo& r) { return sql_int(r.callee_offset); })
+            .column_text("callee_name", [](const CallInfo& r) { return r.callee_name; })
+            .column_int64("call_pc", [](const CallInfo& r) { return sql_int(r.call_pc); })
+            .column_int("call_line", [](const CallInfo& r) { return r.call_line; })
+            .column_int("is_tail_call", [](const CallInfo& r) { return r.is_tail_call ? 1 : 0; })
+            .cache_source([&session]() -> const std::vector<CallInfo>& {
+                return session.index().calls;
             })
             .build()
     );
 
     // inlined_calls table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<InlinedCallRow>("inlined_calls")
-            .column_int64("id", [](const InlinedCallRow& r) { return r.id; })
-            .column_int64("abstract_origin", [](const InlinedCallRow& r) { return r.abstract_origin; })
-            .column_text("name", [](const InlinedCallRow& r) { return r.name; })
-            .column_int64("caller_id", [](const InlinedCallRow& r) { return r.caller_id; })
-            .column_int64("low_pc", [](const InlinedCallRow& r) { return r.low_pc; })
-            .column_int64("high_pc", [](const InlinedCallRow& r) { return r.high_pc; })
-            .column_int("call_line", [](const InlinedCallRow& r) { return r.call_line; })
-            .column_int("call_column", [](const InlinedCallRow& r) { return r.call_column; })
-            .cache_builder([&session](std::vector<InlinedCallRow>& rows) {
-                auto inlined = session.get_inlined_calls();
-                for (const auto& i : inlined) {
-                    InlinedCallRow row;
-                    row.id = static_cast<int64_t>(i.offset);
-                    row.abstract_origin = static_cast<int64_t>(i.abstract_origin);
-                    row.name = i.name;
-                    row.caller_id = static_cast<int64_t>(i.caller_offset);
-                    row.low_pc = static_cast<int64_t>(i.low_pc);
-                    row.high_pc = static_cast<int64_t>(i.high_pc);
-                    row.call_line = i.call_line;
-                    row.call_column = i.call_column;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<InlinedCallInfo>("inlined_calls")
+            .column_int64("id", [](const InlinedCallInfo& r) { return sql_int(r.offset); })
+            .column_int64("abstract_origin", [](const InlinedCallInfo& r) { return sql_int(r.abstract_origin); })
+            .column_text("name", [](const InlinedCallInfo& r) { return r.name; })
+            .column_int64("caller_id", [](const InlinedCallInfo& r) { return sql_int(r.caller_offset); })
+            .column_int64("low_pc", [](const InlinedCallInfo& r) { return sql_int(r.low_pc); })
+            .column_int64("high_pc", [](const InlinedCallInfo& r) { return sql_int(r.high_pc); })
+            .column_int("call_line", [](const InlinedCallInfo& r) { return r.call_line; })
+            .column_int("call_column", [](const InlinedCallInfo& r) { return r.call_column; })
+            .cache_source([&session]() -> const std::vector<InlinedCallInfo>& {
+                return session.index().inlined_calls;
+            })
+            .filter_range("low_pc", "high_pc", [&session](int64_t low_max, int64_t high_min) {
+                return session.inline_bounds().find(low_max, high_min);
             })
             .build()
     );
 
     // namespaces table
-    db.register_cached_table(
-        xsql::CachedTableBuilder<NamespaceRow>("namespaces")
-            .column_int64("id", [](const NamespaceRow& r) { return r.id; })
-            .column_text("name", [](const NamespaceRow& r) { return r.name; })
-            .column_int64("parent_id", [](const NamespaceRow& r) { return r.parent_id; })
-            .column_int("is_anonymous", [](const NamespaceRow& r) { return r.is_anonymous ? 1 : 0; })
-            .cache_builder([&session](std::vector<NamespaceRow>& rows) {
-                auto namespaces = session.get_namespaces();
-                for (const auto& ns : namespaces) {
-                    NamespaceRow row;
-                    row.id = static_cast<int64_t>(ns.offset);
-                    row.name = ns.name;
-                    row.parent_id = static_cast<int64_t>(ns.parent_offset);
-                    row.is_anonymous = ns.is_anonymous;
-                    rows.push_back(row);
-                }
+    defs.push_back(
+        TableBuilder<NamespaceInfo>("namespaces")
+            .column_int64("id", [](const NamespaceInfo& r) { return sql_int(r.offset); })
+            .column_text("name", [](const NamespaceInfo& r) { return r.name; })
+            .column_int64("parent_id", [](const NamespaceInfo& r) { return sql_int(r.parent_offset); })
+            .column_int("is_anonymous", [](const NamespaceInfo& r) { return r.is_anonymous ? 1 : 0; })
+            .cache_source([&session]() -> const std::vector<NamespaceInfo>& {
+                return session.index().namespaces;
+            })
+            .build()
+    );
+
+    // symbolize(pc): function, inline chain and source line for an address
+    defs.push_back(
+        TableBuilder<SymbolFrame>("symbolize")
+            .column_int("depth", [](const SymbolFrame& r) { return r.depth; })
+            .column_text("kind", [](const SymbolFrame& r) { return std::string(r.kind()); })
+            .column_int64("id", [](const SymbolFrame& r) { return sql_int(r.offset); })
+            .column_text("name", [](const SymbolFrame& r) { return r.name; })
+            .column_int64("low_pc", [](const SymbolFrame& r) { return sql_int(r.low_pc); })
+            .column_int64("high_pc", [](const SymbolFrame& r) { return sql_int(r.high_pc); })
+            .column_text("file", [](const SymbolFrame& r) { return r.file; })
+            .column_int("line", [](const SymbolFrame& r) { return r.line; })
+            .column_int("column", [](const SymbolFrame& r) { return r.column; })
+            .arguments({"pc"}, [&session](const std::vector<int64_t>& args, std::vector<SymbolFrame>& rows) {
+                rows = session.symbolize(static_cast<uint64_t>(args[0]));
+            })
+            .warm_with([&session] {
+                session.function_ranges();
+                session.inline_ranges();
+                session.line_ranges();
+            })
+            .build()
+    );
+
+    // callees_of(func_id, max_depth) / callers_of(func_id, max_depth): call sites around a function
+    auto call_walk = [&session](const char* name, bool callers) {
+        return TableBuilder<CallEdge>(name)
+            .column_int("depth", [](const CallEdge& r) { return r.depth; })
+            .column_int64("caller_id", [](const CallEdge& r) { return sql_int(r.call->caller_offset); })
+            .column_text("caller_name", [](const CallEdge& r) { return r.call->caller_name; })
+            .column_int64("callee_id", [](const CallEdge& r) { return sql_int(r.call->callee_offset); })
+            .column_text("callee_name", [](const CallEdge& r) { return r.call->callee_name; })
+            .column_int64("call_pc", [](const CallEdge& r) { return sql_int(r.call->call_pc); })
+            .column_int("call_line", [](const CallEdge& r) { return r.call->call_line; })
+            .column_int("is_tail_call", [](const CallEdge& r) { return r.call->is_tail_call ? 1 : 0; })
+            .arguments({"func_id", "max_depth"}, [&session, callers](const std::vector<int64_t>& args,
+                                                                     std::vector<CallEdge>& rows) {
+                uint64_t id = static_cast<uint64_t>(args[0]);
+                int depth = static_cast<int>(std::clamp<int64_t>(args[1], 0, INT32_MAX));
+                rows = callers ? session.callers_of(id, depth) : session.callees_of(id, depth);
+            })
+            .warm_with([&session] { session.call_graph(); })
+            .build();
+    };
+    defs.push_back(call_walk("callees_of", false));
+    defs.push_back(call_walk("callers_of", true));
+
+    // inline_stack(pc): inlined calls enclosing an address, innermost first
+    defs.push_back(
+        TableBuilder<InlineFrame>("inline_stack")
+            .column_int("depth", [](const InlineFrame& r) { return r.depth; })
+            .column_int64("id", [](const InlineFrame& r) { return sql_int(r.call->offset); })
+            .column_int64("abstract_origin", [](const InlineFrame& r) { return sql_int(r.call->abstract_origin); })
+            .column_text("name", [](const InlineFrame& r) { return r.call->name; })
+            .column_int64("caller_id", [](const InlineFrame& r) { return sql_int(r.call->caller_offset); })
+            .column_int64("parent_id", [](const InlineFrame& r) { return sql_int(r.call->parent_offset); })
+            .column_int64("low_pc", [](const InlineFrame& r) { return sql_int(r.call->low_pc); })
+            .column_int64("high_pc", [](const InlineFrame& r) { return sql_int(r.call->high_pc); })
+            .column_int("call_line", [](const InlineFrame& r) { return r.call->call_line; })
+            .column_int("call_column", [](const InlineFrame& r) { return r.call->call_column; })
+            .arguments({"pc"}, [&session](const std::vector<int64_t>& args, std::vector<InlineFrame>& rows) {
+                rows = session.inline_stack(static_cast<uint64_t>(args[0]));
+            })
+            .warm_with([&session] {
+                session.inline_ranges();
+                session.call_graph();
             })
             .build()
     );
+
+    return defs;
+}
+
+std::vector<TableDef> build_tables(SessionSet& sessions, std::vector<std::vector<TableDef>>* module_tables) {
+    std::vector<std::vector<TableDef>> per_module;
+    std::vector<std::string> names;
+    for (size_t m = 0; m < sessions.size(); ++m) {
+        per_module.push_back(build_tables(*sessions[m].session));
+        names.push_back(sessions[m].name);
+    }
+
+    std::vector<TableDef> defs;
+    if (per_module.size() == 1) {
+        defs = per_module[0];
+    } else if (!per_module.empty()) {
+        for (size_t t = 0; t < per_module[0].size(); ++t) {
+            std::vector<TableDef> parts;
+            for (const auto& tables : per_module) {
+                parts.push_back(tables[t]);
+            }
+            defs.push_back(module_table(names, std::move(parts)));
+        }
+    }
+
+    if (module_tables) *module_tables = std::move(per_module);
+    return defs;
+}
+
+void register_tables(xsql::Database& db, const std::vector<TableDef>& defs) {
+    for (const auto& def : defs) {
+        register_table(db, def);
+    }
+}
+
+void reset_tables(const std::vector<TableDef>& defs) {
+    for (const auto& def : defs) {
+        if (def.reset) def.reset();
+    }
+}
+
+void register_tables(xsql::Database& db, DwarfSession& session) {
+    register_tables(db, build_tables(session));
 }
 
 } // namespace dwarfsql
@@ -0,0 +1,627 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * dwarf_vtable.cpp - SQLite module behind TableBuilder tables
+ *
+ * xBestIndex picks the cheapest of
+ * - one usable `col = ?` constraint on a filter column
+ *   (idxNum = filter index, argvIndex = 1), handed to TableDef::open;
+ * - `col = ?`, `col LIKE ?` or `col GLOB ?` on a name filter column
+ *   (idxNum = NAME_PLAN | ..., plus the gate column's `= ?` if any),
+ *   handed to TableDef::open_name with the pattern's literal head;
+ * - an upper bound on a range filter's low column and/or a lower bound on
+ *   its high column (idxNum = RANGE_PLAN | ...), handed to
+ *   TableDef::open_range, which also satisfies ORDER BY low;
+ * - a full scan (idxNum = -1, or SCAN_LIMITED when the query has a LIMIT,
+ *   handed to TableDef::open_scan).
+ * Constraints are not omitted, so SQLite still re-checks every row: strict
+ * bounds can be treated as inclusive, non-integer keys can simply fall
+ * back to a wider set, and a pattern only needs its rows among the
+ * prefix matches.
+ *
+ * Table-valued functions require `arg = ?` on every hidden argument column
+ * and pass the values to TableDef::call.
+ *
+ * A module_table() plans like its parts; a `module = ?` constraint, if any,
+ * is passed last in argv (flagged by idxStr) and selects the part to open.
+ */
+
+#include <dwarfsql/dwarf_vtable.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <new>
+
+namespace dwarfsql {
+
+namespace {
+
+struct Vtab {
+    sqlite3_vtab base;
+    const TableDef* def;
+};
+
+struct Cursor {
+    sqlite3_vtab_cursor base;
+    std::unique_ptr<RowSet> rows;
+    std::vector<int64_t> args;  // Table-valued function arguments, for the hidden columns
+    size_t pos = 0;
+    bool eof = true;  // Of pos; found by xFilter/xNext, which can report a failure
+};
+
+
+// idxNum layout for range plans: RANGE_PLAN | range << 8 | flags
+constexpr int RANGE_PLAN = 1 << 30;
+constexpr int RANGE_HAS_LOW = 1;    // argv has low_max
+constexpr int RANGE_HAS_HIGH = 2;   // argv has high_min
+constexpr int RANGE_SHARED = 4;     // One `col = ?` supplies both bounds
+constexpr int RANGE_DESC = 8;       // ORDER BY low DESC was consumed
+
+// idxNum of a full scan that SQLite may stop early
+constexpr int SCAN_LIMITED = 1 << 29;
+
+// idxNum layout for name plans: NAME_PLAN | filter << 8 | flags
+constexpr int NAME_PLAN = 1 << 28;
+constexpr int NAME_LIKE = 1;   // argv[0] is a LIKE pattern
+constexpr int NAME_GLOB = 2;   // argv[0] is a GLOB pattern
+constexpr int NAME_GATED = 4;  // argv[1] is the value of `gate_column = ?`
+
+// idxStr of a module_table() plan whose last argv is the module name
+const char* const MODULE_ARG = "module";
+
+// Rows of a module_table(): each part's rows in turn, named by the last column
+class ModuleRows : public RowSet {
+public:
+    explicit ModuleRows(int module_column) : module_column_(module_column) {}
+
+    void add(const std::string* module, std::unique_ptr<RowSet> rows) {
+        parts_.push_back({module, std::move(rows)});
+    }
+
+    size_t size() const override {
+        size_t n = 0;
+        for (const auto& part : parts_) n += part.rows->size();
+        return n;
+    }
+
+    // Rows are read in order, so the part holding row is the current one
+    // or, once that runs out, a later one
+    bool has_row(size_t row) override {
+        for (; current_ < parts_.size(); ++current_) {
+            RowSet& rows = *parts_[current_].rows;
+            if (rows.has_row(row - base_)) return true;
+            base_ += rows.size();
+        }
+        return false;
+    }
+
+    void result(sqlite3_context* ctx, size_t row, int col) const override {
+        const Part& part = parts_[current_];
+        if (col == module_column_) {
+            sqlite3_result_text(ctx, part.module->c_str(), static_cast<int>(part.module->size()), SQLITE_STATIC);
+        } else {
+            part.rows->result(ctx, row - base_, col);
+        }
+    }
+
+private:
+    struct Part {
+        const std::string* module;  // Owned by the TableDef
+        std::unique_ptr<RowSet> rows;
+    };
+    std::vector<Part> parts_;
+    int module_column_;
+    size_t current_ = 0;
+    size_t base_ = 0;  // Row number of the current part's first row
+};
+
+const TableDef& def_of(sqlite3_vtab* vtab) {
+    return *reinterpret_cast<Vtab*>(vtab)->def;
+}
+
+int vt_connect(sqlite3* db, void* aux, int, const char* const*, sqlite3_vtab** out, char**) {
+    auto* def = static_cast<const TableDef*>(aux);
+
+    std::string sql = "CREATE TABLE x(";
+    for (size_t i = 0; i < def->columns.size(); ++i) {
+        if (i > 0) sql += ", ";
+        sql += "\"" + def->columns[i].name + "\"";
+        sql += def->columns[i].is_text ? " TEXT" : " INTEGER";
+    }
+    for (const auto& arg : def->arguments) {
+        sql += ", \"" + arg + "\" INTEGER HIDDEN";
+    }
+    sql += ")";
+
+    int rc = sqlite3_declare_vtab(db, sql.c_str());
+    if (rc != SQLITE_OK) return rc;
+
+    auto* vtab = new Vtab();
+    std::memset(&vtab->base, 0, sizeof(vtab->base));
+    vtab->def = def;
+    *out = &vtab->base;
+    return SQLITE_OK;
+}
+
+int vt_disconnect(sqlite3_vtab* vtab) {
+    delete reinterpret_cast<Vtab*>(vtab);
+    return SQLITE_OK;
+}
+
+int best_index_call(const TableDef& def, sqlite3_index_info* info) {
+    int first_hidden = static_cast<int>(def.columns.size());
+    std::vector<int> arg_constraint(def.arguments.size(), -1);
+    bool unusable = false;
+    for (int i = 0; i < info->nConstraint; ++i) {
+        const auto& c = info->aConstraint[i];
+        int arg = c.iColumn - first_hidden;
+        if (arg < 0 || arg >= static_cast<int>(arg_constraint.size())) continue;
+        if (c.op != SQLITE_INDEX_CONSTRAINT_EQ) continue;
+        if (!c.usable) {
+            unusable = true;
+        } else if (arg_constraint[arg] < 0) {
+            arg_constraint[arg] = i;
+        }
+    }
+
+    for (int constraint : arg_constraint) {
+        if (constraint >= 0) continue;
+        // Another join order may supply the argument; otherwise xFilter reports it
+        if (unusable) return SQLITE_CONSTRAINT;
+        info->idxNum = -1;
+        info->estimatedCost = 1e12;
+        return SQLITE_OK;
+    }
+
+    for (size_t a = 0; a < arg_constraint.size(); ++a) {
+        info->aConstraintUsage[arg_constraint[a]].argvIndex = static_cast<int>(a) + 1;
+        info->aConstraintUsage[arg_constraint[a]].omit = 1;
+    }
+    info->idxNum = 0;
+    info->estimatedCost = 1.0;
+    info->estimatedRows = 10;
+    return SQLITE_OK;
+}
+
+// ordered: a range plan may consume ORDER BY (false across several modules)
+int best_index_table(const TableDef& def, sqlite3_index_info* info, bool ordered) {
+    int best_filter = -1;
+    int best_constraint = -1;
+    for (int i = 0; i < info->nConstraint; ++i) {
+        const auto& c = info->aConstraint[i];
+        if (!c.usable || c.op != SQLITE_INDEX_CONSTRAINT_EQ) continue;
+
+        for (size_t f = 0; f < def.filter_columns.size(); ++f) {
+            if (def.filter_columns[f] != c.iColumn) continue;
+            if (best_filter < 0 || static_cast<int>(f) < best_filter) {
+                best_filter = static_cast<int>(f);
+                best_constraint = i;
+            }
+        }
+    }
+
+    if (best_filter >= 0) {
+        info->idxNum = best_filter;
+        info->aConstraintUsage[best_constraint].argvIndex = 1;
+        info->aConstraintUsage[best_constraint].omit = 0;
+        info->estimatedCost = 10.0;
+        info->estimatedRows = 10;
+        return SQLITE_OK;
+    }
+
+    // Name equality beats any range plan; a pattern only a lone bound
+    int name_filter = -1;
+    int name_constraint = -1;
+    int name_flags = 0;
+    for (int i = 0; i < info->nConstraint && name_filter < 0; ++i) {
+        const auto& c = info->aConstraint[i];
+        if (!c.usable) continue;
+        int flags = -1;
+        if (c.op == SQLITE_INDEX_CONSTRAINT_EQ) flags = 0;
+#ifdef SQLITE_INDEX_CONSTRAINT_LIKE
+        if (c.op == SQLITE_INDEX_CONSTRAINT_LIKE) flags = NAME_LIKE;
+        if (c.op == SQLITE_INDEX_CONSTRAINT_GLOB) flags = NAME_GLOB;
+#endif
+        if (flags < 0) continue;
+
+        for (size_t f = 0; f < def.name_filters.size(); ++f) {
+            if (def.name_filters[f].column != c.iColumn) continue;
+            name_filter = static_cast<int>(f);
+            name_constraint = i;
+            name_flags = flags;
+            break;
+        }
+    }
+
+    int best_range = -1;
+    int best_low = -1;
+    int best_high = -1;
+    double best_cost = name_filter < 0 ? 1000000.0 : (name_flags == 0 ? 15.0 : 100.0);
+    for (size_t r = 0; r < def.range_filters.size(); ++r) {
+        const auto& range = def.range_filters[r];
+        int low = -1;
+        int high = -1;
+        for (int i = 0; i < info->nConstraint; ++i) {
+            const auto& c = info->aConstraint[i];
+            if (!c.usable) continue;
+            bool eq = c.op == SQLITE_INDEX_CONSTRAINT_EQ;
+            if (low < 0 && c.iColumn == range.low_column &&
+                (eq || c.op == SQLITE_INDEX_CONSTRAINT_LE || c.op == SQLITE_INDEX_CONSTRAINT_LT)) {
+                low = i;
+            }
+            if (high < 0 && c.iColumn == range.high_column &&
+                (eq || c.op == SQLITE_INDEX_CONSTRAINT_GE || c.op == SQLITE_INDEX_CONSTRAINT_GT)) {
+                high = i;
+            }
+        }
+
+        // Intervals are sorted by low: a lone lower bound on high narrows nothing
+        bool single = range.low_column == range.high_column;
+        if (low < 0 && (high < 0 || !single)) continue;
+
+        double cost = (low >= 0 && high >= 0) ? 20.0 : 1000.0;
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_range = static_cast<int>(r);
+            best_low = low;
+            best_high = high;
+        }
+    }
+
+    if (best_range < 0 && name_filter >= 0) {
+        info->aConstraintUsage[name_constraint].argvIndex = 1;
+        int gate = def.name_filters[name_filter].gate_column;
+        for (int i = 0; i < info->nConstraint && gate >= 0; ++i) {
+            const auto& c = info->aConstraint[i];
+            if (c.usable && c.op == SQLITE_INDEX_CONSTRAINT_EQ && c.iColumn == gate) {
+                info->aConstraintUsage[i].argvIndex = 2;
+                name_flags |= NAME_GATED;
+                break;
+            }
+        }
+        info->idxNum = NAME_PLAN | (name_filter << 8) | name_flags;
+        info->estimatedCost = best_cost;
+        info->estimatedRows = name_flags & (NAME_LIKE | NAME_GLOB) ? 100 : 10;
+        return SQLITE_OK;
+    }
+
+    if (best_range < 0) {
+        info->idxNum = -1;
+#ifdef SQLITE_INDEX_CONSTRAINT_LIMIT
+        // The LIMIT itself is left to SQLite; it only tells the scan to stream
+        for (int i = 0; i < info->nConstraint; ++i) {
+            if (info->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_LIMIT) {
+                info->idxNum = SCAN_LIMITED;
+            }
+        }
+#endif
+        info->estimatedCost = 1000000.0;
+        info->estimatedRows = 1000000;
+        return SQLITE_OK;
+    }
+
+    int flags = 0;
+    int argv = 0;
+    if (best_low >= 0) {
+        flags |= RANGE_HAS_LOW;
+        info->aConstraintUsage[best_low].argvIndex = ++argv;
+    }
+    if (best_high >= 0 && best_high == best_low) {
+        flags |= RANGE_HAS_HIGH | RANGE_SHARED;
+    } else if (best_high >= 0) {
+        flags |= RANGE_HAS_HIGH;
+        info->aConstraintUsage[best_high].argvIndex = ++argv;
+    }
+
+    if (ordered && info->nOrderBy == 1 &&
+        info->aOrderBy[0].iColumn == def.range_filters[best_range].low_column) {
+        info->orderByConsumed = 1;
+        if (info->aOrderBy[0].desc) flags |= RANGE_DESC;
+    }
+
+    info->idxNum = RANGE_PLAN | (best_range << 8) | flags;
+    info->estimatedCost = best_cost;
+    info->estimatedRows = best_cost >= 1000.0 ? 1000 : 10;
+    return SQLITE_OK;
+}
+
+// Usable `module = ?` constraint of a module_table(), or -1
+int module_constraint(const TableDef& def, sqlite3_index_info* info) {
+    if (def.parts.empty()) return -1;
+    int column = static_cast<int>(def.columns.size()) - 1;
+    for (int i = 0; i < info->nConstraint; ++i) {
+        const auto& c = info->aConstraint[i];
+        if (c.usable && c.op == SQLITE_INDEX_CONSTRAINT_EQ && c.iColumn == column) return i;
+    }
+    return -1;
+}
+
+int vt_best_index(sqlite3_vtab* vtab, sqlite3_index_info* info) {
+    const TableDef& def = def_of(vtab);
+    int module = module_constraint(def, info);
+    int rc = def.arguments.empty() ? best_index_table(def, info, def.parts.empty() || module >= 0)
+                                   : best_index_call(def, info);
+    if (rc != SQLITE_OK || module < 0) return rc;
+
+    int argv = 0;
+    for (int i = 0; i < info->nConstraint; ++i) {
+        argv = std::max(argv, info->aConstraintUsage[i].argvIndex);
+    }
+    info->aConstraintUsage[module].argvIndex = argv + 1;
+    info->idxStr = const_cast<char*>(MODULE_ARG);
+    info->estimatedCost /= static_cast<double>(def.parts.size());
+    return SQLITE_OK;
+}
+
+int vt_open(sqlite3_vtab*, sqlite3_vtab_cursor** out) {
+    auto* cursor = new Cursor();
+    std::memset(&cursor->base, 0, sizeof(cursor->base));
+    *out = &cursor->base;
+    return SQLITE_OK;
+}
+
+int vt_close(sqlite3_vtab_cursor* cur) {
+    delete reinterpret_cast<Cursor*>(cur);
+    return SQLITE_OK;
+}
+
+// Integer affinity, as SQLite applies to the comparison itself ('42' = 42)
+bool integer_arg(sqlite3_value* v, int64_t& out) {
+    if (sqlite3_value_numeric_type(v) != SQLITE_INTEGER) return false;
+    out = sqlite3_value_int64(v);
+    return true;
+}
+
+// Function arguments also accept hex text, e.g. symbolize('0x401000'). Text
+// is read by parse_address() alone: numeric affinity would let in ' -1'.
+bool parse_call_arg(sqlite3_value* v, int64_t& out) {
+    if (sqlite3_value_type(v) != SQLITE_TEXT) return integer_arg(v, out);
+
+    const char* text = reinterpret_cast<const char*>(sqlite3_value_text(v));
+    uint64_t parsed = 0;
+    if (!parse_address(std::string_view(text, static_cast<size_t>(sqlite3_value_bytes(v))), parsed)) {
+        return false;
+    }
+    out = static_cast<int64_t>(parsed);
+    return true;
+}
+
+std::unique_ptr<RowSet> open_rows(const TableDef& def, Cursor* cursor, int idx_num,
+                                  int argc, sqlite3_value** argv, std::string& error) {
+    if (!def.arguments.empty()) {
+        cursor->args.assign(def.arguments.size(), 0);
+        for (size_t a = 0; a < def.arguments.size(); ++a) {
+            if (idx_num < 0 || static_cast<int>(a) >= argc) {
+                error = "missing argument " + def.arguments[a];
+                return nullptr;
+            }
+            if (!parse_call_arg(argv[a], cursor->args[a])) {
+                error = def.arguments[a] + " must be an integer";
+                return nullptr;
+            }
+        }
+        return def.call(cursor->args);
+    }
+
+    if (idx_num >= 0 && (idx_num & RANGE_PLAN)) {
+        int range = (idx_num & ~RANGE_PLAN) >> 8;
+        int64_t low_max = std::numeric_limits<int64_t>::max();
+        int64_t high_min = std::numeric_limits<int64_t>::min();
+        int arg = 0;
+        int64_t value = 0;
+        if ((idx_num & RANGE_HAS_LOW) && arg < argc) {
+            if (integer_arg(argv[arg], value)) {
+                low_max = value;
+                if (idx_num & RANGE_SHARED) high_min = value;
+            }
+            ++arg;
+        }
+        if ((idx_num & RANGE_HAS_HIGH) && !(idx_num & RANGE_SHARED) && arg < argc) {
+            if (integer_arg(argv[arg], value)) high_min = value;
+        }
+        return def.open_range(range, low_max, high_min, (idx_num & RANGE_DESC) != 0);
+    }
+
+    if (idx_num == SCAN_LIMITED) {
+        return def.open_scan();
+    }
+
+    if (idx_num >= 0 && (idx_num & NAME_PLAN)) {
+        int filter = (idx_num & ~NAME_PLAN) >> 8;
+        NameKey key;
+        bool usable = argc >= 1 && sqlite3_value_type(argv[0]) == SQLITE_TEXT;
+        if (usable) {
+            std::string_view text(reinterpret_cast<const char*>(sqlite3_value_text(argv[0])),
+                                  static_cast<size_t>(sqlite3_value_bytes(argv[0])));
+            if (idx_num & (NAME_LIKE | NAME_GLOB)) {
+                usable = NameKey::from_pattern(text, (idx_num & NAME_LIKE) != 0, key);
+            } else {
+                key.text = std::string(text);
+            }
+        }
+        // A pattern starting with a wildcard, or a key SQLite compares as a number
+        if (!usable) return def.open(-1, 0);
+
+        bool gated = false;
+        int64_t value = 0;
+        if ((idx_num & NAME_GATED) && argc >= 2 && integer_arg(argv[1], value)) {
+            gated = value == def.name_filters[filter].gate_value;
+        }
+        return def.open_name(filter, key, gated);
+    }
+
+    int filter = idx_num;
+    int64_t value = 0;
+    if (filter >= 0 && !(argc >= 1 && integer_arg(argv[0], value))) {
+        filter = -1;
+    }
+    return def.open(filter, value);
+}
+
+// Rows of every part of a module_table(), or of the one `module = ?` names
+std::unique_ptr<RowSet> open_module_rows(const TableDef& def, Cursor* cursor, int idx_num, const char* idx_str,
+                                         int argc, sqlite3_value** argv, std::string& error) {
+    auto rows = std::make_unique<ModuleRows>(static_cast<int>(def.columns.size()) - 1);
+
+    const char* module = nullptr;
+    if (idx_str && std::strcmp(idx_str, MODULE_ARG) == 0 && argc > 0) {
+        sqlite3_value* name = argv[--argc];
+        if (sqlite3_value_type(name) == SQLITE_NULL) return rows;  // Matches nothing
+        module = reinterpret_cast<const char*>(sqlite3_value_text(name));
+    }
+
+    for (size_t i = 0; i < def.parts.size(); ++i) {
+        if (module && def.modules[i] != module) continue;
+        auto part = open_rows(def.parts[i], cursor, idx_num, argc, argv, error);
+        if (!error.empty()) return nullptr;
+        if (part) rows->add(&def.modules[i], std::move(part));
+    }
+    return rows;
+}
+
+// Record a C++ exception as the error of the statement running on cur
+int report_error(sqlite3_vtab_cursor* cur, const char* what) {
+    Cursor* cursor = reinterpret_cast<Cursor*>(cur);
+    cursor->rows.reset();
+    cursor->eof = true;
+    sqlite3_free(cur->pVtab->zErrMsg);
+    cur->pVtab->zErrMsg = sqlite3_mprintf("%s: %s", def_of(cur->pVtab).name.c_str(), what);
+    return SQLITE_ERROR;
+}
+
+// Whether pos has a row; a lazy row set may decode a unit to tell
+int seek(Cursor* cursor) {
+    try {
+        cursor->eof = !cursor->rows || !cursor->rows->has_row(cursor->pos);
+    } catch (const std::exception& e) {
+        return report_error(&cursor->base, e.what());
+    }
+    return SQLITE_OK;
+}
+
+int vt_filter(sqlite3_vtab_cursor* cur, int idx_num, const char* idx_str, int argc, sqlite3_value** argv) {
+    auto* cursor = reinterpret_cast<Cursor*>(cur);
+    const TableDef& def = def_of(cur->pVtab);
+
+    try {
+        std::string error;
+        cursor->rows = def.parts.empty() ? open_rows(def, cursor, idx_num, argc, argv, error)
+                                         : open_module_rows(def, cursor, idx_num, idx_str, argc, argv, error);
+        if (!error.empty()) {
+            sqlite3_free(cur->pVtab->zErrMsg);
+            cur->pVtab->zErrMsg = sqlite3_mprintf("%s: %s", def.name.c_str(), error.c_str());
+            return SQLITE_ERROR;
+        }
+    } catch (const std::exception& e) {
+        return report_error(cur, e.what());
+    }
+    cursor->pos = 0;
+    return seek(cursor);
+}
+
+int vt_next(sqlite3_vtab_cursor* cur) {
+    auto* cursor = reinterpret_cast<Cursor*>(cur);
+    cursor->pos++;
+    return seek(cursor);
+}
+
+int vt_eof(sqlite3_vtab_cursor* cur) {
+    return reinterpret_cast<Cursor*>(cur)->eof;
+}
+
+int vt_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int col) {
+    auto* cursor = reinterpret_cast<Cursor*>(cur);
+    const TableDef& def = def_of(cur->pVtab);
+    int columns = static_cast<int>(def.columns.size());
+    if (col >= columns) {
+        size_t arg = static_cast<size_t>(col - columns);
+        if (arg < cursor->args.size()) {
+            sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(cursor->args[arg]));
+        }
+        return SQLITE_OK;
+    }
+    try {
+        cursor->rows->result(ctx, cursor->pos, col);
+    } catch (const std::bad_alloc&) {
+        sqlite3_result_error_nomem(ctx);
+    } catch (const std::exception& e) {
+        sqlite3_result_error(ctx, e.what(), -1);
+    }
+    return SQLITE_OK;
+}
+
+int vt_rowid(sqlite3_vtab_cursor* cur, sqlite3_int64* rowid) {
+    *rowid = static_cast<sqlite3_int64>(reinterpret_cast<Cursor*>(cur)->pos);
+    return SQLITE_OK;
+}
+
+sqlite3_module make_module(bool eponymous) {
+    sqlite3_module m;
+    std::memset(&m, 0, sizeof(m));
+    m.iVersion = 0;
+    m.xCreate = eponymous ? nullptr : vt_connect;  // No xCreate: eponymous-only
+    m.xConnect = vt_connect;
+    m.xBestIndex = vt_best_index;
+    m.xDisconnect = vt_disconnect;
+    m.xDestroy = vt_disconnect;
+    m.xOpen = vt_open;
+    m.xClose = vt_close;
+    m.xFilter = vt_filter;
+    m.xNext = vt_next;
+    m.xEof = vt_eof;
+    m.xColumn = vt_column;
+    m.xRowid = vt_rowid;
+    return m;
+}
+
+const sqlite3_module g_module = make_module(false);
+const sqlite3_module g_function_module = make_module(true);
+
+} // anonymous namespace
+
+TableDef module_table(std::vector<std::string> modules, std::vector<TableDef> parts) {
+    TableDef def;
+    if (parts.empty()) return def;
+
+    const TableDef& first = parts.front();
+    def.name = first.name;
+    def.columns = first.columns;
+    def.columns.push_back({"module", true});
+    def.filter_columns = first.filter_columns;
+    def.range_filters = first.range_filters;
+    def.name_filters = first.name_filters;
+    def.arguments = first.arguments;
+    def.reset = [parts] {
+        for (const auto& part : parts) {
+            if (part.reset) part.reset();
+        }
+    };
+    def.modules = std::move(modules);
+    def.parts = std::move(parts);
+    return def;
+}
+
+bool register_table(xsql::Database& db, TableDef def) {
+    sqlite3* handle = db.handle();
+    auto* owned = new TableDef(std::move(def));
+    bool function = !owned->arguments.empty();
+    std::string module = function ? owned->name : "dwarfsql_" + owned->name;
+
+    // SQLite owns the definition from here and deletes it with the module
+    int rc = sqlite3_create_module_v2(handle, module.c_str(),
+                                      function ? &g_function_module : &g_module, owned,
+                                      [](void* p) { delete static_cast<TableDef*>(p); });
+    if (rc != SQLITE_OK) return false;
+    if (function) return true;
+
+    std::string sql = "CREATE VIRTUAL TABLE " + owned->name + " USING " + module;
+    return sqlite3_exec(handle, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+} // namespace dwarfsql
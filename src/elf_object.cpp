@@ -0,0 +1,429 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * elf_object.cpp - libdwarf object access over a mapped ELF image
+ *
+ * Only the section headers are parsed; sections are served in place, or
+ * from inflated copies when compressed. Like the index reader, nothing in
+ * the file is trusted: every header and section must lie within the mapping.
+ */
+
+#include <dwarfsql/elf_object.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <new>
+#include <thread>
+#include <tuple>
+
+#ifdef DWARFSQL_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef DWARFSQL_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace dwarfsql {
+
+namespace {
+
+constexpr uint16_t ET_REL = 1;
+constexpr uint32_t SHT_RELA = 4;
+constexpr uint32_t SHT_NOBITS = 8;
+constexpr uint32_t SHT_REL = 9;
+constexpr uint64_t SHF_COMPRESSED = 0x800;
+constexpr uint16_t SHN_XINDEX = 0xffff;
+constexpr uint32_t ELFCOMPRESS_ZLIB = 1;
+constexpr uint32_t ELFCOMPRESS_ZSTD = 2;
+
+// Fixed-width integer at p in the given byte order (true = little-endian)
+uint64_t read_uint(const uint8_t* p, size_t width, bool little) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < width; ++i) {
+        size_t shift = little ? i : width - 1 - i;
+        v |= static_cast<uint64_t>(p[i]) << (8 * shift);
+    }
+    return v;
+}
+
+bool starts_with(const char* s, const char* prefix) {
+    return std::strncmp(s, prefix, std::strlen(prefix)) == 0;
+}
+
+bool is_debug_section(const char* name) {
+    return starts_with(name, ".debug_") || starts_with(name, ".zdebug_");
+}
+
+#ifdef DWARFSQL_HAS_ZLIB
+bool inflate_zlib(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) {
+    z_stream zs{};
+    if (inflateInit(&zs) != Z_OK) return false;
+
+    // avail_in/avail_out are 32-bit; feed sections larger than that in slices
+    const size_t max_chunk = std::numeric_limits<uInt>::max();
+    size_t in_left = in_size;
+    size_t out_left = out_size;
+    zs.next_in = const_cast<Bytef*>(in);
+    zs.next_out = out;
+    int res = Z_OK;
+    while (res == Z_OK) {
+        if (zs.avail_in == 0) {
+            zs.avail_in = static_cast<uInt>(std::min(in_left, max_chunk));
+            in_left -= zs.avail_in;
+        }
+        if (zs.avail_out == 0) {
+            zs.avail_out = static_cast<uInt>(std::min(out_left, max_chunk));
+            out_left -= zs.avail_out;
+        }
+        res = inflate(&zs, Z_NO_FLUSH);
+    }
+    bool ok = res == Z_STREAM_END && zs.avail_out == 0 && out_left == 0;
+    inflateEnd(&zs);
+    return ok;
+}
+#endif
+
+#ifdef DWARFSQL_HAS_ZSTD
+bool inflate_zstd(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) {
+    size_t n = ZSTD_decompress(out, out_size, in, in_size);
+    return !ZSTD_isError(n) && n == out_size;
+}
+#endif
+
+// Inflated sections outlive the ElfObject that produced them while any
+// other object on the same file (path, size and mtime) still uses them
+struct InflatedKey {
+    std::string path;
+    uint64_t file_size;
+    int64_t mtime;
+    uint64_t offset;
+
+    bool operator<(const InflatedKey& other) const {
+        return std::tie(path, file_size, mtime, offset) <
+               std::tie(other.path, other.file_size, other.mtime, other.offset);
+    }
+};
+
+struct InflatedCache {
+    std::mutex mutex;
+    std::map<InflatedKey, std::weak_ptr<const std::vector<uint8_t>>> entries;
+};
+
+InflatedCache& inflated_cache() {
+    static InflatedCache cache;
+    return cache;
+}
+
+} // anonymous namespace
+
+ElfObject::ElfObject() {
+#ifdef DWARFSQL_HAS_LIBDWARF
+    access_.object = this;
+    access_.methods = &methods_;
+#endif
+}
+
+bool ElfObject::open(const std::string& path) {
+    sections_.clear();
+    names_.clear();
+    if (!file_.map(path)) return false;
+
+    std::error_code ec;
+    path_ = std::filesystem::absolute(path, ec).string();
+    if (ec) path_ = path;
+    file_size_ = file_.size();
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    mtime_ = ec ? 0 : static_cast<int64_t>(mtime.time_since_epoch().count());
+
+    const uint8_t* data = file_.data();
+    size_t size = file_.size();
+    if (size < 52 || std::memcmp(data, "\x7f" "ELF", 4) != 0) return false;
+    is64_ = data[4] == 2;   // EI_CLASS == ELFCLASS64
+    little_ = data[5] == 1; // EI_DATA == ELFDATA2LSB
+    if (is64_ && size < 64) return false;
+
+    bool relocatable = read_uint(data + 0x10, 2, little_) == ET_REL;
+
+    uint64_t shoff = is64_ ? read_uint(data + 0x28, 8, little_) : read_uint(data + 0x20, 4, little_);
+    size_t shentsize = static_cast<size_t>(read_uint(data + (is64_ ? 0x3a : 0x2e), 2, little_));
+    uint64_t shnum = read_uint(data + (is64_ ? 0x3c : 0x30), 2, little_);
+    uint64_t shstrndx = read_uint(data + (is64_ ? 0x3e : 0x32), 2, little_);
+    if (shoff == 0 || shentsize < (is64_ ? 64u : 40u) || shoff > size || size - shoff < shentsize) {
+        return false;
+    }
+
+    // Section 0 holds the real count and string table index when they overflow 16 bits
+    const uint8_t* sh0 = data + shoff;
+    if (shnum == 0) {
+        shnum = is64_ ? read_uint(sh0 + 0x20, 8, little_) : read_uint(sh0 + 0x14, 4, little_);
+    }
+    if (shstrndx == SHN_XINDEX) {
+        shstrndx = read_uint(sh0 + (is64_ ? 0x28 : 0x18), 4, little_);
+    }
+    // libdwarf numbers sections with a Dwarf_Half
+    if (shnum > 0xffff || shnum > (size - shoff) / shentsize || shstrndx >= shnum) {
+        return false;
+    }
+
+    std::vector<Section> sections(static_cast<size_t>(shnum));
+    std::vector<uint64_t> name_offsets(sections.size());
+    for (size_t i = 0; i < sections.size(); ++i) {
+        const uint8_t* sh = data + shoff + i * shentsize;
+        Section& s = sections[i];
+        name_offsets[i] = read_uint(sh, 4, little_);
+        s.type = read_uint(sh + 4, 4, little_);
+        if (is64_) {
+            s.flags = read_uint(sh + 0x08, 8, little_);
+            s.addr = read_uint(sh + 0x10, 8, little_);
+            s.offset = read_uint(sh + 0x18, 8, little_);
+            s.size = read_uint(sh + 0x20, 8, little_);
+            s.link = read_uint(sh + 0x28, 4, little_);
+            s.info = read_uint(sh + 0x2c, 4, little_);
+            s.entsize = read_uint(sh + 0x38, 8, little_);
+        } else {
+            s.flags = read_uint(sh + 0x08, 4, little_);
+            s.addr = read_uint(sh + 0x0c, 4, little_);
+            s.offset = read_uint(sh + 0x10, 4, little_);
+            s.size = read_uint(sh + 0x14, 4, little_);
+            s.link = read_uint(sh + 0x18, 4, little_);
+            s.info = read_uint(sh + 0x1c, 4, little_);
+            s.entsize = read_uint(sh + 0x24, 4, little_);
+        }
+        if (s.type != SHT_NOBITS && (s.offset > size || s.size > size - s.offset)) {
+            return false;
+        }
+    }
+
+    const Section& strtab = sections[static_cast<size_t>(shstrndx)];
+    if (strtab.type == SHT_NOBITS) return false;
+    const char* names = reinterpret_cast<const char*>(data + strtab.offset);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        Section& s = sections[i];
+        if (name_offsets[i] >= strtab.size ||
+            !std::memchr(names + name_offsets[i], '\0', static_cast<size_t>(strtab.size - name_offsets[i]))) {
+            return false;
+        }
+        s.name = names + name_offsets[i];
+
+        if (is_debug_section(s.name) && !read_compression(s)) {
+            return false;
+        }
+    }
+
+    // Relocations against debug sections (in .o files) are applied by
+    // libdwarf's own reader; split DWARF .dwo/.dwp files have none
+    if (relocatable) {
+        for (const Section& s : sections) {
+            if ((s.type == SHT_REL || s.type == SHT_RELA) && s.info < sections.size() &&
+                is_debug_section(sections[static_cast<size_t>(s.info)].name)) {
+                return false;
+            }
+        }
+    }
+
+    sections_ = std::move(sections);
+    return true;
+}
+
+bool ElfObject::read_compression(Section& s) {
+    const uint8_t* p = file_.data() + s.offset;
+    uint64_t payload;
+    if (s.flags & SHF_COMPRESSED) {
+        // Elf32_Chdr / Elf64_Chdr: type, [reserved,] uncompressed size, alignment
+        uint64_t header = is64_ ? 24 : 12;
+        if (s.type == SHT_NOBITS || s.size < header) return false;
+        uint32_t type = static_cast<uint32_t>(read_uint(p, 4, little_));
+        payload = is64_ ? read_uint(p + 8, 8, little_) : read_uint(p + 4, 4, little_);
+        if (type == ELFCOMPRESS_ZLIB) {
+            s.compression = Compression::Zlib;
+        } else if (type == ELFCOMPRESS_ZSTD) {
+            s.compression = Compression::Zstd;
+        } else {
+            return false;
+        }
+        s.offset += header;
+        s.compressed_size = s.size - header;
+    } else if (starts_with(s.name, ".zdebug_")) {
+        // GNU format: "ZLIB", big-endian 64-bit uncompressed size, zlib stream
+        if (s.type == SHT_NOBITS || s.size < 12 || std::memcmp(p, "ZLIB", 4) != 0) return false;
+        payload = read_uint(p + 4, 8, false);
+        s.compression = Compression::Zlib;
+        s.offset += 12;
+        s.compressed_size = s.size - 12;
+        names_.push_back(std::string(".") + (s.name + 2));
+        s.name = names_.back().c_str();
+    } else {
+        return true;
+    }
+
+#ifndef DWARFSQL_HAS_ZLIB
+    if (s.compression == Compression::Zlib) return false;
+#endif
+#ifndef DWARFSQL_HAS_ZSTD
+    if (s.compression == Compression::Zstd) return false;
+#endif
+    if (payload > std::numeric_limits<size_t>::max()) return false;
+    s.size = payload;
+    return true;
+}
+
+void ElfObject::inflate_all() {
+    InflatedCache& cache = inflated_cache();
+
+    std::vector<Section*> pending;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        for (Section& s : sections_) {
+            if (s.compression == Compression::None) continue;
+            auto it = cache.entries.find({path_, file_size_, mtime_, s.offset});
+            if (it != cache.entries.end()) {
+                s.inflated = it->second.lock();
+            }
+            if (!s.inflated) pending.push_back(&s);
+        }
+    }
+
+    // One section per task: a zlib or zstd stream can only be inflated from
+    // its start, so the parallelism is across sections (.debug_info,
+    // .debug_str, .debug_line, ... are inflated side by side)
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < pending.size()) {
+            Section& s = *pending[i];
+            // Unused when built with neither zlib nor zstd
+            [[maybe_unused]] const uint8_t* in = file_.data() + s.offset;
+            [[maybe_unused]] size_t in_size = static_cast<size_t>(s.compressed_size);
+            size_t out_size = static_cast<size_t>(s.size);
+            try {
+                auto out = std::make_shared<std::vector<uint8_t>>(out_size);
+                bool ok = false;
+#ifdef DWARFSQL_HAS_ZLIB
+                if (s.compression == Compression::Zlib) ok = inflate_zlib(in, in_size, out->data(), out_size);
+#endif
+#ifdef DWARFSQL_HAS_ZSTD
+                if (s.compression == Compression::Zstd) ok = inflate_zstd(in, in_size, out->data(), out_size);
+#endif
+                if (ok) s.inflated = std::move(out);
+            } catch (const std::bad_alloc&) {
+                // A corrupt size field; the section stays unloadable
+            }
+        }
+    };
+
+    size_t thread_count = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), pending.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < thread_count; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+        it = it->second.expired() ? cache.entries.erase(it) : std::next(it);
+    }
+    for (Section* s : pending) {
+        if (s->inflated) {
+            cache.entries[{path_, file_size_, mtime_, s->offset}] = s->inflated;
+        }
+    }
+}
+
+const uint8_t* ElfObject::data_of(const Section& s) {
+    if (s.compression != Compression::None) {
+        // Worker handles share this object; the first load inflates for all of them
+        std::call_once(inflate_once_, [this]() { inflate_all(); });
+        return s.inflated ? s.inflated->data() : nullptr;
+    }
+    return file_.data() + s.offset;
+}
+
+const uint8_t* ElfObject::section_data(const char* name, uint64_t& size) {
+    for (const auto& s : sections_) {
+        if (std::strcmp(s.name, name) != 0) continue;
+        if (s.type == SHT_NOBITS) return nullptr;
+        size = s.size;
+        return data_of(s);
+    }
+    return nullptr;
+}
+
+#ifdef DWARFSQL_HAS_LIBDWARF
+
+const Dwarf_Obj_Access_Methods ElfObject::methods_ = {
+    ElfObject::get_section_info,
+    ElfObject::get_byte_order,
+    ElfObject::get_length_size,
+    ElfObject::get_pointer_size,
+    ElfObject::get_section_count,
+    ElfObject::load_section,
+    nullptr,  // relocate_a_section: linked images need no relocation
+};
+
+int ElfObject::get_section_info(void* obj, Dwarf_Half index, Dwarf_Obj_Access_Section* out, int* error) {
+    auto* self = static_cast<ElfObject*>(obj);
+    if (index >= self->sections_.size()) {
+        *error = DW_DLE_SECTION_INDEX_BAD;
+        return DW_DLV_ERROR;
+    }
+    const Section& s = self->sections_[index];
+    out->addr = s.addr;
+    out->type = s.type;
+    out->size = s.size;
+    out->name = s.name;
+    out->link = s.link;
+    out->info = s.info;
+    out->entrysize = s.entsize;
+    return DW_DLV_OK;
+}
+
+Dwarf_Endianness ElfObject::get_byte_order(void* obj) {
+    return static_cast<ElfObject*>(obj)->little_ ? DW_OBJECT_LSB : DW_OBJECT_MSB;
+}
+
+Dwarf_Small ElfObject::get_length_size(void* obj) {
+    return static_cast<ElfObject*>(obj)->is64_ ? 8 : 4;
+}
+
+Dwarf_Small ElfObject::get_pointer_size(void* obj) {
+    return static_cast<ElfObject*>(obj)->is64_ ? 8 : 4;
+}
+
+Dwarf_Unsigned ElfObject::get_section_count(void* obj) {
+    return static_cast<ElfObject*>(obj)->sections_.size();
+}
+
+int ElfObject::load_section(void* obj, Dwarf_Half index, Dwarf_Small** data, int* error) {
+    auto* self = static_cast<ElfObject*>(obj);
+    if (index >= self->sections_.size()) {
+        *error = DW_DLE_SECTION_INDEX_BAD;
+        return DW_DLV_ERROR;
+    }
+    const Section& s = self->sections_[index];
+    if (s.type == SHT_NOBITS || s.size == 0) {
+        return DW_DLV_NO_ENTRY;
+    }
+    // libdwarf only reads sections it did not allocate itself
+    const uint8_t* bytes = self->data_of(s);
+    if (!bytes) {
+        *error = DW_DLE_ZLIB_UNCOMPRESS_ERROR;
+        return DW_DLV_ERROR;
+    }
+    *data = const_cast<Dwarf_Small*>(bytes);
+    return DW_DLV_OK;
+}
+
+#endif // DWARFSQL_HAS_LIBDWARF
+
+} // namespace dwarfsql
@@ -0,0 +1,115 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Address lookup structures
+ *
+ * Sorted indexes over the session's function, inlined-call and line rows,
+ * built once per session. Keys are the signed 64-bit values the tables
+ * expose to SQL, so lookups agree with SQLite's comparisons.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dwarfsql {
+
+/**
+ * Row positions returned by an index lookup
+ *
+ * Either a view into storage owned by the index (valid for the session),
+ * or a list owned by this object.
+ */
+struct RowPositions {
+    const uint32_t* view = nullptr;
+    size_t size = 0;
+    std::vector<uint32_t> owned;
+
+    const uint32_t* data() const { return owned.empty() ? view : owned.data(); }
+
+    void own(std::vector<uint32_t> rows) {
+        owned = std::move(rows);
+        view = nullptr;
+        size = owned.size();
+    }
+};
+
+/**
+ * Rows keyed by one value, sorted by key (ties keep row order)
+ */
+class SortedIndex {
+public:
+    void add(int64_t key, uint32_t row) { entries_.push_back({key, row}); }
+    void finish();
+
+    /**
+     * Rows with min <= key <= max, ordered by key
+     */
+    RowPositions find(int64_t min, int64_t max) const;
+
+    /**
+     * Last row (in key order) with key <= value
+     * @return false if every key is greater than value
+     */
+    bool last_at_or_before(int64_t value, uint32_t& row) const;
+
+    size_t size() const { return rows_.size(); }
+
+private:
+    struct Entry {
+        int64_t key;
+        uint32_t row;
+    };
+    std::vector<Entry> entries_;  // Only until finish()
+    std::vector<int64_t> keys_;
+    std::vector<uint32_t> rows_;
+};
+
+/**
+ * [low, high) intervals sorted by low, with a running maximum of high so a
+ * stabbing query only walks back over intervals that can still reach it
+ */
+class IntervalIndex {
+public:
+    void add(int64_t low, int64_t high, uint32_t row) { entries_.push_back({low, high, row}); }
+    void finish();
+
+    /**
+     * Rows with low <= low_max and high >= high_min, ordered by low
+     */
+    RowPositions find(int64_t low_max, int64_t high_min) const;
+
+    /**
+     * Rows with low <= point < high, ordered by low
+     */
+    RowPositions covering(int64_t point) const;
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        int64_t low;
+        int64_t high;
+        uint32_t row;
+    };
+    std::vector<Entry> entries_;
+    std::vector<int64_t> max_high_;  // max_high_[i] = max(entries_[0..i].high)
+};
+
+/**
+ * Parse an address as callers write it: "0x..." (or "0X...") hex, otherwise
+ * decimal. Unlike strtoull(), takes no blanks or sign, and a leading 0 is
+ * not octal.
+ * @return false unless all of text is one such number that fits in 64 bits
+ */
+bool parse_address(std::string_view text, uint64_t& out);
+
+} // namespace dwarfsql
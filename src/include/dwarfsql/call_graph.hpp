@@ -0,0 +1,78 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Call graph structures
+ *
+ * Adjacency lists over the session's call-site and inlined-call rows, built
+ * once per session so recursive queries walk arrays instead of joining the
+ * calls table with itself once per level.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "address_index.hpp"
+
+namespace dwarfsql {
+
+/**
+ * Compressed adjacency lists: the rows attached to node n are
+ * rows_[starts_[n] .. starts_[n + 1]), in the order they were added
+ */
+class Adjacency {
+public:
+    void add(uint32_t node, uint32_t row) { entries_.push_back({node, row}); }
+    void finish(size_t nodes);
+
+    /**
+     * Rows attached to node (a view valid for the session)
+     */
+    RowPositions of(uint32_t node) const;
+
+    size_t size() const { return rows_.size(); }
+
+private:
+    struct Entry {
+        uint32_t node;
+        uint32_t row;
+    };
+    std::vector<Entry> entries_;  // Only until finish()
+    std::vector<uint32_t> starts_;
+    std::vector<uint32_t> rows_;
+};
+
+/**
+ * Call graph over DwarfSession::index()
+ *
+ * A node is one function, however many DIEs describe it: a definition,
+ * the declaration its DW_AT_specification names, the abstract instance of
+ * an inlined function and the out-of-line copies of it. Functions with
+ * external linkage are one node across units, keyed by linkage name.
+ */
+struct CallGraph {
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    std::unordered_map<uint64_t, uint32_t> nodes;  // Subprogram DIE offset -> node
+    std::vector<uint32_t> callers;                 // DwarfIndex::calls row -> caller node
+    std::vector<uint32_t> callees;                 // DwarfIndex::calls row -> callee node, NO_NODE if indirect
+    Adjacency calls_from;                          // Node -> calls rows it makes
+    Adjacency calls_to;                            // Node -> calls rows that target it
+
+    std::unordered_map<uint64_t, uint32_t> inlined;  // Inlined subroutine DIE offset -> inlined_calls row
+    std::vector<uint32_t> inline_parents;            // inlined_calls row -> enclosing row, UINT32_MAX at the top
+
+    uint32_t node_of(uint64_t offset) const {
+        auto it = nodes.find(offset);
+        return it == nodes.end() ? NO_NODE : it->second;
+    }
+};
+
+} // namespace dwarfsql
@@ -0,0 +1,101 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Pool of read-only databases over one DWARF session
+ *
+ * Every database registers the same table definitions, so all of them share
+ * the session's row caches; each one is used by a single thread at a time.
+ * Servers lease a database per request, so independent queries run in
+ * parallel instead of queuing behind a slow scan on one connection. Each
+ * database keeps its own StatementCache, since SQLite statements belong to
+ * the connection that compiled them.
+ */
+
+#include <xsql/database.hpp>
+#include "dwarf_vtable.hpp"
+#include "statement_cache.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dwarfsql {
+
+class ConnectionPool {
+public:
+    /**
+     * @param defs Table definitions from build_tables()
+     * @param size Maximum number of databases (<= 0 = one per hardware thread)
+     */
+    ConnectionPool(std::vector<TableDef> defs, int size);
+
+    // Non-copyable
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * Exclusive use of one database until destroyed
+     */
+    class Lease {
+        struct Connection {
+            std::unique_ptr<xsql::Database> db;
+            std::unique_ptr<StatementCache> statements;  // Declared after db: finalized before it closes
+        };
+
+    public:
+        Lease(Lease&& other) noexcept : pool_(other.pool_), conn_(other.conn_) { other.conn_ = nullptr; }
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() { if (conn_) pool_->release(conn_); }
+
+        xsql::Database& db() const { return *conn_->db; }
+        StatementCache& statements() const { return *conn_->statements; }
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, Connection* conn) : pool_(pool), conn_(conn) {}
+
+        ConnectionPool* pool_;
+        Connection* conn_;
+    };
+
+    /**
+     * Lease an idle database, opening a new one while under the size limit
+     * and otherwise waiting for one to be released
+     */
+    Lease acquire();
+
+    /**
+     * Run fn while no database is leased: waits for every lease to be
+     * released and holds off acquire() until fn returns
+     */
+    void exclusive(const std::function<void()>& fn);
+
+    /**
+     * Maximum number of databases
+     */
+    size_t size() const { return size_; }
+
+private:
+    using Connection = Lease::Connection;
+    void release(Connection* conn);
+
+    std::vector<TableDef> defs_;
+    size_t size_;
+
+    std::mutex mutex_;
+    std::condition_variable released_;
+    std::vector<std::unique_ptr<Connection>> databases_;
+    std::vector<Connection*> idle_;
+    bool exclusive_ = false;
+};
+
+} // namespace dwarfsql
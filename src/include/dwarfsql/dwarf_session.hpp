@@ -19,6 +19,14 @@
 #include <memory>
 #include <vector>
 #include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include "address_index.hpp"
+#include "call_graph.hpp"
+#include "name_index.hpp"
+#include "elf_object.hpp"
+#include "string_pool.hpp"
 
 #ifdef DWARFSQL_HAS_LIBDWARF
 #include <libdwarf/libdwarf.h>
@@ -32,18 +40,27 @@ namespace dwarfsql {
  */
 struct DieInfo {
     uint64_t offset = 0;
+    uint64_t cu_offset = 0;
+    uint64_t func_offset = 0;  // Enclosing subprogram, 0 outside functions
     int tag = 0;
-    std::string name;
-    std::string linkage_name;
-    uint64_t low_pc = 0;
+    InternedString name;
+    InternedString linkage_name;
+    InternedString type;  // Rendered DW_AT_type (return type for functions)
+    uint64_t low_pc = 0;  // With DW_AT_ranges, the span of the ranges (see DwarfIndex::address_ranges)
     uint64_t high_pc = 0;
     int64_t byte_size = -1;
     int decl_file = -1;
     int decl_line = -1;
     bool is_external = false;
     bool is_declaration = false;
+    bool is_inline = false;
+    uint64_t origin_offset = 0;  // Subprograms: DW_AT_specification or DW_AT_abstract_origin
 };
 
+// Row strings point into the session's StringPool, so a table of millions
+// of rows is a few large allocations and frees without visiting its rows
+static_assert(std::is_trivially_destructible<DieInfo>::value, "DieInfo is meant to own no heap memory");
+
 /**
  * Compilation unit information
  */
@@ -55,42 +72,60 @@ struct CompilationUnit {
     int language = 0;
     uint64_t low_pc = 0;
     uint64_t high_pc = 0;
+    uint64_t content_hash = 0;  // Of the unit's own section bytes; 0 if unknown or it reads other units
 };
 
 /**
  * Line number information
+ *
+ * Line tables run to 100M+ rows, so a row is 20 bytes: the source file is
+ * a number in DwarfSession::line_files(), the address is split in two
+ * words to keep 4-byte alignment, and the flags share a word with the column.
  */
 struct LineInfo {
-    uint64_t address = 0;
-    std::string file;
+    LineInfo() : column(0), is_stmt(0), basic_block(0), end_sequence(0) {}
+
+    uint64_t address() const { return static_cast<uint64_t>(address_hi) << 32 | address_lo; }
+    void set_address(uint64_t address) {
+        address_lo = static_cast<uint32_t>(address);
+        address_hi = static_cast<uint32_t>(address >> 32);
+    }
+
+    uint32_t address_lo = 0;
+    uint32_t address_hi = 0;
+    uint32_t file = 0;
     int line = 0;
-    int column = 0;
-    bool is_stmt = false;
-    bool basic_block = false;
-    bool end_sequence = false;
+    uint32_t column : 29;  // Saturates; DWARF columns are far smaller
+    uint32_t is_stmt : 1;
+    uint32_t basic_block : 1;
+    uint32_t end_sequence : 1;
 };
 
+static_assert(sizeof(LineInfo) == 20, "LineInfo is meant to stay packed");
+
 /**
  * Function parameter information
+ *
+ * DW_AT_location is not stored; see DwarfSession::get_location()
  */
 struct ParameterInfo {
     uint64_t offset = 0;
     uint64_t func_offset = 0;
-    std::string name;
-    std::string type;
+    InternedString name;
+    InternedString type;
     int index = 0;
-    std::string location;
 };
 
 /**
  * Local variable information
+ *
+ * DW_AT_location is not stored; see DwarfSession::get_location()
  */
 struct LocalVarInfo {
     uint64_t offset = 0;
     uint64_t func_offset = 0;
-    std::string name;
-    std::string type;
-    std::string location;
+    InternedString name;
+    InternedString type;
     int decl_line = 0;
     uint64_t scope_low_pc = 0;
     uint64_t scope_high_pc = 0;
@@ -101,9 +136,9 @@ struct LocalVarInfo {
  */
 struct BaseClassInfo {
     uint64_t derived_offset = 0;
-    std::string derived_name;
+    InternedString derived_name;
     uint64_t base_offset = 0;
-    std::string base_name;
+    InternedString base_name;
     int64_t data_member_offset = 0;
     bool is_virtual = false;
     int access = 0;  // 1=public, 2=protected, 3=private
@@ -114,9 +149,9 @@ struct BaseClassInfo {
  */
 struct CallInfo {
     uint64_t caller_offset = 0;
-    std::string caller_name;
+    InternedString caller_name;
     uint64_t callee_offset = 0;
-    std::string callee_name;
+    InternedString callee_name;
     uint64_t call_pc = 0;
     int call_line = 0;
     bool is_tail_call = false;
@@ -128,9 +163,10 @@ struct CallInfo {
 struct InlinedCallInfo {
     uint64_t offset = 0;
     uint64_t abstract_origin = 0;
-    std::string name;
+    InternedString name;
     uint64_t caller_offset = 0;
-    uint64_t low_pc = 0;
+    uint64_t parent_offset = 0;  // Enclosing inlined call, 0 if inlined straight into the caller
+    uint64_t low_pc = 0;         // With DW_AT_ranges, the span of the ranges
     uint64_t high_pc = 0;
     int call_line = 0;
     int call_column = 0;
@@ -141,11 +177,122 @@ struct InlinedCallInfo {
  */
 struct NamespaceInfo {
     uint64_t offset = 0;
-    std::string name;
+    InternedString name;
     uint64_t parent_offset = 0;  // 0 for global namespace
     bool is_anonymous = false;
 };
 
+/**
+ * Rendered type names keyed by type DIE offset
+ *
+ * Filled lazily during extraction. Each DW_AT_type chain (`const char*`,
+ * `std::string&`, ...) is followed through dwarf_offdie_b once per session;
+ * every modifier hop on the chain is cached along with the full name.
+ */
+struct TypeNameCache {
+    struct Entry {
+        std::string text;
+        size_t prefix_len = 0;  // Length of leading "const "/"volatile " qualifiers
+        bool cross_unit = false;  // Some hop of the chain is in another unit
+    };
+    std::unordered_map<uint64_t, Entry> entries;
+};
+
+/**
+ * One [low, high) entry of a DW_AT_ranges list, base address applied
+ */
+struct AddressRange {
+    uint64_t low = 0;
+    uint64_t high = 0;
+};
+
+/**
+ * Everything extracted from .debug_info by one walk over the DIE tree
+ *
+ * Built once per session by DwarfSession::index(); every table reads from
+ * here, so the tree is walked once no matter how many tables a query joins.
+ * Line tables come from .debug_line and stay with get_line_info().
+ */
+struct DwarfIndex {
+    std::vector<CompilationUnit> compilation_units;
+    std::vector<DieInfo> functions;
+    std::vector<DieInfo> variables;
+    std::vector<DieInfo> types;
+    std::vector<DieInfo> structs;
+    std::vector<DieInfo> enums;
+    std::vector<ParameterInfo> parameters;
+    std::vector<LocalVarInfo> local_variables;
+    std::vector<BaseClassInfo> base_classes;
+    std::vector<CallInfo> calls;
+    std::vector<InlinedCallInfo> inlined_calls;
+    std::vector<NamespaceInfo> namespaces;
+
+    // Children of structs/unions and enums, recorded while the walk passes
+    // them; keyed by the parent DIE offset, rows in DIE order
+    std::unordered_map<uint64_t, std::vector<DieInfo>> struct_members;
+    std::unordered_map<uint64_t, std::vector<DieInfo>> enum_values;
+
+    // Entries of the functions and inlined calls covering their code with
+    // DW_AT_ranges rather than low_pc/high_pc, keyed by DIE offset
+    std::unordered_map<uint64_t, std::vector<AddressRange>> address_ranges;
+
+    // Of the sections every unit reads (strings, abbreviations); with
+    // CompilationUnit::content_hash, decides what reload() may keep
+    uint64_t shared_sections_hash = 0;
+};
+
+/**
+ * Outcome of DwarfSession::reload()
+ */
+struct ReloadResult {
+    bool changed = false;     // The binary (or its package) differed from the one open
+    size_t units_reused = 0;  // Units whose index rows carried over unchanged
+    size_t units_indexed = 0; // Units walked again
+};
+
+/**
+ * One frame of an address symbolization, innermost first
+ *
+ * Frames are the inlined subroutines containing the address followed by
+ * the concrete function. Depth 0 takes file/line/column from the line
+ * table; each outer frame takes line/column from the call site of the
+ * frame inside it.
+ */
+struct SymbolFrame {
+    int depth = 0;
+    bool is_inline = false;
+    uint64_t offset = 0;  // DIE of the function or inlined subroutine, 0 for a line-only frame
+    InternedString name;
+    uint64_t low_pc = 0;
+    uint64_t high_pc = 0;
+    InternedString file;  // Empty for outer frames (DW_AT_call_file is not decoded)
+    int line = 0;
+    int column = 0;
+
+    // "inline", "function", or "line" for an address only the line table covers
+    const char* kind() const { return is_inline ? "inline" : (offset != 0 ? "function" : "line"); }
+};
+
+/**
+ * Call site reached by a call graph walk (callers_of / callees_of)
+ */
+struct CallEdge {
+    int depth = 0;                  // 1 for the calls of (or to) the starting function
+    const CallInfo* call = nullptr; // Row of DwarfIndex::calls
+};
+
+/**
+ * Inlined call enclosing an address (inline_stack)
+ */
+struct InlineFrame {
+    int depth = 0;                        // 0 for the innermost
+    const InlinedCallInfo* call = nullptr; // Row of DwarfIndex::inlined_calls
+};
+
+struct IndexDetails;
+struct LineTableRange;
+struct IndexFileKey;
+
 /**
  * DWARF session - manages access to debug info in a binary
  */
@@ -174,6 +321,25 @@ public:
      */
     void close();
 
+    /**
+     * Reopen the binary if it changed on disk since open()
+     * @param result Optional; receives what changed and how much was re-indexed
+     * @return false if the new file cannot be opened; the session is then left as it was
+     *
+     * When an index exists, units whose bytes are unchanged keep their rows
+     * and only the others are walked again; a change to the shared string
+     * or abbreviation sections re-indexes everything. Line tables, locations
+     * and address indexes are dropped and rebuilt on next use. Not
+     * thread-safe: no other thread may use the session meanwhile.
+     */
+    bool reload(ReloadResult* result = nullptr);
+
+    /**
+     * Check the binary on disk is still the build open() (or the last
+     * reload()) read
+     */
+    bool is_current() const;
+
     /**
      * Check if session is open
      */
@@ -184,6 +350,66 @@ public:
      */
     const std::string& path() const { return path_; }
 
+    /**
+     * Set the number of extraction threads used to build the index
+     * @param jobs Worker count (1 = single-threaded, <= 0 = one per hardware thread)
+     *
+     * CUs are split across workers, each with its own libdwarf handle.
+     * Takes effect on the next index build.
+     */
+    void set_jobs(int jobs);
+
+    /**
+     * Get the number of extraction threads
+     */
+    int jobs() const { return jobs_; }
+
+    /**
+     * Get the DIE index, walking .debug_info on first use
+     * Thread-safe; the returned index lives until close().
+     * @throws QueryCancelled if the walk was stopped by the query budget in
+     *         effect (query_budget.hpp); the next call goes on from the
+     *         units it finished
+     */
+    const DwarfIndex& index() const;
+
+    /**
+     * True once index() has been built or loaded from an index file
+     */
+    bool has_index() const;
+
+    /**
+     * Replace the DWARF walk with the contents of an index file
+     * @param index_path File written by save_index() for this binary
+     * @return false if the file is missing, stale or corrupt (see last_error())
+     *
+     * On success every table, including struct_members, enum_values and
+     * line_info, is served from the file without touching .debug_info.
+     */
+    bool load_index(const std::string& index_path);
+
+    /**
+     * Write the index, struct members, enum values and line tables to a file
+     * @return false on I/O failure (see last_error())
+     */
+    bool save_index(const std::string& index_path);
+
+    /**
+     * Offsets of every unit DIE, listed once per session
+     *
+     * .debug_info units in order, then .debug_types; a type unit repeating
+     * an earlier signature is left out, as the index walk skips it.
+     */
+    const std::vector<uint64_t>& get_unit_offsets() const;
+
+    /**
+     * Decode one compilation unit into a standalone index
+     * @param cu_offset CU DIE offset, e.g. from get_unit_offsets()
+     *
+     * Does not build or touch index(); rows match what the full walk records for the CU.
+     */
+    DwarfIndex index_unit(uint64_t cu_offset) const;
+
     /**
      * Enumerate all compilation units
      */
@@ -220,6 +446,14 @@ public:
      */
     std::vector<DieInfo> get_struct_members(uint64_t struct_offset) const;
 
+    /**
+     * Stream members of a struct/class/union to sink as they are decoded
+     * @param struct_offset DIE offset of the struct
+     * @param sink Receives each member; runs under the libdwarf lock, so it
+     *             must not call back into the session
+     */
+    void get_struct_members(uint64_t struct_offset, const std::function<void(DieInfo&&)>& sink) const;
+
     /**
      * Enumerate enums
      * @param cu_filter Optional CU offset filter (-1 for all)
@@ -232,6 +466,13 @@ public:
      */
     std::vector<DieInfo> get_enum_values(uint64_t enum_offset) const;
 
+    /**
+     * Stream enum values to sink as they are decoded
+     * @param enum_offset DIE offset of the enum
+     * @param sink Receives each value; same restrictions as get_struct_members()
+     */
+    void get_enum_values(uint64_t enum_offset, const std::function<void(DieInfo&&)>& sink) const;
+
     /**
      * Get line number information
      * @param cu_filter Optional CU offset filter (-1 for all)
@@ -250,6 +491,26 @@ public:
      */
     std::vector<LocalVarInfo> get_local_variables(int64_t func_filter = -1) const;
 
+    /**
+     * Get the rows of one kind whose name matches key, decoding only the
+     * units the binary's .debug_names or .gdb_index lists for it
+     * @return false if there is no such table covering kind (or the index
+     *         is loaded, and scanning it is cheaper); rows is left empty
+     *
+     * Accelerator tables list defining DIEs only, so declarations and
+     * local variables in other units are not found this way.
+     */
+    bool find_named(NameKind kind, const NameKey& key, std::vector<DieInfo>& rows) const;
+
+    /**
+     * Get the rendered DW_AT_location of a parameter or local variable
+     * @param die_offset Offset of the DIE (ParameterInfo/LocalVarInfo::offset)
+     *
+     * The index walk skips location expressions; each one is decoded on
+     * first request and memoized, or read from the loaded index file.
+     */
+    InternedString get_location(uint64_t die_offset) const;
+
     /**
      * Get base class relationships
      */
@@ -270,6 +531,72 @@ public:
      */
     std::vector<NamespaceInfo> get_namespaces() const;
 
+    /**
+     * Get the line table of every CU, collected on first use
+     * Thread-safe; the returned rows live until close().
+     * @throws QueryCancelled as index() does
+     */
+    const std::vector<LineInfo>& line_table() const;
+
+    /**
+     * Source files of the line rows, by LineInfo::file
+     * Lookups need no lock; numbers stay valid until close().
+     */
+    const StringTable& line_files() const { return line_files_; }
+
+    /**
+     * Address indexes, each built on first use from only what it covers
+     * Thread-safe; the returned indexes live until close().
+     *
+     * function_bounds() and inline_bounds() key index().functions and
+     * index().inlined_calls by their [low_pc, high_pc) columns.
+     * function_ranges() and inline_ranges() key the same rows by the code
+     * they cover, with one interval per DW_AT_ranges entry, for finding
+     * what contains an address. line_ranges() keys line_table() by address.
+     */
+    const IntervalIndex& function_bounds() const;
+    const IntervalIndex& inline_bounds() const;
+    const IntervalIndex& function_ranges() const;
+    const IntervalIndex& inline_ranges() const;
+    const SortedIndex& line_ranges() const;
+
+    /**
+     * Get the call graph over index(), built on first use
+     * Thread-safe; the returned graph lives until close().
+     */
+    const CallGraph& call_graph() const;
+
+    /**
+     * Walk call sites outward from a function
+     * @param func_offset Any DIE of the function: definition, declaration or abstract instance
+     * @param depth Levels to follow (<= 0 = until no new function is reached)
+     * @return Call sites breadth first; each function is expanded once, so cycles end
+     *
+     * callees_of() follows the calls a function makes, callers_of() the
+     * calls made to it. Indirect call sites have no callee and are only
+     * listed by callees_of().
+     */
+    std::vector<CallEdge> callees_of(uint64_t func_offset, int depth) const;
+    std::vector<CallEdge> callers_of(uint64_t func_offset, int depth) const;
+
+    /**
+     * Inlined calls enclosing an address, innermost first
+     * Follows InlinedCallInfo::parent_offset out from the innermost one.
+     */
+    std::vector<InlineFrame> inline_stack(uint64_t pc) const;
+
+    /**
+     * Map an address to its function, inline chain and source line
+     * @return Frames innermost first; empty if nothing covers pc
+     */
+    std::vector<SymbolFrame> symbolize(uint64_t pc) const;
+
+    /**
+     * Symbolize a batch of addresses against one snapshot of the indexes
+     * @return One frame list per address, in input order
+     */
+    std::vector<std::vector<SymbolFrame>> symbolize(const std::vector<uint64_t>& pcs) const;
+
     /**
      * Get error message from last failed operation
      */
@@ -278,15 +605,96 @@ public:
 private:
 #ifdef DWARFSQL_HAS_LIBDWARF
     Dwarf_Debug dbg_ = nullptr;
+    Dwarf_Debug split_dbg_ = nullptr;
+    Dwarf_Debug dies_ = nullptr;
 #else
     void* dbg_ = nullptr;
+    void* split_dbg_ = nullptr;
+    void* dies_ = nullptr;
 #endif
-    int fd_ = -1;
+    int fd_ = -1;                         // Set when libdwarf reads the file itself
+    std::unique_ptr<ElfObject> object_;   // Set when dbg_ reads sections from a mapping
+
+    // Split DWARF: <path>.dwp, tied to dbg_ so its address indexes resolve.
+    // DIEs are read through dies_ (split_dbg_ when set, else dbg_); line
+    // tables stay with the skeleton units in dbg_, whose offsets are
+    // reported as the matching split unit's
+    int split_fd_ = -1;
+    std::unique_ptr<ElfObject> split_object_;
+    std::string split_path_;
+    std::unordered_map<uint64_t, uint64_t> split_units_;  // Skeleton CU offset -> split CU offset
+    int jobs_ = 1;
     bool is_open_ = false;
     std::string path_;
     std::string last_error_;
+    std::unique_ptr<IndexFileKey> key_;  // Of the files open() saw, for reload()
+
+    // What a build cut short by a cancelled query had finished, for the
+    // next build to go on from (see query_budget.hpp)
+    struct PartialIndex {
+        std::vector<DwarfIndex> units;  // One per get_unit_offsets() entry
+        std::vector<char> done;
+    };
+    struct PartialLines {
+        std::vector<LineInfo> rows;  // Of the first `units` units
+        size_t units = 0;
+    };
+
+    mutable std::mutex index_mutex_;
+    mutable std::unique_ptr<DwarfIndex> index_;
+    mutable std::unique_ptr<PartialIndex> partial_index_;
+
+    // Guards dbg_ and split_dbg_ (libdwarf handles are not thread-safe),
+    // type_names_, strings_, locations_ and units_, which the index build
+    // and on-demand lookups share
+    mutable std::mutex type_names_mutex_;
+    mutable TypeNameCache type_names_;
+    mutable std::unordered_map<uint64_t, InternedString> locations_;  // get_location() results
+    mutable std::unique_ptr<std::vector<uint64_t>> units_;             // get_unit_offsets()
+
+    // Backs every InternedString the session hands out; lives until close()
+    mutable StringPool strings_;
+    mutable StringTable line_files_;  // Also guarded by type_names_mutex_
+
+    // Set by load_index(); answers the line and location lookups in place of libdwarf
+    std::unique_ptr<IndexDetails> details_;
+
+    mutable std::mutex lines_mutex_;
+    mutable std::unique_ptr<std::vector<LineInfo>> lines_;
+    mutable std::unique_ptr<PartialLines> partial_lines_;
+
+    // One lock each, so building one index never waits on another's source
+    mutable std::mutex function_bounds_mutex_;
+    mutable std::unique_ptr<IntervalIndex> function_bounds_;
+    mutable std::mutex inline_bounds_mutex_;
+    mutable std::unique_ptr<IntervalIndex> inline_bounds_;
+    mutable std::mutex function_ranges_mutex_;
+    mutable std::unique_ptr<IntervalIndex> function_ranges_;
+    mutable std::mutex inline_ranges_mutex_;
+    mutable std::unique_ptr<IntervalIndex> inline_ranges_;
+    mutable std::mutex line_ranges_mutex_;
+    mutable std::unique_ptr<SortedIndex> line_ranges_;
+
+    mutable std::mutex graph_mutex_;
+    mutable std::unique_ptr<CallGraph> graph_;
+
+    // Views into object_'s sections, so reset before it
+    mutable std::mutex names_mutex_;
+    mutable std::unique_ptr<NameIndex> names_;
 
     // Helper methods
+    void open_split_package();
+    void close_split_package();
+    bool read_key(IndexFileKey& key) const;
+    void build_index(DwarfIndex& out) const;
+    void index_units(const std::vector<uint64_t>& cu_offsets, std::vector<DwarfIndex>& parts,
+                     std::vector<char>& done) const;
+    void update_index(DwarfIndex&& old, DwarfIndex& out, ReloadResult& result) const;
+    ElfObject* dies_object() const { return split_dbg_ ? split_object_.get() : object_.get(); }
+    DwarfIndex index_subprogram(uint64_t func_offset) const;
+    const NameIndex& name_index() const;
+    std::vector<LineInfo> collect_line_info(int64_t cu_filter, std::vector<LineTableRange>* ranges,
+                                            PartialLines* resume = nullptr) const;
     void iterate_dies(int tag_filter, std::function<void(const DieInfo&)> callback) const;
 };
 
@@ -25,13 +25,53 @@
  * - calls
  * - inlined_calls
  * - namespaces
+ * - symbolize(pc) (table-valued function)
+ * - callees_of(func_id, max_depth), callers_of(func_id, max_depth) (table-valued functions)
+ * - inline_stack(pc) (table-valued function)
  */
 
 #include <xsql/database.hpp>
 #include "dwarf_session.hpp"
+#include "dwarf_vtable.hpp"
+#include "session_set.hpp"
+
+#include <vector>
 
 namespace dwarfsql {
 
+/**
+ * Build the definitions of all DWARF virtual tables
+ *
+ * Copies of a definition share its row cache, so registering the same
+ * definitions with several databases lets them share every cache.
+ * @param session DWARF session providing data; must outlive the tables
+ */
+std::vector<TableDef> build_tables(DwarfSession& session);
+
+/**
+ * Build the definitions of all DWARF virtual tables over several modules
+ *
+ * With more than one module every table gains a trailing `module` column
+ * (see module_table()); a set of one builds the plain tables of its session.
+ * @param sessions Must outlive the tables
+ * @param module_tables If set, receives each module's own definitions, which
+ *                      the returned ones read; reset_tables() on one of them
+ *                      after that module alone is reloaded
+ */
+std::vector<TableDef> build_tables(SessionSet& sessions,
+                                   std::vector<std::vector<TableDef>>* module_tables = nullptr);
+
+/**
+ * Register table definitions from build_tables() with a database
+ */
+void register_tables(xsql::Database& db, const std::vector<TableDef>& defs);
+
+/**
+ * Drop every cache of the definitions, so they are rebuilt from the session
+ * on next use (after DwarfSession::reload())
+ */
+void reset_tables(const std::vector<TableDef>& defs);
+
 /**
  * Register all DWARF virtual tables with a database
  * @param db Database to register tables with
@@ -40,151 +80,28 @@ namespace dwarfsql {
 void register_tables(xsql::Database& db, DwarfSession& session);
 
 // ============================================================================
-// Row structures for each table
+// Row structures
 // ============================================================================
 
-struct CompilationUnitRow {
-    int64_t id;
-    std::string name;
-    std::string comp_dir;
-    std::string producer;
-    int language;
-    int64_t low_pc;
-    int64_t high_pc;
-};
-
-struct FunctionRow {
-    int64_t id;
-    int64_t cu_id;
-    std::string name;
-    std::string linkage_name;
-    int64_t low_pc;
-    int64_t high_pc;
-    std::string return_type;
-    bool is_external;
-    bool is_declaration;
-    bool is_inline;
-    int line;
-};
-
-struct VariableRow {
-    int64_t id;
-    int64_t cu_id;
-    int64_t func_id;  // -1 for global
-    std::string name;
-    std::string type;
-    std::string location;
-    bool is_parameter;
-    int line;
-};
-
-struct TypeRow {
-    int64_t id;
-    int64_t cu_id;
-    std::string name;
-    int tag;
-    int64_t byte_size;
-};
-
-struct StructRow {
-    int64_t id;
-    int64_t cu_id;
-    std::string name;
-    std::string kind;  // "struct", "class", "union"
-    int64_t byte_size;
-    bool is_declaration;
-};
+// Most tables read the session's own records (DieInfo, LineInfo, ...) in
+// place. Members and enumerators also name their parent DIE, so those two
+// tables keep rows of their own, built from the session's sinks.
 
 struct StructMemberRow {
     int64_t id;
     int64_t struct_id;
-    std::string name;
-    std::string type;
+    InternedString name;
+    InternedString type;
     int64_t offset;
     int bit_offset;
     int bit_size;
 };
 
-struct EnumRow {
-    int64_t id;
-    int64_t cu_id;
-    std::string name;
-    int64_t byte_size;
-};
-
 struct EnumValueRow {
     int64_t id;
     int64_t enum_id;
-    std::string name;
+    InternedString name;
     int64_t value;
 };
 
-struct LineInfoRow {
-    int64_t address;
-    std::string file;
-    int line;
-    int column;
-    bool is_stmt;
-    bool basic_block;
-    bool end_sequence;
-};
-
-struct ParameterRow {
-    int64_t id;
-    int64_t func_id;
-    std::string name;
-    std::string type;
-    int index;
-    std::string location;
-};
-
-struct LocalVariableRow {
-    int64_t id;
-    int64_t func_id;
-    std::string name;
-    std::string type;
-    std::string location;
-    int line;
-    int64_t scope_low_pc;
-    int64_t scope_high_pc;
-};
-
-struct BaseClassRow {
-    int64_t derived_id;
-    std::string derived_name;
-    int64_t base_id;
-    std::string base_name;
-    int64_t offset;
-    bool is_virtual;
-    std::string access;  // "public", "protected", "private"
-};
-
-struct CallRow {
-    int64_t caller_id;
-    std::string caller_name;
-    int64_t callee_id;
-    std::string callee_name;
-    int64_t call_pc;
-    int call_line;
-    bool is_tail_call;
-};
-
-struct InlinedCallRow {
-    int64_t id;
-    int64_t abstract_origin;
-    std::string name;
-    int64_t caller_id;
-    int64_t low_pc;
-    int64_t high_pc;
-    int call_line;
-    int call_column;
-};
-
-struct NamespaceRow {
-    int64_t id;
-    std::string name;
-    int64_t parent_id;
-    bool is_anonymous;
-};
-
 } // namespace dwarfsql
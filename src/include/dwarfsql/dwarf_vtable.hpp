@@ -0,0 +1,683 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Read-only SQLite virtual tables with equality pushdown
+ *
+ * Like xsql::CachedTableBuilder, a table built here caches its full row set
+ * on the first scan and shares it across queries; cache_source() lets the
+ * table read rows the session already holds rather than copying them. Columns
+ * registered with filter_eq() take part in xBestIndex: `WHERE col = ?`
+ * reaches xFilter with the key, and the table answers from
+ * - a hash index over the cache, when the cache exists (or is cheap, see
+ *   cache_when()), or
+ * - the per-key lookup callback, which decodes only the rows asked for.
+ *
+ * filter_name() does the same for `name = ?`, `name GLOB 'p*'` and
+ * `name LIKE 'p%'` on a text column, answered from a sorted index over the
+ * cache or from a lookup that can decline (e.g. no accelerator table).
+ *
+ * filter_range() pushes `low <= ? AND high >= ?` (and ORDER BY low) down
+ * to a sorted index over the cache, scan_units() lets `LIMIT n` scans
+ * decode unit by unit instead of building the cache, and arguments() turns
+ * the table into a table-valued function such as
+ * `SELECT * FROM symbolize(0x401000)`. module_table() stacks the same
+ * table of several binaries behind a `module` column. Each table counts
+ * its scans, cache builds and lookups in a TableStats (see stats.hpp).
+ */
+
+#include <xsql/database.hpp>
+#include <sqlite3.h>
+
+#include <dwarfsql/address_index.hpp>
+#include <dwarfsql/name_index.hpp>
+#include <dwarfsql/stats.hpp>
+#include <dwarfsql/string_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dwarfsql {
+
+/**
+ * Rows produced by one xFilter call
+ */
+class RowSet {
+public:
+    virtual ~RowSet() = default;
+    virtual size_t size() const = 0;
+    virtual void result(sqlite3_context* ctx, size_t row, int col) const = 0;
+
+    /**
+     * Make row available to result(); false once past the last row
+     * Sets that decode as the cursor advances produce more rows here.
+     */
+    virtual bool has_row(size_t row) { return row < size(); }
+};
+
+/**
+ * Type-erased table definition consumed by register_table()
+ */
+struct TableDef {
+    struct Column {
+        std::string name;
+        bool is_text = false;
+    };
+
+    struct RangeFilter {
+        int low_column;
+        int high_column;  // Same as low_column for a single sorted column
+    };
+
+    struct NameFilter {
+        int column;
+        int gate_column = -1;  // See TableBuilder::filter_name()
+        int64_t gate_value = 0;
+    };
+
+    std::string name;
+    std::vector<Column> columns;
+    std::vector<int> filter_columns;  // Columns with equality pushdown, in preference order
+    std::vector<RangeFilter> range_filters;
+    std::vector<NameFilter> name_filters;
+    std::vector<std::string> arguments;  // Hidden parameters of a table-valued function
+
+    // filter is -1 for a full scan, otherwise an index into filter_columns
+    std::function<std::unique_ptr<RowSet>(int filter, int64_t value)> open;
+
+    // Rows with low_column <= low_max and high_column >= high_min, ordered by low_column
+    std::function<std::unique_ptr<RowSet>(int range, int64_t low_max, int64_t high_min,
+                                          bool descending)> open_range;
+
+    // Rows whose name_filters[filter] column matches key; gated when the
+    // query also constrains the filter's gate column to its gate value
+    std::function<std::unique_ptr<RowSet>(int filter, const NameKey& key, bool gated)> open_name;
+
+    // Table-valued function call, one value per entry of arguments
+    std::function<std::unique_ptr<RowSet>(const std::vector<int64_t>& args)> call;
+
+    // Full scan for a query that may stop early (it has a LIMIT); may decode
+    // units as the cursor reaches them instead of building the cache
+    std::function<std::unique_ptr<RowSet>()> open_scan;
+
+    // Drop the row cache and filter indexes, e.g. after DwarfSession::reload();
+    // no cursor of the table may be open
+    std::function<void()> reset;
+
+    // Build the row cache (or what the table's first query would) ahead of
+    // any query; warm() holds once it is done, and until the next reset
+    std::function<void()> prewarm;
+    std::function<bool()> warm;
+
+    // Cache builds, lookups and the decoding they did; null for module_table()
+    // results, whose parts carry their own (as do prewarm and warm)
+    std::shared_ptr<TableStats> stats;
+
+    // Set by module_table(): rows are those of parts in order, and the last
+    // column names the entry of modules each row came from
+    std::vector<std::string> modules;
+    std::vector<TableDef> parts;
+};
+
+/**
+ * Union of one table over several modules, plus a TEXT `module` column
+ * @param modules Module names, one per part
+ * @param parts Definitions of the same table (same columns), one per module
+ *
+ * Plans are those of the parts, run on each in turn; `module = ?` opens only
+ * the matching part. Range plans satisfy ORDER BY only within one module.
+ */
+TableDef module_table(std::vector<std::string> modules, std::vector<TableDef> parts);
+
+/**
+ * Create the virtual table described by def in db
+ *
+ * Definitions with arguments become eponymous table-valued functions, so
+ * no CREATE VIRTUAL TABLE is issued for them.
+ * @return false if SQLite rejected the module or the CREATE VIRTUAL TABLE
+ */
+bool register_table(xsql::Database& db, TableDef def);
+
+/**
+ * Builder for a TableDef over rows of type Row
+ */
+template <typename Row>
+class TableBuilder {
+public:
+    using RowsFn = std::function<void(std::vector<Row>&)>;
+    using SourceFn = std::function<const std::vector<Row>&()>;
+    using LookupFn = std::function<void(int64_t, std::vector<Row>&)>;
+    using RangeFn = std::function<RowPositions(int64_t low_max, int64_t high_min)>;
+    using NameLookupFn = std::function<bool(const NameKey&, std::vector<Row>&)>;
+    using CallFn = std::function<void(const std::vector<int64_t>&, std::vector<Row>&)>;
+    using UnitsFn = std::function<const std::vector<uint64_t>&()>;
+    using UnitFn = std::function<void(uint64_t unit, std::vector<Row>&)>;
+
+    explicit TableBuilder(std::string name) : state_(std::make_shared<State>()) {
+        state_->name = std::move(name);
+    }
+
+    TableBuilder& column_int64(const std::string& name, std::function<int64_t(const Row&)> get) {
+        state_->columns.push_back({name, false, std::move(get), nullptr, nullptr});
+        return *this;
+    }
+
+    TableBuilder& column_int(const std::string& name, std::function<int(const Row&)> get) {
+        return column_int64(name, [get](const Row& r) { return static_cast<int64_t>(get(r)); });
+    }
+
+    TableBuilder& column_text(const std::string& name, std::function<std::string(const Row&)> get) {
+        state_->columns.push_back({name, true, nullptr, std::move(get), nullptr});
+        return *this;
+    }
+
+    TableBuilder& column_text(const std::string& name, std::function<InternedString(const Row&)> get) {
+        state_->columns.push_back({name, true, nullptr, nullptr, std::move(get)});
+        return *this;
+    }
+
+    /**
+     * Fill the full row set; called once, on the first scan
+     */
+    TableBuilder& cache_builder(RowsFn fn) {
+        state_->build_all = std::move(fn);
+        return *this;
+    }
+
+    /**
+     * Serve the cache from rows owned elsewhere instead of a private copy;
+     * called once, on the first scan, and the rows must outlive the table
+     */
+    TableBuilder& cache_source(SourceFn fn) {
+        state_->source = std::move(fn);
+        return *this;
+    }
+
+    /**
+     * Prefer building the cache over per-key lookups while pred() holds
+     * (e.g. once the underlying data is in memory anyway)
+     */
+    TableBuilder& cache_when(std::function<bool()> pred) {
+        state_->cache_when = std::move(pred);
+        return *this;
+    }
+
+    /**
+     * Let a full scan with a LIMIT decode one unit at a time while the cache
+     * does not exist and cache_when() does not hold, so it stops early
+     * @param units Unit keys (e.g. CU offsets), in cache row order
+     * @param decode Rows of one unit, as cache_builder would produce them
+     */
+    TableBuilder& scan_units(UnitsFn units, UnitFn decode) {
+        state_->units = std::move(units);
+        state_->decode_unit = std::move(decode);
+        return *this;
+    }
+
+    /**
+     * Push `column = value` down to the table
+     * @param column An int/int64 column declared earlier
+     * @param lookup Produces the matching rows without the full cache;
+     *               may be empty to always answer from the cache
+     */
+    TableBuilder& filter_eq(const std::string& column, LookupFn lookup = nullptr) {
+        int i = find_int_column(column);
+        if (i >= 0) {
+            state_->filters.push_back({i, std::move(lookup), {}, false});
+        }
+        return *this;
+    }
+
+    /**
+     * Push `column = ?`, `column GLOB 'p*'` and `column LIKE 'p%'` down to the table
+     * @param column A text column declared earlier
+     * @param lookup Produces the matching rows without the full cache, or
+     *               returns false to leave them to it; may be empty
+     * @param gate An int column declared earlier: lookup is only complete
+     *             for rows with gate = gate_value, so the query must say so
+     *             too; empty if lookup sees every row
+     */
+    TableBuilder& filter_name(const std::string& column, NameLookupFn lookup = nullptr,
+                              const std::string& gate = std::string(), int64_t gate_value = 0) {
+        int i = find_column(column, true);
+        if (i >= 0) {
+            NameFilter f;
+            f.column = i;
+            f.gate_column = gate.empty() ? -1 : find_int_column(gate);
+            f.gate_value = gate_value;
+            f.lookup = std::move(lookup);
+            state_->names.push_back(std::move(f));
+        }
+        return *this;
+    }
+
+    /**
+     * Push `low_column <= low_max AND high_column >= high_min` down to the
+     * table; either bound may be missing (then INT64_MAX / INT64_MIN)
+     * @param lookup Positions, in the row order produced by cache_builder,
+     *               of the matching rows sorted by low_column
+     */
+    TableBuilder& filter_range(const std::string& low_column, const std::string& high_column,
+                               RangeFn lookup) {
+        int low = find_int_column(low_column);
+        int high = find_int_column(high_column);
+        if (low >= 0 && high >= 0) {
+            state_->ranges.push_back({low, high, std::move(lookup)});
+        }
+        return *this;
+    }
+
+    /**
+     * Make the table a table-valued function taking integer arguments;
+     * every call runs fn and nothing is cached
+     */
+    TableBuilder& arguments(std::vector<std::string> names, CallFn fn) {
+        state_->arguments = std::move(names);
+        state_->call = std::move(fn);
+        return *this;
+    }
+
+    /**
+     * What prewarm does instead of building the cache, for a table whose
+     * rows come from something else (e.g. a table-valued function's index)
+     */
+    TableBuilder& warm_with(std::function<void()> fn) {
+        state_->warm_with = std::move(fn);
+        return *this;
+    }
+
+    TableDef build() {
+        TableDef def;
+        def.name = state_->name;
+        for (const auto& c : state_->columns) {
+            def.columns.push_back({c.name, c.is_text});
+        }
+        for (const auto& f : state_->filters) {
+            def.filter_columns.push_back(f.column);
+        }
+        for (const auto& r : state_->ranges) {
+            def.range_filters.push_back({r.low_column, r.high_column});
+        }
+        for (const auto& n : state_->names) {
+            def.name_filters.push_back({n.column, n.gate_column, n.gate_value});
+        }
+        def.arguments = state_->arguments;
+        auto state = state_;
+        def.open = [state](int filter, int64_t value) { return state->open(state, filter, value); };
+        def.open_range = [state](int range, int64_t low_max, int64_t high_min, bool descending) {
+            return state->open_range(state, range, low_max, high_min, descending);
+        };
+        def.open_name = [state](int filter, const NameKey& key, bool gated) {
+            return state->open_name(state, filter, key, gated);
+        };
+        def.open_scan = [state] { return state->open_scan(state); };
+        def.reset = [state] { state->reset(); };
+        def.prewarm = [state] { state->prewarm(); };
+        def.warm = [state] { return state->warm.load(); };
+        def.stats = std::shared_ptr<TableStats>(state_, &state_->stats);
+        if (state_->call) {
+            def.call = [state](const std::vector<int64_t>& args) {
+                state->stats.scans.fetch_add(1, std::memory_order_relaxed);
+                std::vector<Row> rows;
+                {
+                    DecodeScope scope(state->stats, false);
+                    state->call(args, rows);
+                }
+                state->stats.lookup_rows.fetch_add(rows.size(), std::memory_order_relaxed);
+                return std::unique_ptr<RowSet>(std::make_unique<OwnedRows>(state, std::move(rows)));
+            };
+        }
+        return def;
+    }
+
+private:
+    int find_column(const std::string& name, bool is_text) const {
+        for (size_t i = 0; i < state_->columns.size(); ++i) {
+            if (state_->columns[i].name == name && state_->columns[i].is_text == is_text) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    int find_int_column(const std::string& name) const { return find_column(name, false); }
+
+    struct Column {
+        std::string name;
+        bool is_text;
+        std::function<int64_t(const Row&)> get_int;
+        std::function<std::string(const Row&)> get_text;
+        std::function<InternedString(const Row&)> get_interned;
+
+        void result(sqlite3_context* ctx, const Row& row) const {
+            if (get_interned) {
+                InternedString s = get_interned(row);
+                sqlite3_result_text(ctx, s.data(), static_cast<int>(s.size()), SQLITE_TRANSIENT);
+            } else if (is_text) {
+                std::string s = get_text(row);
+                sqlite3_result_text(ctx, s.c_str(), static_cast<int>(s.size()), SQLITE_TRANSIENT);
+            } else {
+                sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(get_int(row)));
+            }
+        }
+
+        std::string text(const Row& row) const {
+            return get_interned ? get_interned(row).str() : get_text(row);
+        }
+
+        // text() without the copy for an interned column; scratch holds any other
+        std::string_view text_view(const Row& row, std::string& scratch) const {
+            if (get_interned) return get_interned(row).view();
+            scratch = get_text(row);
+            return scratch;
+        }
+    };
+
+    struct State;
+
+    // The shared cache, or selected positions within it
+    class CachedRows : public RowSet {
+    public:
+        explicit CachedRows(std::shared_ptr<State> state)
+            : state_(std::move(state)), all_(true) {}
+        CachedRows(std::shared_ptr<State> state, RowPositions positions, bool descending = false)
+            : state_(std::move(state)), positions_(std::move(positions)), all_(false),
+              descending_(descending) {}
+
+        size_t size() const override {
+            return all_ ? state_->data->size() : positions_.size;
+        }
+        void result(sqlite3_context* ctx, size_t row, int col) const override {
+            size_t i = row;
+            if (!all_) {
+                i = positions_.data()[descending_ ? positions_.size - 1 - row : row];
+            }
+            state_->columns[col].result(ctx, (*state_->data)[i]);
+        }
+
+    private:
+        std::shared_ptr<State> state_;
+        RowPositions positions_;
+        bool all_;
+        bool descending_ = false;
+    };
+
+    // Rows decoded for a single lookup
+    class OwnedRows : public RowSet {
+    public:
+        OwnedRows(std::shared_ptr<State> state, std::vector<Row> rows)
+            : state_(std::move(state)), rows_(std::move(rows)) {}
+
+        size_t size() const override { return rows_.size(); }
+        void result(sqlite3_context* ctx, size_t row, int col) const override {
+            state_->columns[col].result(ctx, rows_[row]);
+        }
+
+    private:
+        std::shared_ptr<State> state_;
+        std::vector<Row> rows_;
+    };
+
+    // Rows of one unit at a time, decoded as the cursor reaches them
+    class UnitRows : public RowSet {
+    public:
+        UnitRows(std::shared_ptr<State> state, const std::vector<uint64_t>& units)
+            : state_(std::move(state)), units_(units) {}
+
+        size_t size() const override { return base_ + rows_.size(); }
+        void result(sqlite3_context* ctx, size_t row, int col) const override {
+            state_->columns[col].result(ctx, rows_[row - base_]);
+        }
+        bool has_row(size_t row) override {
+            while (row >= base_ + rows_.size() && next_ < units_.size()) {
+                base_ += rows_.size();
+                rows_.clear();
+                {
+                    DecodeScope scope(state_->stats, false);
+                    state_->decode_unit(units_[next_++], rows_);
+                }
+                state_->stats.lookup_rows.fetch_add(rows_.size(), std::memory_order_relaxed);
+            }
+            return row < base_ + rows_.size();
+        }
+
+    private:
+        std::shared_ptr<State> state_;
+        const std::vector<uint64_t>& units_;
+        size_t next_ = 0;   // Next unit to decode
+        size_t base_ = 0;   // Row number of rows_[0]
+        std::vector<Row> rows_;
+    };
+
+    struct Filter {
+        int column;
+        LookupFn lookup;
+        std::unordered_map<int64_t, std::vector<uint32_t>> positions;
+        bool indexed;
+    };
+
+    struct Range {
+        int low_column;
+        int high_column;
+        RangeFn lookup;
+    };
+
+    struct NameFilter {
+        int column = -1;
+        int gate_column = -1;
+        int64_t gate_value = 0;
+        NameLookupFn lookup;
+        std::vector<uint32_t> order;  // Cache rows by fold_name() of the column
+        bool indexed = false;
+    };
+
+    struct State {
+        std::string name;
+        std::vector<Column> columns;
+        std::vector<Filter> filters;
+        std::vector<Range> ranges;
+        std::vector<NameFilter> names;
+        std::vector<std::string> arguments;
+        CallFn call;
+        RowsFn build_all;
+        SourceFn source;
+        UnitsFn units;
+        UnitFn decode_unit;
+        std::function<bool()> cache_when;
+        std::function<void()> warm_with;
+        TableStats stats;
+        std::atomic<bool> warm{false};  // Readable without mutex, for progress reports
+
+        std::mutex mutex;
+        bool built = false;
+        std::vector<Row> rows;                 // Filled by build_all
+        const std::vector<Row>* data = &rows;  // rows, or the vector from source
+
+        void reset() {
+            std::lock_guard<std::mutex> lock(mutex);
+            built = false;
+            rows.clear();
+            data = &rows;
+            for (auto& f : filters) {
+                f.positions.clear();
+                f.indexed = false;
+            }
+            for (auto& n : names) {
+                n.order.clear();
+                n.indexed = false;
+            }
+            stats.rows = 0;
+            stats.bytes = 0;
+            warm = false;
+        }
+
+        void prewarm() {
+            if (warm_with) {
+                DecodeScope scope(stats, true);
+                warm_with();
+            } else {
+                std::lock_guard<std::mutex> lock(mutex);
+                ensure_rows();
+            }
+            warm = true;
+        }
+
+        // Caller holds mutex
+        void ensure_rows() {
+            if (!built) {
+                {
+                    DecodeScope scope(stats, true);
+                    if (source) {
+                        data = &source();
+                    } else if (build_all) {
+                        build_all(rows);
+                    }
+                }
+                built = true;
+                warm = true;
+                stats.rows = data->size();
+                stats.bytes = data->size() * sizeof(Row);
+            }
+        }
+
+        std::unique_ptr<RowSet> open(const std::shared_ptr<State>& self, int filter, int64_t value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.scans.fetch_add(1, std::memory_order_relaxed);
+            if (filter < 0 || filter >= static_cast<int>(filters.size())) {
+                ensure_rows();
+                return std::make_unique<CachedRows>(self);
+            }
+
+            Filter& f = filters[filter];
+            bool use_cache = built || !f.lookup || (cache_when && cache_when());
+            if (!use_cache) {
+                std::vector<Row> matched;
+                {
+                    DecodeScope scope(stats, false);
+                    f.lookup(value, matched);
+                }
+                stats.lookup_rows.fetch_add(matched.size(), std::memory_order_relaxed);
+                return std::make_unique<OwnedRows>(self, std::move(matched));
+            }
+
+            ensure_rows();
+            if (!f.indexed) {
+                DecodeScope scope(stats, true);
+                const auto& get = columns[f.column].get_int;
+                for (size_t i = 0; i < data->size(); ++i) {
+                    f.positions[get((*data)[i])].push_back(static_cast<uint32_t>(i));
+                }
+                f.indexed = true;
+            }
+
+            RowPositions matched;
+            auto it = f.positions.find(value);
+            if (it != f.positions.end()) {
+                matched.view = it->second.data();
+                matched.size = it->second.size();
+            }
+            return std::make_unique<CachedRows>(self, std::move(matched));
+        }
+
+        std::unique_ptr<RowSet> open_name(const std::shared_ptr<State>& self, int filter,
+                                          const NameKey& key, bool gated) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.scans.fetch_add(1, std::memory_order_relaxed);
+            if (filter < 0 || filter >= static_cast<int>(names.size())) {
+                ensure_rows();
+                return std::make_unique<CachedRows>(self);
+            }
+
+            NameFilter& f = names[filter];
+            bool use_cache = built || !f.lookup || (f.gate_column >= 0 && !gated) ||
+                             (cache_when && cache_when());
+            if (!use_cache) {
+                std::vector<Row> matched;
+                bool answered;
+                {
+                    DecodeScope scope(stats, false);
+                    answered = f.lookup(key, matched);
+                }
+                if (answered) {
+                    stats.lookup_rows.fetch_add(matched.size(), std::memory_order_relaxed);
+                    return std::make_unique<OwnedRows>(self, std::move(matched));
+                }
+            }
+
+            ensure_rows();
+            const Column& column = columns[f.column];
+            if (!f.indexed) {
+                DecodeScope scope(stats, true);
+                std::vector<std::pair<std::string, uint32_t>> keys(data->size());
+                for (size_t i = 0; i < data->size(); ++i) {
+                    keys[i] = {fold_name(column.text((*data)[i])), static_cast<uint32_t>(i)};
+                }
+                std::stable_sort(keys.begin(), keys.end(),
+                                 [](const auto& a, const auto& b) { return a.first < b.first; });
+                f.order.resize(keys.size());
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    f.order[i] = keys[i].second;
+                }
+                f.indexed = true;
+            }
+
+            // Names folding to the key (or starting with it) are contiguous in order
+            std::string scratch;
+            auto first = std::lower_bound(f.order.begin(), f.order.end(), key.text,
+                                          [&](uint32_t row, const std::string& k) {
+                                              return folded_less(column.text_view((*data)[row], scratch), k);
+                                          });
+            std::vector<uint32_t> matched;
+            for (auto it = first; it != f.order.end(); ++it) {
+                std::string_view name = column.text_view((*data)[*it], scratch);
+                if (!folded_starts_with(name, key.text)) break;
+                if (!key.prefix && name.size() != key.text.size()) break;
+                if (key.matches(name)) matched.push_back(*it);
+            }
+            std::sort(matched.begin(), matched.end());  // Cache row order, as a scan returns them
+
+            RowPositions positions;
+            positions.own(std::move(matched));
+            return std::make_unique<CachedRows>(self, std::move(positions));
+        }
+
+        std::unique_ptr<RowSet> open_scan(const std::shared_ptr<State>& self) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.scans.fetch_add(1, std::memory_order_relaxed);
+            if (!built && units && !(cache_when && cache_when())) {
+                return std::make_unique<UnitRows>(self, units());
+            }
+            ensure_rows();
+            return std::make_unique<CachedRows>(self);
+        }
+
+        std::unique_ptr<RowSet> open_range(const std::shared_ptr<State>& self, int range,
+                                           int64_t low_max, int64_t high_min, bool descending) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.scans.fetch_add(1, std::memory_order_relaxed);
+            ensure_rows();
+            if (range < 0 || range >= static_cast<int>(ranges.size())) {
+                return std::make_unique<CachedRows>(self);
+            }
+            return std::make_unique<CachedRows>(self, ranges[range].lookup(low_max, high_min),
+                                                descending);
+        }
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace dwarfsql
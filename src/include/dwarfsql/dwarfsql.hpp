@@ -14,6 +14,12 @@
 
 #include "dwarf_session.hpp"
 #include "dwarf_tables.hpp"
+#include "index_file.hpp"
+#include "connection_pool.hpp"
+#include "session_set.hpp"
+#include "stats.hpp"
+#include "prewarm.hpp"
+#include "query_budget.hpp"
 
 namespace dwarfsql {
 
@@ -0,0 +1,119 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Memory-mapped ELF images for libdwarf
+ *
+ * dwarf_init_b() on a file descriptor read()s every section libdwarf
+ * touches into malloc'd buffers. ElfObject maps the binary once and hands
+ * sections to dwarf_object_init_b() as views of the mapping, so debug data
+ * is never copied and processes opening the same binary share its pages.
+ *
+ * Compressed debug sections (SHF_COMPRESSED or .zdebug_*) are inflated on
+ * the first load of any of them, all at once on a small thread pool, into
+ * buffers shared with every other ElfObject open on the same unchanged file.
+ */
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+#ifdef DWARFSQL_HAS_LIBDWARF
+#include <libdwarf/libdwarf.h>
+#endif
+
+namespace dwarfsql {
+
+class ElfObject {
+public:
+    ElfObject();
+
+    // Not copyable or movable: the access interface points at this object
+    ElfObject(const ElfObject&) = delete;
+    ElfObject& operator=(const ElfObject&) = delete;
+
+    /**
+     * Map an ELF image and read its section headers
+     * @return false for anything this loader does not serve (not ELF,
+     *         relocatable objects with debug relocations, compression
+     *         formats this build cannot inflate, malformed headers);
+     *         callers fall back to dwarf_init_b()
+     *
+     * Call once per object.
+     */
+    bool open(const std::string& path);
+
+    size_t section_count() const { return sections_.size(); }
+    bool little_endian() const { return little_; }
+
+    /**
+     * Contents of the first section called name, inflated if compressed
+     * @return nullptr if there is no such section (or it cannot be inflated)
+     */
+    const uint8_t* section_data(const char* name, uint64_t& size);
+
+#ifdef DWARFSQL_HAS_LIBDWARF
+    /**
+     * Object access interface for dwarf_object_init_b(), valid while this object lives
+     * Read-only, so any number of Dwarf_Debug handles may share one ElfObject.
+     */
+    Dwarf_Obj_Access_Interface* access() { return &access_; }
+#endif
+
+private:
+    enum class Compression : uint8_t { None, Zlib, Zstd };
+
+    struct Section {
+        const char* name;  // Points into the mapping, or into names_ for a renamed .zdebug_*
+        uint64_t addr;
+        uint64_t type;
+        uint64_t flags;
+        uint64_t offset;   // Of the (compressed) payload
+        uint64_t size;     // Uncompressed size
+        uint64_t link;
+        uint64_t info;
+        uint64_t entsize;
+        Compression compression = Compression::None;
+        uint64_t compressed_size = 0;
+        std::shared_ptr<const std::vector<uint8_t>> inflated;
+    };
+
+    MappedFile file_;
+    std::string path_;
+    uint64_t file_size_ = 0;
+    int64_t mtime_ = 0;
+    bool little_ = true;
+    bool is64_ = true;
+    std::vector<Section> sections_;
+    std::deque<std::string> names_;
+    std::once_flag inflate_once_;
+    bool inflate_ok_ = false;
+
+    bool read_compression(Section& s);
+    void inflate_all();
+    const uint8_t* data_of(const Section& s);  // nullptr if compressed and inflation failed
+
+#ifdef DWARFSQL_HAS_LIBDWARF
+    Dwarf_Obj_Access_Interface access_;
+
+    static int get_section_info(void* obj, Dwarf_Half index, Dwarf_Obj_Access_Section* out, int* error);
+    static Dwarf_Endianness get_byte_order(void* obj);
+    static Dwarf_Small get_length_size(void* obj);
+    static Dwarf_Small get_pointer_size(void* obj);
+    static Dwarf_Unsigned get_section_count(void* obj);
+    static int load_section(void* obj, Dwarf_Half index, Dwarf_Small** data, int* error);
+    static const Dwarf_Obj_Access_Methods methods_;
+#endif
+};
+
+} // namespace dwarfsql
@@ -0,0 +1,89 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Persistent index files
+ *
+ * Serializes everything the tables read from a session (the DIE index,
+ * struct members, enum values, line tables and locations) to a sidecar file so a
+ * later session on the same binary can skip the DWARF walk entirely.
+ * Files are keyed by build-id plus size/mtime and memory-mapped on load.
+ */
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "dwarf_session.hpp"
+
+namespace dwarfsql {
+
+/**
+ * Identity of the binary an index file was built from
+ */
+struct IndexFileKey {
+    std::string build_id;  // Hex GNU build-id (ELF) or LC_UUID (Mach-O), empty if none
+    uint64_t file_size = 0;
+    int64_t mtime = 0;
+
+    bool operator==(const IndexFileKey& other) const {
+        return build_id == other.build_id && file_size == other.file_size && mtime == other.mtime;
+    }
+    bool operator!=(const IndexFileKey& other) const { return !(*this == other); }
+};
+
+/**
+ * Lines of one compilation unit within IndexDetails::lines
+ */
+struct LineTableRange {
+    uint64_t cu_offset = 0;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+/**
+ * Per-CU data that DwarfSession otherwise looks up on demand
+ */
+struct IndexDetails {
+    std::vector<LineInfo> lines;
+    std::vector<LineTableRange> line_ranges;
+    std::unordered_map<uint64_t, InternedString> locations;  // Keyed by parameter/local variable offset
+};
+
+/**
+ * Compute the key of a binary on disk
+ * @return false if the file cannot be read
+ */
+bool read_index_key(const std::string& binary_path, IndexFileKey& key);
+
+/**
+ * Default sidecar location for a binary (`<binary>.dwarfsql-idx`)
+ */
+std::string default_index_path(const std::string& binary_path);
+
+/**
+ * Write an index file atomically (temp file + rename)
+ * @param files Table the file numbers of details.lines refer to
+ * @return false with error set on failure
+ */
+bool write_index_file(const std::string& path, const IndexFileKey& key,
+                      const DwarfIndex& index, const IndexDetails& details,
+                      const StringTable& files, std::string& error);
+
+/**
+ * Load an index file
+ * @param expected Key of the binary; files built from anything else are rejected as stale
+ * @param strings Receives the interned strings the loaded records point to
+ * @param files Receives the source files; details.lines' file numbers index it
+ * @return false with error set if the file is missing, stale or corrupt
+ */
+bool read_index_file(const std::string& path, const IndexFileKey& expected,
+                     DwarfIndex& index, IndexDetails& details, StringPool& strings,
+                     std::vector<InternedString>& files, std::string& error);
+
+} // namespace dwarfsql
@@ -0,0 +1,48 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Read-only file mapping
+ *
+ * Shared by the index file reader and the ELF section loader.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dwarfsql {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { unmap(); }
+
+    /**
+     * Map the whole file read-only
+     * @return false if it cannot be opened or mapped; an empty file maps to no data
+     */
+    bool map(const std::string& path);
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void unmap();
+
+#ifdef _WIN32
+    void* file_ = reinterpret_cast<void*>(-1);  // INVALID_HANDLE_VALUE
+    void* mapping_ = nullptr;
+#endif
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace dwarfsql
@@ -0,0 +1,122 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Name lookups
+ *
+ * NameKey is a `name = ?`, `name GLOB 'p*'` or `name LIKE 'p%'` predicate
+ * pushed down to a table. NameIndex reads the accelerator table a linker or
+ * compiler left in the binary (DWARF 5 .debug_names, or .gdb_index) and
+ * tells which units define a name, so a lookup decodes only those units
+ * instead of walking all of .debug_info.
+ *
+ * Accelerator tables list defining DIEs only: no declarations, no local
+ * variables or parameters. Tables use them only where that loses no rows.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dwarfsql {
+
+/**
+ * A pushed-down name predicate
+ */
+struct NameKey {
+    std::string text;     // The name, or the literal prefix of the pattern
+    bool prefix = false;  // Match names starting with text
+    bool nocase = false;  // ASCII case-insensitive, as LIKE compares
+
+    bool matches(std::string_view name) const;
+
+    /**
+     * Key for a pattern, from its literal head
+     * @param like LIKE ('%', '_') rather than GLOB ('*', '?', '[') syntax
+     * @return false if the pattern starts with a wildcard
+     */
+    static bool from_pattern(std::string_view pattern, bool like, NameKey& key);
+};
+
+/**
+ * ASCII lowercase copy, the order NameKey lookups search in
+ */
+std::string fold_name(std::string_view name);
+
+/**
+ * fold_name(a) < fold_name(b), without the copies
+ */
+bool folded_less(std::string_view a, std::string_view b);
+
+/**
+ * fold_name(name) starts with fold_name(prefix), without the copies
+ */
+bool folded_starts_with(std::string_view name, std::string_view prefix);
+
+/**
+ * Kind of DIE an accelerator entry names, as the tables split them
+ */
+enum class NameKind : uint8_t {
+    Function = 1,  // DW_TAG_subprogram, DW_TAG_inlined_subroutine
+    Variable = 2,
+    Struct = 4,    // Structures, classes and unions
+    Type = 8,      // Base types, typedefs and the other rows of the types table
+};
+
+class NameIndex {
+public:
+    /**
+     * Read a .debug_names section (every name index in it)
+     * @param little_endian Byte order of the object
+     * @param str The .debug_str section the names point into
+     * @return false if the section is malformed or uses forms this reader skips
+     */
+    bool load_debug_names(const uint8_t* data, uint64_t size, bool little_endian,
+                          const uint8_t* str, uint64_t str_size);
+
+    /**
+     * Read a .gdb_index section (versions 7 to 9)
+     * @return false if the section is malformed or of another version
+     */
+    bool load_gdb_index(const uint8_t* data, uint64_t size);
+
+    /**
+     * Whether lookups of kind see every defining DIE of the section's producer
+     *
+     * .gdb_index is written from GDB's symbol tables, where base types and
+     * typedefs are not reliably present; type units are never covered.
+     */
+    bool covers(NameKind kind) const { return (covered_ & static_cast<uint8_t>(kind)) != 0; }
+
+    /**
+     * .debug_info offsets of the unit headers with a DIE of kind matching key
+     * @return Ascending, without duplicates
+     */
+    std::vector<uint64_t> units(const NameKey& key, NameKind kind) const;
+
+    bool empty() const { return entries_.empty(); }
+    const char* source() const { return source_; }
+
+private:
+    struct Entry {
+        std::string_view name;  // Into the mapped section; unqualified for .gdb_index
+        uint32_t unit;          // Into units_
+        uint8_t kinds;          // NameKind bits
+    };
+
+    void finish();
+
+    std::vector<uint64_t> units_;  // Unit header offsets
+    std::vector<Entry> entries_;   // Sorted by fold_name(name)
+    uint8_t covered_ = 0;
+    const char* source_ = "";
+};
+
+} // namespace dwarfsql
@@ -0,0 +1,105 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Background cache building at server startup
+ *
+ * Without it the first query on each table pays for the DWARF walk and the
+ * row cache inline. A Prewarmer walks each module's DIE index and then
+ * builds the chosen tables on background threads while the server already
+ * answers queries; a table that is warm is served at once, one still being
+ * built makes its query wait for that build rather than start another.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dwarf_vtable.hpp"
+#include "session_set.hpp"
+
+namespace dwarfsql {
+
+class Prewarmer {
+public:
+    // Runs one step; lets the caller hold off a reload meanwhile (e.g. with
+    // a ConnectionPool lease)
+    using Runner = std::function<void(const std::function<void()>& step)>;
+
+    struct Progress {
+        size_t total = 0;                   // Steps: one index per module, then one per table
+        size_t done = 0;
+        std::vector<std::string> building;  // Steps in progress
+        std::vector<std::string> warm;      // Tables ready, "<module>:<table>" with several modules
+        std::vector<std::string> errors;
+        uint64_t elapsed_ns = 0;            // Until now, or until the last step finished
+        bool finished = false;
+    };
+
+    /**
+     * Start warming on background threads
+     * @param tables Definitions from build_tables(); module tables warm each part
+     * @param names Tables to build, all of them if empty
+     * @param threads Modules warmed at once (<= 0 = one per hardware thread)
+     * @param run Wraps every step; nullptr to run it directly
+     *
+     * Names are checked by unknown_tables() beforehand.
+     */
+    Prewarmer(SessionSet& sessions, const std::vector<TableDef>& tables,
+              const std::vector<std::string>& names, int threads, Runner run = nullptr);
+
+    // Waits for the step in progress on each thread; the rest are skipped
+    ~Prewarmer();
+
+    Prewarmer(const Prewarmer&) = delete;
+    Prewarmer& operator=(const Prewarmer&) = delete;
+
+    Progress progress() const;
+
+    /**
+     * Entries of names that are not tables in tables
+     */
+    static std::vector<std::string> unknown_tables(const std::vector<TableDef>& tables,
+                                                   const std::vector<std::string>& names);
+
+private:
+    struct Step {
+        std::string label;
+        std::function<void()> fn;
+        std::function<bool()> warm;  // Null for the index step
+    };
+
+    void worker();
+
+    std::vector<std::vector<Step>> modules_;  // Steps of each module, index first
+    Runner run_;
+    std::atomic<size_t> next_module_{0};
+    std::atomic<bool> stopping_{false};
+    std::chrono::steady_clock::time_point start_;
+
+    mutable std::mutex mutex_;
+    size_t done_ = 0;
+    size_t total_ = 0;
+    std::vector<std::string> building_;
+    std::vector<std::string> errors_;
+    uint64_t finished_ns_ = 0;
+
+    std::vector<std::thread> threads_;
+};
+
+/**
+ * Progress as one line of text, e.g. for .stats or the MCP status tool
+ */
+std::string format_prewarm(const Prewarmer::Progress& progress);
+
+} // namespace dwarfsql
@@ -0,0 +1,126 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Limits on one query, and how a running query is stopped
+ *
+ * A QueryBudget is in effect on a thread while a QueryScope holds it.
+ * SQLite checks it from the connection's progress handler and stops the
+ * statement with SQLITE_INTERRUPT. The DWARF walks behind the table caches
+ * run inside a single xFilter call, where that handler never fires, so they
+ * poll query_cancelled() between DIEs and units instead. A cache build cut
+ * short keeps the units it finished for the next query that needs it and
+ * throws QueryCancelled; a lookup cut short may return fewer rows, which is
+ * why a query whose budget ran out must be reported as failed whatever it
+ * returned (see QueryBudget::spent()).
+ */
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace dwarfsql {
+
+struct QueryLimits {
+    uint64_t max_ms = 0;    // Wall time of one query (0 = unlimited)
+    uint64_t max_rows = 0;  // Result rows of one query, over all its statements (0 = unlimited)
+};
+
+class QueryBudget {
+public:
+    // The clock starts here
+    explicit QueryBudget(const QueryLimits& limits = {});
+
+    // Non-copyable
+    QueryBudget(const QueryBudget&) = delete;
+    QueryBudget& operator=(const QueryBudget&) = delete;
+
+    /**
+     * Stop the query; safe from any thread and from a signal handler
+     */
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+    /**
+     * Count one result row
+     * @return false once past max_rows
+     */
+    bool add_row();
+
+    /**
+     * Check the query was cancelled, ran past its deadline or returned more
+     * than max_rows; once true, stays true
+     */
+    bool spent() const;
+
+    /**
+     * Why spent() holds, as an error message; empty while it does not
+     */
+    std::string reason() const;
+
+    /**
+     * The budget in effect on this thread, or null
+     */
+    static QueryBudget* current();
+
+private:
+    QueryLimits limits_;
+    std::chrono::steady_clock::time_point deadline_;
+    std::atomic<bool> cancelled_{false};
+    mutable std::atomic<bool> expired_{false};  // Latched, so spent() never turns back
+    std::atomic<uint64_t> rows_{0};
+};
+
+/**
+ * Puts budget in effect on this thread until destroyed, and on db's
+ * statements if db is set: a progress handler interrupts them once the
+ * budget is spent and every result row is counted against it. Scopes nest
+ * on a thread; only one per connection may set db. Worker threads of a
+ * cache build open one with the budget of the thread that started it.
+ */
+class QueryScope {
+public:
+    explicit QueryScope(QueryBudget* budget, sqlite3* db = nullptr);
+    ~QueryScope();
+
+    // Non-copyable
+    QueryScope(const QueryScope&) = delete;
+    QueryScope& operator=(const QueryScope&) = delete;
+
+private:
+    QueryBudget* previous_;
+    sqlite3* db_;
+};
+
+/**
+ * Check the budget in effect on this thread is spent; false without one
+ */
+inline bool query_cancelled() {
+    QueryBudget* budget = QueryBudget::current();
+    return budget && budget->spent();
+}
+
+/**
+ * Thrown by a cache build that stopped because query_cancelled()
+ */
+class QueryCancelled : public std::runtime_error {
+public:
+    QueryCancelled() : std::runtime_error(message()) {}
+
+private:
+    static std::string message() {
+        QueryBudget* budget = QueryBudget::current();
+        std::string reason = budget ? budget->reason() : std::string();
+        return reason.empty() ? "query cancelled" : reason;
+    }
+};
+
+} // namespace dwarfsql
@@ -0,0 +1,69 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Sessions over several binaries
+ *
+ * An executable and its shared libraries are opened side by side, one
+ * DwarfSession per module, and build_tables(SessionSet&) stacks their
+ * tables behind a `module` column, so one database (and one process)
+ * answers queries across all of them.
+ */
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dwarf_session.hpp"
+
+namespace dwarfsql {
+
+class SessionSet {
+public:
+    struct Module {
+        std::string name;  // File name, or the path where two modules share a file name
+        std::unique_ptr<DwarfSession> session;
+    };
+
+    /**
+     * Open every binary, several at a time
+     * @param paths Binaries, in module order
+     * @param jobs Binaries opened at once (<= 0 = one per hardware thread);
+     *             with one binary, its session's extraction threads instead
+     * @param prepare Run on each session once it is open, on the thread that
+     *                opened it (e.g. to load or build its index)
+     * @return false if no binary could be opened
+     *
+     * Binaries that fail to open are left out and reported by errors().
+     */
+    bool open(const std::vector<std::string>& paths, int jobs,
+              const std::function<void(DwarfSession&)>& prepare = nullptr);
+
+    size_t size() const { return modules_.size(); }
+    bool empty() const { return modules_.empty(); }
+
+    Module& operator[](size_t i) { return modules_[i]; }
+    const Module& operator[](size_t i) const { return modules_[i]; }
+
+    /**
+     * Module called name, nullptr if none
+     */
+    const Module* find(const std::string& name) const;
+
+    /**
+     * "<path>: <error>" for each binary open() left out
+     */
+    const std::vector<std::string>& errors() const { return errors_; }
+
+private:
+    std::vector<Module> modules_;
+    std::vector<std::string> errors_;
+};
+
+} // namespace dwarfsql
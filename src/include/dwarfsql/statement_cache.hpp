@@ -0,0 +1,102 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Prepared statements of one connection
+ *
+ * Clients send the same few query shapes over and over, differing only in
+ * the values they look up. A StatementCache keeps the compiled statements
+ * of one database keyed by normalized SQL, so a repeated query skips
+ * SQLite's parser and planner; values are bound to `?` placeholders. The
+ * least recently used statement is finalized once the cache is full.
+ */
+
+#include <sqlite3.h>
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace dwarfsql {
+
+/**
+ * The cache key of a statement: sql without comments, without surrounding
+ * whitespace or trailing semicolons, and with each run of whitespace
+ * outside literals and quoted names folded to one space
+ */
+std::string normalize_sql(std::string_view sql);
+
+class StatementCache {
+    struct Entry;
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    explicit StatementCache(sqlite3* db, size_t capacity = DEFAULT_CAPACITY);
+    ~StatementCache();  // Finalizes every statement, so it must go before the database
+
+    // Non-copyable
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /**
+     * A statement checked out of the cache; reset and its bindings cleared
+     * when destroyed. Must not outlive the cache.
+     */
+    class Statement {
+    public:
+        Statement() = default;
+        Statement(Statement&& other) noexcept;
+        Statement& operator=(Statement&&) = delete;
+        ~Statement();
+
+        sqlite3_stmt* get() const { return stmt_; }
+        explicit operator bool() const { return stmt_ != nullptr; }
+
+        // Taken from the cache rather than compiled for this use
+        bool reused() const { return reused_; }
+
+    private:
+        friend class StatementCache;
+        Statement(sqlite3_stmt* stmt, Entry* entry, bool reused) : stmt_(stmt), entry_(entry), reused_(reused) {}
+
+        sqlite3_stmt* stmt_ = nullptr;
+        Entry* entry_ = nullptr;  // Null: not cached, finalized when done
+        bool reused_ = false;
+    };
+
+    /**
+     * Statement for sql, compiled on first use
+     *
+     * @param error Set to SQLite's message if the statement does not compile
+     * @return An empty Statement if sql is not exactly one statement
+     *         (several, none, or one that fails to compile)
+     */
+    Statement prepare(std::string_view sql, std::string& error);
+
+    size_t size() const { return entries_.size(); }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Entry {
+        std::string key;
+        sqlite3_stmt* stmt;
+        bool in_use = false;
+    };
+
+    void evict();
+
+    sqlite3* db_;
+    size_t capacity_;
+    std::list<Entry> entries_;  // Most recently used first
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> by_key_;  // Views of Entry::key
+};
+
+} // namespace dwarfsql
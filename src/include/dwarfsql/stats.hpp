@@ -0,0 +1,221 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Counters for where query time goes
+ *
+ * The DWARF readers bump a thread-local DecodeCounters (DIEs visited,
+ * dwarf_offdie_b calls, type-name cache hits, time in dwarf_srclines_b);
+ * each table charges the change across its own cache builds and lookups
+ * to its TableStats, and QueryStats splits every query's wall time into
+ * table decoding and the rest (SQLite). Index workers hand their counts
+ * to the thread that waited on them, so a parallel walk is charged to the
+ * table whose scan started it.
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dwarfsql {
+
+struct TableDef;
+class SessionSet;
+
+/**
+ * Work done on one thread; plain integers, only ever touched by their thread
+ */
+struct DecodeCounters {
+    uint64_t dies_visited = 0;
+    uint64_t offdie_calls = 0;
+    uint64_t type_cache_hits = 0;
+    uint64_t type_cache_misses = 0;
+    uint64_t srclines_ns = 0;  // In dwarf_srclines_b / dwarf_srclines_from_linecontext
+    uint64_t decode_ns = 0;    // In table cache builds and lookups
+
+    DecodeCounters& operator+=(const DecodeCounters& other) {
+        dies_visited += other.dies_visited;
+        offdie_calls += other.offdie_calls;
+        type_cache_hits += other.type_cache_hits;
+        type_cache_misses += other.type_cache_misses;
+        srclines_ns += other.srclines_ns;
+        decode_ns += other.decode_ns;
+        return *this;
+    }
+
+    DecodeCounters operator-(const DecodeCounters& since) const {
+        DecodeCounters d;
+        d.dies_visited = dies_visited - since.dies_visited;
+        d.offdie_calls = offdie_calls - since.offdie_calls;
+        d.type_cache_hits = type_cache_hits - since.type_cache_hits;
+        d.type_cache_misses = type_cache_misses - since.type_cache_misses;
+        d.srclines_ns = srclines_ns - since.srclines_ns;
+        d.decode_ns = decode_ns - since.decode_ns;
+        return d;
+    }
+};
+
+inline thread_local DecodeCounters decode_counters;
+
+inline uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+/**
+ * Counters of one virtual table, shared by every connection it is registered on
+ */
+struct TableStats {
+    std::atomic<uint64_t> scans{0};        // Cursors opened (xFilter)
+    std::atomic<uint64_t> builds{0};       // Row cache builds, including filter indexes
+    std::atomic<uint64_t> build_ns{0};
+    std::atomic<uint64_t> rows{0};         // Rows in the cache, 0 until built
+    std::atomic<uint64_t> bytes{0};        // Row storage of the cache, strings excluded
+    std::atomic<uint64_t> lookups{0};      // Keys, units and calls decoded without the cache
+    std::atomic<uint64_t> lookup_ns{0};
+    std::atomic<uint64_t> lookup_rows{0};
+    std::atomic<uint64_t> dies_visited{0};
+    std::atomic<uint64_t> offdie_calls{0};
+    std::atomic<uint64_t> type_cache_hits{0};
+    std::atomic<uint64_t> type_cache_misses{0};
+    std::atomic<uint64_t> srclines_ns{0};
+
+    void add(const DecodeCounters& d) {
+        dies_visited.fetch_add(d.dies_visited, std::memory_order_relaxed);
+        offdie_calls.fetch_add(d.offdie_calls, std::memory_order_relaxed);
+        type_cache_hits.fetch_add(d.type_cache_hits, std::memory_order_relaxed);
+        type_cache_misses.fetch_add(d.type_cache_misses, std::memory_order_relaxed);
+        srclines_ns.fetch_add(d.srclines_ns, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Charges one cache build or lookup on this thread to a table
+ *
+ * Not nestable: the enclosed work must not open another table's scope.
+ */
+class DecodeScope {
+public:
+    DecodeScope(TableStats& stats, bool build)
+        : stats_(stats), build_(build), before_(decode_counters),
+          start_(std::chrono::steady_clock::now()) {}
+
+    ~DecodeScope() {
+        uint64_t ns = elapsed_ns(start_);
+        stats_.add(decode_counters - before_);
+        decode_counters.decode_ns += ns;
+        if (build_) {
+            stats_.builds.fetch_add(1, std::memory_order_relaxed);
+            stats_.build_ns.fetch_add(ns, std::memory_order_relaxed);
+        } else {
+            stats_.lookups.fetch_add(1, std::memory_order_relaxed);
+            stats_.lookup_ns.fetch_add(ns, std::memory_order_relaxed);
+        }
+    }
+
+    DecodeScope(const DecodeScope&) = delete;
+    DecodeScope& operator=(const DecodeScope&) = delete;
+
+private:
+    TableStats& stats_;
+    bool build_;
+    DecodeCounters before_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Query counts and latencies for one database or pool
+ */
+class QueryStats {
+public:
+    // Upper bounds of the latency histogram, in seconds
+    static constexpr std::array<double, 10> BUCKETS = {
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 1.0, 5.0};
+
+    // ok is false for a query the SQL parser rejected
+    void record(uint64_t total_ns, uint64_t decode_ns, bool ok);
+
+    // A query run from a connection's StatementCache; reused if it skipped compiling
+    void record_statement(bool reused) {
+        (reused ? statements_reused_ : statements_prepared_).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(); }
+    uint64_t errors() const { return errors_.load(); }
+    uint64_t total_ns() const { return total_ns_.load(); }
+    uint64_t decode_ns() const { return decode_ns_.load(); }
+    uint64_t max_ns() const { return max_ns_.load(); }
+    uint64_t last_ns() const { return last_ns_.load(); }
+    uint64_t last_decode_ns() const { return last_decode_ns_.load(); }
+    // A query its QueryBudget stopped (query_budget.hpp)
+    void record_stopped() { stopped_.fetch_add(1, std::memory_order_relaxed); }
+
+    uint64_t statements_reused() const { return statements_reused_.load(); }
+    uint64_t statements_prepared() const { return statements_prepared_.load(); }
+    uint64_t stopped() const { return stopped_.load(); }
+
+    // Queries at or under BUCKETS[i]; the last entry counts all of them
+    std::array<uint64_t, BUCKETS.size() + 1> histogram() const;
+
+private:
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> decode_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+    std::atomic<uint64_t> last_ns_{0};
+    std::atomic<uint64_t> last_decode_ns_{0};
+    std::atomic<uint64_t> statements_reused_{0};
+    std::atomic<uint64_t> statements_prepared_{0};
+    std::atomic<uint64_t> stopped_{0};
+    std::array<std::atomic<uint64_t>, BUCKETS.size()> buckets_{};
+};
+
+/**
+ * Times one query run on this thread; the part spent decoding tables
+ * comes from this thread's decode_counters
+ */
+class QueryTimer {
+public:
+    explicit QueryTimer(QueryStats& stats)
+        : stats_(stats), decode_before_(decode_counters.decode_ns),
+          start_(std::chrono::steady_clock::now()) {}
+
+    ~QueryTimer() {
+        stats_.record(elapsed_ns(start_), decode_counters.decode_ns - decode_before_, ok_);
+    }
+
+    void fail() { ok_ = false; }
+
+    QueryTimer(const QueryTimer&) = delete;
+    QueryTimer& operator=(const QueryTimer&) = delete;
+
+private:
+    QueryStats& stats_;
+    uint64_t decode_before_;
+    std::chrono::steady_clock::time_point start_;
+    bool ok_ = true;
+};
+
+/**
+ * Per-table counters and query latencies as a text report (.stats)
+ * @param tables Definitions from build_tables(); module tables list each part
+ */
+std::string format_stats(const SessionSet& sessions, const std::vector<TableDef>& tables,
+                         const QueryStats& queries);
+
+/**
+ * The same counters in the Prometheus text exposition format (GET /metrics)
+ */
+std::string format_metrics(const SessionSet& sessions, const std::vector<TableDef>& tables,
+                           const QueryStats& queries);
+
+} // namespace dwarfsql
@@ -0,0 +1,152 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+#pragma once
+
+/**
+ * Interned strings
+ *
+ * Source paths and rendered type names repeat across millions of line rows
+ * and DIEs. A StringPool stores each distinct string once in append-only
+ * blocks; records keep a 12-byte InternedString pointing into the pool,
+ * valid for as long as the pool (or a pool that adopted it) lives.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dwarfsql {
+
+/**
+ * Handle to a string owned by a StringPool
+ *
+ * Only StringPool::intern() creates non-empty handles, so a temporary
+ * std::string can never be stored by accident.
+ */
+class InternedString {
+public:
+    InternedString() = default;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    operator std::string_view() const { return view(); }
+    std::string str() const { return std::string(data_, size_); }
+
+    friend bool operator==(InternedString a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(InternedString a, std::string_view b) { return a.view() != b; }
+
+private:
+    friend class StringPool;
+    InternedString(const char* data, uint32_t size) : data_(data), size_(size) {}
+
+    const char* data_ = "";
+    uint32_t size_ = 0;
+};
+
+class StringPool {
+public:
+    StringPool() = default;
+
+    // Non-copyable
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // Movable; handles stay valid
+    StringPool(StringPool&& other) noexcept;
+    StringPool& operator=(StringPool&& other) noexcept;
+
+    /**
+     * Get the pooled copy of s, adding it on first use
+     */
+    InternedString intern(std::string_view s);
+
+    /**
+     * Take over other's storage, so handles from either pool stay valid
+     * for the lifetime of this one
+     */
+    void adopt(StringPool&& other);
+
+    /**
+     * Take over other's storage without indexing its strings, in time
+     * proportional to its blocks. For pools whose strings this one will
+     * not be asked for again: a later intern() of one stores a second copy.
+     */
+    void absorb(StringPool&& other);
+
+    /**
+     * Drop every string; invalidates all handles
+     */
+    void clear();
+
+    size_t count() const { return strings_.size(); }  // Distinct strings
+    size_t bytes() const { return bytes_; }           // Block storage allocated
+
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_ = nullptr;  // Free space in the block being filled
+    size_t left_ = 0;
+    size_t bytes_ = 0;
+    std::unordered_set<std::string_view> strings_;
+};
+
+/**
+ * Numbering of interned strings, so records that repeat a handful of
+ * strings (line rows and their source file) store a 4-byte number
+ *
+ * Number 0 is the empty string. add() must be serialized by the caller;
+ * lookups take no lock, even while another thread adds, since entries
+ * never move.
+ */
+class StringTable {
+public:
+    StringTable();
+
+    // Movable; numbers stay valid
+    StringTable(StringTable&& other) noexcept;
+    StringTable& operator=(StringTable&& other) noexcept;
+
+    /**
+     * Number of s, assigning the next one on first use; 0 once the table is full
+     */
+    uint32_t add(InternedString s);
+
+    InternedString operator[](uint32_t number) const {
+        const InternedString* chunk = chunks_[number >> CHUNK_BITS].load(std::memory_order_acquire);
+        return chunk ? chunk[number & CHUNK_MASK] : InternedString();
+    }
+
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+
+    /**
+     * Forget every number; no lookup may be running
+     */
+    void clear();
+
+private:
+    static constexpr uint32_t CHUNK_BITS = 12;
+    static constexpr uint32_t CHUNK_MASK = (1u << CHUNK_BITS) - 1;
+    static constexpr size_t MAX_CHUNKS = 4096;  // 16M strings
+
+    // Fixed array of chunk pointers, so a lookup never sees it reallocate
+    std::unique_ptr<std::atomic<const InternedString*>[]> chunks_;
+    std::vector<std::unique_ptr<InternedString[]>> owned_;
+    std::unordered_map<const char*, uint32_t> numbers_;  // By pooled data pointer
+    std::atomic<size_t> size_{0};
+};
+
+} // namespace dwarfsql
@@ -0,0 +1,605 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * index_file.cpp - Persistent index file reader/writer
+ *
+ * Layout (host byte order, checked by a byte-order mark):
+ *   magic "DWSQLIDX", u32 version, u32 byte-order mark
+ *   key: build_id, file_size, mtime
+ *   DwarfIndex vectors, struct members, enum values, address ranges,
+ *   line tables, locations
+ * Integers are fixed width, strings are u32 length + bytes, and every
+ * vector is prefixed by a u64 count; line rows, the bulk of most files,
+ * are varints instead (see write_lines).  Nothing in the file is trusted:
+ * the reader bounds-checks every field and rejects short or oversized data.
+ */
+
+#include <dwarfsql/index_file.hpp>
+#include <dwarfsql/mapped_file.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <type_traits>
+
+namespace dwarfsql {
+
+namespace {
+
+constexpr char MAGIC[8] = {'D', 'W', 'S', 'Q', 'L', 'I', 'D', 'X'};
+constexpr uint32_t FORMAT_VERSION = 6;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// ============================================================================
+// Build-id extraction
+// ============================================================================
+
+std::string to_hex(const uint8_t* p, size_t n) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(n * 2);
+    for (size_t i = 0; i < n; ++i) {
+        out += digits[p[i] >> 4];
+        out += digits[p[i] & 0xf];
+    }
+    return out;
+}
+
+// Fixed-width integer at p in the given byte order (true = little-endian)
+uint64_t read_uint(const uint8_t* p, size_t width, bool little) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < width; ++i) {
+        size_t shift = little ? i : width - 1 - i;
+        v |= static_cast<uint64_t>(p[i]) << (8 * shift);
+    }
+    return v;
+}
+
+// GNU build-id from the SHT_NOTE sections of an ELF image
+std::string elf_build_id(const uint8_t* data, size_t size) {
+    if (size < 64) return "";
+    bool is64 = data[4] == 2;     // EI_CLASS == ELFCLASS64
+    bool little = data[5] == 1;   // EI_DATA == ELFDATA2LSB
+
+    uint64_t shoff = is64 ? read_uint(data + 0x28, 8, little) : read_uint(data + 0x20, 4, little);
+    size_t shentsize = static_cast<size_t>(read_uint(data + (is64 ? 0x3a : 0x2e), 2, little));
+    size_t shnum = static_cast<size_t>(read_uint(data + (is64 ? 0x3c : 0x30), 2, little));
+    if (shoff == 0 || shentsize < (is64 ? 64u : 40u) || shoff > size ||
+        shnum > (size - shoff) / shentsize) {
+        return "";
+    }
+
+    for (size_t i = 0; i < shnum; ++i) {
+        const uint8_t* sh = data + shoff + i * shentsize;
+        if (read_uint(sh + 4, 4, little) != 7) continue;  // SHT_NOTE
+
+        uint64_t off = is64 ? read_uint(sh + 0x18, 8, little) : read_uint(sh + 0x10, 4, little);
+        uint64_t len = is64 ? read_uint(sh + 0x20, 8, little) : read_uint(sh + 0x14, 4, little);
+        if (off > size || len > size - off) continue;
+
+        const uint8_t* p = data + off;
+        const uint8_t* end = p + len;
+        while (end - p >= 12) {
+            uint64_t namesz = read_uint(p, 4, little);
+            uint64_t descsz = read_uint(p + 4, 4, little);
+            uint64_t type = read_uint(p + 8, 4, little);
+            const uint8_t* name = p + 12;
+            uint64_t name_padded = (namesz + 3) & ~uint64_t(3);
+            uint64_t desc_padded = (descsz + 3) & ~uint64_t(3);
+            if (name_padded + desc_padded > static_cast<uint64_t>(end - name)) break;
+
+            const uint8_t* desc = name + name_padded;
+            if (type == 3 && namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {  // NT_GNU_BUILD_ID
+                return to_hex(desc, static_cast<size_t>(descsz));
+            }
+            p = desc + desc_padded;
+        }
+    }
+    return "";
+}
+
+// LC_UUID from a thin Mach-O image
+std::string macho_uuid(const uint8_t* data, size_t size) {
+    if (size < 28) return "";
+    uint32_t magic = static_cast<uint32_t>(read_uint(data, 4, true));
+    size_t header_size;
+    if (magic == 0xfeedfacf) header_size = 32;       // MH_MAGIC_64
+    else if (magic == 0xfeedface) header_size = 28;  // MH_MAGIC
+    else return "";
+
+    size_t ncmds = static_cast<size_t>(read_uint(data + 16, 4, true));
+    size_t off = header_size;
+    for (size_t i = 0; i < ncmds && off + 8 <= size; ++i) {
+        uint32_t cmd = static_cast<uint32_t>(read_uint(data + off, 4, true));
+        size_t cmdsize = static_cast<size_t>(read_uint(data + off + 4, 4, true));
+        if (cmdsize < 8 || cmdsize > size - off) break;
+        if (cmd == 0x1b && cmdsize >= 24) {  // LC_UUID
+            return to_hex(data + off + 8, 16);
+        }
+        off += cmdsize;
+    }
+    return "";
+}
+
+// ============================================================================
+// Serialization
+// ============================================================================
+
+class Writer {
+public:
+    void bytes(const void* p, size_t n) { buf_.append(static_cast<const char*>(p), n); }
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type operator()(const T& v) {
+        bytes(&v, sizeof(v));
+    }
+
+    void operator()(std::string_view s) {
+        uint32_t n = static_cast<uint32_t>(s.size());
+        (*this)(n);
+        bytes(s.data(), n);
+    }
+
+    void operator()(const std::string& s) { (*this)(std::string_view(s)); }
+    void operator()(const InternedString& s) { (*this)(s.view()); }
+
+    // LEB128
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            buf_ += static_cast<char>(v | 0x80);
+            v >>= 7;
+        }
+        buf_ += static_cast<char>(v);
+    }
+
+    const std::string& buffer() const { return buf_; }
+
+private:
+    std::string buf_;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* p, size_t n, StringPool* strings = nullptr)
+        : p_(p), end_(p + n), strings_(strings) {}
+
+    bool bytes(void* out, size_t n) {
+        if (failed_ || static_cast<size_t>(end_ - p_) < n) {
+            failed_ = true;
+            return false;
+        }
+        std::memcpy(out, p_, n);
+        p_ += n;
+        return true;
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type operator()(T& v) {
+        if (!bytes(&v, sizeof(v))) v = T();
+    }
+
+    void operator()(std::string& s) {
+        uint32_t n = 0;
+        (*this)(n);
+        if (failed_ || static_cast<size_t>(end_ - p_) < n) {
+            failed_ = true;
+            return;
+        }
+        s.assign(reinterpret_cast<const char*>(p_), n);
+        p_ += n;
+    }
+
+    void operator()(InternedString& s) {
+        uint32_t n = 0;
+        (*this)(n);
+        if (failed_ || !strings_ || static_cast<size_t>(end_ - p_) < n) {
+            failed_ = true;
+            return;
+        }
+        s = strings_->intern(std::string_view(reinterpret_cast<const char*>(p_), n));
+        p_ += n;
+    }
+
+    bool varint(uint64_t& v) {
+        v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (failed_ || p_ == end_) break;
+            uint8_t byte = *p_++;
+            v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        failed_ = true;
+        return false;
+    }
+
+    // n elements of at least element_size bytes each must fit in the bytes
+    // left; rejects a corrupt count before anything is allocated for it
+    bool count(uint64_t& n, size_t element_size) {
+        (*this)(n);
+        if (n > remaining() / element_size) failed_ = true;
+        return !failed_;
+    }
+
+    size_t remaining() const { return static_cast<size_t>(end_ - p_); }
+    bool failed() const { return failed_; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    StringPool* strings_;
+    bool failed_ = false;
+};
+
+// One field list per record type, shared by Writer (const) and Reader (mutable)
+template <typename T, typename Record>
+using if_record = typename std::enable_if<std::is_same<typename std::remove_const<T>::type, Record>::value, int>::type;
+
+template <typename A, typename T, if_record<T, DieInfo> = 0>
+void fields(A& a, T& d) {
+    a(d.offset); a(d.cu_offset); a(d.func_offset); a(d.tag);
+    a(d.name); a(d.linkage_name); a(d.type);
+    a(d.low_pc); a(d.high_pc); a(d.byte_size); a(d.decl_file); a(d.decl_line);
+    a(d.is_external); a(d.is_declaration); a(d.is_inline); a(d.origin_offset);
+}
+
+template <typename A, typename T, if_record<T, CompilationUnit> = 0>
+void fields(A& a, T& c) {
+    a(c.offset); a(c.name); a(c.comp_dir); a(c.producer); a(c.language); a(c.low_pc); a(c.high_pc);
+    a(c.content_hash);
+}
+
+template <typename A, typename T, if_record<T, ParameterInfo> = 0>
+void fields(A& a, T& p) {
+    a(p.offset); a(p.func_offset); a(p.name); a(p.type); a(p.index);
+}
+
+template <typename A, typename T, if_record<T, LocalVarInfo> = 0>
+void fields(A& a, T& v) {
+    a(v.offset); a(v.func_offset); a(v.name); a(v.type); a(v.decl_line);
+    a(v.scope_low_pc); a(v.scope_high_pc);
+}
+
+template <typename A, typename T, if_record<T, BaseClassInfo> = 0>
+void fields(A& a, T& b) {
+    a(b.derived_offset); a(b.derived_name); a(b.base_offset); a(b.base_name);
+    a(b.data_member_offset); a(b.is_virtual); a(b.access);
+}
+
+template <typename A, typename T, if_record<T, CallInfo> = 0>
+void fields(A& a, T& c) {
+    a(c.caller_offset); a(c.caller_name); a(c.callee_offset); a(c.callee_name);
+    a(c.call_pc); a(c.call_line); a(c.is_tail_call);
+}
+
+template <typename A, typename T, if_record<T, InlinedCallInfo> = 0>
+void fields(A& a, T& i) {
+    a(i.offset); a(i.abstract_origin); a(i.name); a(i.caller_offset); a(i.parent_offset);
+    a(i.low_pc); a(i.high_pc); a(i.call_line); a(i.call_column);
+}
+
+template <typename A, typename T, if_record<T, NamespaceInfo> = 0>
+void fields(A& a, T& n) {
+    a(n.offset); a(n.name); a(n.parent_offset); a(n.is_anonymous);
+}
+
+template <typename A, typename T, if_record<T, AddressRange> = 0>
+void fields(A& a, T& r) {
+    a(r.low); a(r.high);
+}
+
+// Bytes a record takes at the least: its fixed fields and a length per string
+template <typename T>
+size_t min_record_size() {
+    static const size_t size = [] {
+        Writer w;
+        T row{};
+        fields(w, row);
+        return w.buffer().size();
+    }();
+    return size;
+}
+
+template <typename T>
+void write_vector(Writer& w, const std::vector<T>& rows) {
+    w(static_cast<uint64_t>(rows.size()));
+    for (const auto& row : rows) fields(w, row);
+}
+
+template <typename T>
+bool read_vector(Reader& r, std::vector<T>& rows) {
+    uint64_t n = 0;
+    if (!r.count(n, min_record_size<T>())) return false;
+    rows.resize(static_cast<size_t>(n));
+    for (auto& row : rows) {
+        fields(r, row);
+        if (r.failed()) return false;
+    }
+    return true;
+}
+
+uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// Source files, then per row: varint address and line deltas from the row
+// before (zigzag, as sequences restart lower), varint file number, and the
+// column shifted left past the three flags. Most rows take 4-5 bytes.
+void write_lines(Writer& w, const std::vector<LineInfo>& lines, const StringTable& files) {
+    w(static_cast<uint64_t>(files.size()));
+    for (size_t i = 0; i < files.size(); ++i) {
+        w(files[static_cast<uint32_t>(i)]);
+    }
+
+    w(static_cast<uint64_t>(lines.size()));
+    uint64_t address = 0;
+    int64_t line = 0;
+    for (const auto& l : lines) {
+        w.varint(zigzag(static_cast<int64_t>(l.address() - address)));
+        w.varint(zigzag(l.line - line));
+        w.varint(l.file);
+        w.varint(static_cast<uint64_t>(l.column) << 3 | l.is_stmt << 2 | l.basic_block << 1 | l.end_sequence);
+        address = l.address();
+        line = l.line;
+    }
+}
+
+// File numbers in lines index files as read
+bool read_lines(Reader& r, std::vector<LineInfo>& lines, std::vector<InternedString>& files) {
+    uint64_t n = 0;
+    if (!r.count(n, sizeof(uint32_t))) return false;  // A string length each
+    files.resize(static_cast<size_t>(n));
+    for (auto& file : files) {
+        r(file);
+        if (r.failed()) return false;
+    }
+
+    if (!r.count(n, 4)) return false;  // Four varints of a byte or more each
+    lines.resize(static_cast<size_t>(n));
+    uint64_t address = 0;
+    int64_t line = 0;
+    for (auto& l : lines) {
+        uint64_t delta = 0, line_delta = 0, file = 0, bits = 0;
+        if (!r.varint(delta) || !r.varint(line_delta) || !r.varint(file) || !r.varint(bits)) return false;
+        if (file >= files.size()) return false;
+        address += static_cast<uint64_t>(unzigzag(delta));
+        line += unzigzag(line_delta);
+        l.set_address(address);
+        l.line = static_cast<int>(line);
+        l.file = static_cast<uint32_t>(file);
+        l.column = static_cast<uint32_t>(bits >> 3);
+        l.is_stmt = (bits >> 2) & 1;
+        l.basic_block = (bits >> 1) & 1;
+        l.end_sequence = bits & 1;
+    }
+    return true;
+}
+
+template <typename T>
+void write_groups(Writer& w, const std::unordered_map<uint64_t, std::vector<T>>& groups) {
+    w(static_cast<uint64_t>(groups.size()));
+    for (const auto& g : groups) {
+        w(g.first);
+        write_vector(w, g.second);
+    }
+}
+
+template <typename T>
+bool read_groups(Reader& r, std::unordered_map<uint64_t, std::vector<T>>& groups) {
+    uint64_t n = 0;
+    if (!r.count(n, 2 * sizeof(uint64_t))) return false;  // Key offset and row count
+    groups.reserve(static_cast<size_t>(n));
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t key = 0;
+        r(key);
+        if (!read_vector(r, groups[key])) return false;
+    }
+    return true;
+}
+
+void write_locations(Writer& w, const std::unordered_map<uint64_t, InternedString>& locations) {
+    w(static_cast<uint64_t>(locations.size()));
+    for (const auto& l : locations) {
+        w(l.first);
+        w(l.second);
+    }
+}
+
+bool read_locations(Reader& r, std::unordered_map<uint64_t, InternedString>& locations) {
+    uint64_t n = 0;
+    if (!r.count(n, sizeof(uint64_t) + sizeof(uint32_t))) return false;  // Offset and string length
+    locations.reserve(static_cast<size_t>(n));
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t offset = 0;
+        r(offset);
+        r(locations[offset]);
+        if (r.failed()) return false;
+    }
+    return true;
+}
+
+void write_key(Writer& w, const IndexFileKey& key) {
+    w(key.build_id);
+    w(key.file_size);
+    w(key.mtime);
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool read_index_key(const std::string& binary_path, IndexFileKey& key) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(binary_path, ec);
+    if (ec) return false;
+    auto mtime = std::filesystem::last_write_time(binary_path, ec);
+    if (ec) return false;
+
+    key.file_size = static_cast<uint64_t>(size);
+    key.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+
+    MappedFile file;
+    if (!file.map(binary_path)) return false;
+    key.build_id.clear();
+    if (file.size() >= 4 && std::memcmp(file.data(), "\x7f" "ELF", 4) == 0) {
+        key.build_id = elf_build_id(file.data(), file.size());
+    } else {
+        key.build_id = macho_uuid(file.data(), file.size());
+    }
+    return true;
+}
+
+std::string default_index_path(const std::string& binary_path) {
+    return binary_path + ".dwarfsql-idx";
+}
+
+bool write_index_file(const std::string& path, const IndexFileKey& key,
+                      const DwarfIndex& index, const IndexDetails& details,
+                      const StringTable& files, std::string& error) {
+    Writer w;
+    w.bytes(MAGIC, sizeof(MAGIC));
+    w(FORMAT_VERSION);
+    w(BYTE_ORDER_MARK);
+    write_key(w, key);
+    w(index.shared_sections_hash);
+
+    write_vector(w, index.compilation_units);
+    write_vector(w, index.functions);
+    write_vector(w, index.variables);
+    write_vector(w, index.types);
+    write_vector(w, index.structs);
+    write_vector(w, index.enums);
+    write_vector(w, index.parameters);
+    write_vector(w, index.local_variables);
+    write_vector(w, index.base_classes);
+    write_vector(w, index.calls);
+    write_vector(w, index.inlined_calls);
+    write_vector(w, index.namespaces);
+
+    write_groups(w, index.struct_members);
+    write_groups(w, index.enum_values);
+    write_groups(w, index.address_ranges);
+    write_lines(w, details.lines, files);
+    w(static_cast<uint64_t>(details.line_ranges.size()));
+    for (const auto& range : details.line_ranges) {
+        w(range.cu_offset);
+        w(static_cast<uint64_t>(range.begin));
+        w(static_cast<uint64_t>(range.end));
+    }
+    write_locations(w, details.locations);
+
+    // Write next to the target and rename, so readers never see a partial file
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "Cannot create index file: " + tmp;
+            return false;
+        }
+        out.write(w.buffer().data(), static_cast<std::streamsize>(w.buffer().size()));
+        if (!out) {
+            error = "Failed to write index file: " + tmp;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        error = "Failed to replace index file: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool read_index_file(const std::string& path, const IndexFileKey& expected,
+                     DwarfIndex& index, IndexDetails& details, StringPool& strings,
+                     std::vector<InternedString>& files, std::string& error) {
+    MappedFile file;
+    if (!file.map(path)) {
+        error = "Cannot open index file: " + path;
+        return false;
+    }
+
+    StringPool loaded_strings;
+    Reader r(file.data(), file.size(), &loaded_strings);
+    char magic[sizeof(MAGIC)] = {};
+    uint32_t version = 0;
+    uint32_t bom = 0;
+    r.bytes(magic, sizeof(magic));
+    r(version);
+    r(bom);
+    if (r.failed() || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "Not a dwarfsql index file: " + path;
+        return false;
+    }
+    if (version != FORMAT_VERSION || bom != BYTE_ORDER_MARK) {
+        error = "Unsupported index file version: " + path;
+        return false;
+    }
+
+    IndexFileKey key;
+    r(key.build_id);
+    r(key.file_size);
+    r(key.mtime);
+    if (r.failed() || key != expected) {
+        error = "Index file is stale: " + path;
+        return false;
+    }
+
+    DwarfIndex loaded;
+    IndexDetails loaded_details;
+    std::vector<InternedString> loaded_files;
+    r(loaded.shared_sections_hash);
+    bool ok = !r.failed()
+           && read_vector(r, loaded.compilation_units)
+           && read_vector(r, loaded.functions)
+           && read_vector(r, loaded.variables)
+           && read_vector(r, loaded.types)
+           && read_vector(r, loaded.structs)
+           && read_vector(r, loaded.enums)
+           && read_vector(r, loaded.parameters)
+           && read_vector(r, loaded.local_variables)
+           && read_vector(r, loaded.base_classes)
+           && read_vector(r, loaded.calls)
+           && read_vector(r, loaded.inlined_calls)
+           && read_vector(r, loaded.namespaces)
+           && read_groups(r, loaded.struct_members)
+           && read_groups(r, loaded.enum_values)
+           && read_groups(r, loaded.address_ranges)
+           && read_lines(r, loaded_details.lines, loaded_files);
+
+    uint64_t range_count = 0;
+    if (ok) ok = r.count(range_count, 3 * sizeof(uint64_t));
+    for (uint64_t i = 0; ok && i < range_count; ++i) {
+        uint64_t cu_offset = 0, begin = 0, end = 0;
+        r(cu_offset);
+        r(begin);
+        r(end);
+        ok = !r.failed() && begin <= end && end <= loaded_details.lines.size();
+        if (ok) {
+            loaded_details.line_ranges.push_back({cu_offset, static_cast<size_t>(begin), static_cast<size_t>(end)});
+        }
+    }
+
+    if (ok) ok = read_locations(r, loaded_details.locations);
+
+    if (!ok || r.remaining() != 0) {
+        error = "Index file is corrupt: " + path;
+        return false;
+    }
+
+    index = std::move(loaded);
+    details = std::move(loaded_details);
+    files = std::move(loaded_files);
+    strings.adopt(std::move(loaded_strings));
+    return true;
+}
+
+} // namespace dwarfsql
@@ -0,0 +1,374 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * name_index.cpp - Name predicates and accelerator table readers
+ */
+
+#include <dwarfsql/name_index.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace dwarfsql {
+
+namespace {
+
+char fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Bounds-checked reads in the object's byte order
+struct Reader {
+    const uint8_t* data;
+    uint64_t size;
+    bool little;
+    uint64_t pos = 0;
+    bool ok = true;
+
+    uint64_t fixed(unsigned bytes) {
+        if (!ok || size - pos < bytes || pos > size) {
+            ok = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (unsigned i = 0; i < bytes; ++i) {
+            uint64_t b = data[pos + i];
+            v |= little ? b << (8 * i) : b << (8 * (bytes - 1 - i));
+        }
+        pos += bytes;
+        return v;
+    }
+
+    uint64_t uleb() {
+        uint64_t v = 0;
+        for (unsigned shift = 0; ok; shift += 7) {
+            if (pos >= size || shift > 63) {
+                ok = false;
+                break;
+            }
+            uint8_t b = data[pos++];
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) break;
+        }
+        return v;
+    }
+
+    void skip(uint64_t bytes) {
+        if (!ok || size - pos < bytes || pos > size) {
+            ok = false;
+        } else {
+            pos += bytes;
+        }
+    }
+};
+
+// DWARF constants, spelled out so this file needs no libdwarf headers
+constexpr uint64_t DW_IDX_compile_unit = 1;
+constexpr uint64_t DW_IDX_type_unit = 2;
+
+uint8_t kind_of_tag(uint64_t tag) {
+    switch (tag) {
+        case 0x2e: case 0x1d: return static_cast<uint8_t>(NameKind::Function);  // subprogram, inlined_subroutine
+        case 0x34: return static_cast<uint8_t>(NameKind::Variable);
+        case 0x13: case 0x02: case 0x17: return static_cast<uint8_t>(NameKind::Struct);  // structure, class, union
+        case 0x24: case 0x16:                       // base_type, typedef
+        case 0x0f: case 0x10: case 0x42:            // pointer, reference, rvalue_reference
+        case 0x26: case 0x35: case 0x01:            // const, volatile, array
+            return static_cast<uint8_t>(NameKind::Type);
+        default: return 0;
+    }
+}
+
+// Reads one attribute value of a .debug_names entry; false for an unknown form
+bool read_form(Reader& r, uint64_t form, unsigned offset_size, uint64_t& value) {
+    switch (form) {
+        case 0x0b: case 0x11: case 0x0c: value = r.fixed(1); return true;  // data1, ref1, flag
+        case 0x05: case 0x12: value = r.fixed(2); return true;             // data2, ref2
+        case 0x06: case 0x13: value = r.fixed(4); return true;             // data4, ref4
+        case 0x07: case 0x14: case 0x20: value = r.fixed(8); return true;  // data8, ref8, ref_sig8
+        case 0x0f: case 0x15: value = r.uleb(); return true;               // udata, ref_udata
+        case 0x0d: value = r.uleb(); return true;                          // sdata (value unused)
+        case 0x19: value = 1; return true;                                 // flag_present
+        case 0x17: value = r.fixed(offset_size); return true;              // sec_offset
+        case 0x1e: r.skip(16); value = 0; return true;                     // data16
+        default: return false;
+    }
+}
+
+// "ns::Class<a::b>::method" -> "method": .gdb_index names are qualified,
+// DW_AT_name is not
+std::string_view unqualified(std::string_view name) {
+    int depth = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < name.size(); ++i) {
+        char c = name[i];
+        if (c == '<' || c == '(') ++depth;
+        else if ((c == '>' || c == ')') && depth > 0) --depth;
+        else if (c == ':' && depth == 0 && i + 1 < name.size() && name[i + 1] == ':') {
+            start = i + 2;
+            ++i;
+        }
+    }
+    return name.substr(start);
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// NameKey
+// ============================================================================
+
+bool folded_less(std::string_view a, std::string_view b) {
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char x = static_cast<unsigned char>(fold(a[i]));
+        unsigned char y = static_cast<unsigned char>(fold(b[i]));
+        if (x != y) return x < y;
+    }
+    return a.size() < b.size();
+}
+
+bool folded_starts_with(std::string_view name, std::string_view prefix) {
+    if (name.size() < prefix.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (fold(name[i]) != fold(prefix[i])) return false;
+    }
+    return true;
+}
+
+std::string fold_name(std::string_view name) {
+    std::string out(name);
+    for (char& c : out) c = fold(c);
+    return out;
+}
+
+bool NameKey::matches(std::string_view name) const {
+    if (!prefix) {
+        return nocase ? name.size() == text.size() && folded_starts_with(name, text) : name == text;
+    }
+    if (nocase) return folded_starts_with(name, text);
+    return name.size() >= text.size() && name.compare(0, text.size(), text) == 0;
+}
+
+bool NameKey::from_pattern(std::string_view pattern, bool like, NameKey& key) {
+    const char* wild = like ? "%_" : "*?[";
+    size_t end = pattern.find_first_of(wild);
+    if (end == 0) return false;
+
+    key.text = std::string(pattern.substr(0, end == std::string_view::npos ? pattern.size() : end));
+    key.nocase = like;
+    // A LIKE without wildcards still folds case, so it is looked up as a prefix
+    key.prefix = like || end != std::string_view::npos;
+    return true;
+}
+
+// ============================================================================
+// NameIndex
+// ============================================================================
+
+bool NameIndex::load_debug_names(const uint8_t* data, uint64_t size, bool little_endian,
+                                 const uint8_t* str, uint64_t str_size) {
+    units_.clear();
+    entries_.clear();
+    std::unordered_map<uint64_t, uint32_t> unit_numbers;
+    bool type_units = false;
+
+    Reader r{data, size, little_endian};
+    while (r.ok && r.pos < size) {
+        // Header (DWARF 5, 6.1.1.4.1)
+        uint64_t length = r.fixed(4);
+        unsigned offset_size = 4;
+        if (length == 0xffffffff) {
+            length = r.fixed(8);
+            offset_size = 8;
+        }
+        if (!r.ok || length > size - r.pos) return false;
+        uint64_t end = r.pos + length;
+
+        uint64_t version = r.fixed(2);
+        r.fixed(2);  // Padding
+        uint64_t cu_count = r.fixed(4);
+        uint64_t local_tu_count = r.fixed(4);
+        uint64_t foreign_tu_count = r.fixed(4);
+        uint64_t bucket_count = r.fixed(4);
+        uint64_t name_count = r.fixed(4);
+        uint64_t abbrev_size = r.fixed(4);
+        uint64_t augmentation_size = r.fixed(4);
+        r.skip(augmentation_size);
+        if (!r.ok || version != 5) return false;
+        if (local_tu_count + foreign_tu_count > 0) type_units = true;
+
+        std::vector<uint32_t> cus;
+        for (uint64_t i = 0; i < cu_count && r.ok; ++i) {
+            uint64_t offset = r.fixed(offset_size);
+            auto it = unit_numbers.emplace(offset, static_cast<uint32_t>(units_.size())).first;
+            if (it->second == units_.size()) units_.push_back(offset);
+            cus.push_back(it->second);
+        }
+        r.skip(local_tu_count * offset_size + foreign_tu_count * 8);
+        r.skip(bucket_count * 4 + (bucket_count > 0 ? name_count * 4 : 0));
+
+        uint64_t names_at = r.pos;
+        uint64_t entries_at = names_at + name_count * offset_size;
+        uint64_t abbrevs_at = entries_at + name_count * offset_size;
+        uint64_t pool_at = abbrevs_at + abbrev_size;
+        if (!r.ok || pool_at > end) return false;
+
+        // Abbreviations: code, tag, then (DW_IDX_*, form) pairs up to (0, 0)
+        struct Abbrev {
+            uint64_t tag;
+            std::vector<std::pair<uint64_t, uint64_t>> attrs;
+        };
+        std::unordered_map<uint64_t, Abbrev> abbrevs;
+        Reader a{data, abbrevs_at + abbrev_size, little_endian, abbrevs_at};
+        for (uint64_t code = a.uleb(); a.ok && code != 0; code = a.uleb()) {
+            Abbrev& abbrev = abbrevs[code];
+            abbrev.tag = a.uleb();
+            for (uint64_t idx = a.uleb(), form = a.uleb(); a.ok && (idx != 0 || form != 0);
+                 idx = a.uleb(), form = a.uleb()) {
+                abbrev.attrs.push_back({idx, form});
+            }
+        }
+        if (!a.ok) return false;
+
+        Reader names{data, entries_at, little_endian, names_at};
+        Reader offsets{data, abbrevs_at, little_endian, entries_at};
+        for (uint64_t n = 0; n < name_count; ++n) {
+            uint64_t str_offset = names.fixed(offset_size);
+            uint64_t entry_offset = offsets.fixed(offset_size);
+            if (!names.ok || !offsets.ok || str_offset >= str_size) return false;
+            const char* text = reinterpret_cast<const char*>(str + str_offset);
+            std::string_view name(text, strnlen(text, str_size - str_offset));
+
+            // Collect the kinds per unit over the name's entry list
+            std::vector<std::pair<uint32_t, uint8_t>> found;
+            Reader e{data, end, little_endian, pool_at + entry_offset};
+            for (uint64_t code = e.uleb(); e.ok && code != 0; code = e.uleb()) {
+                auto abbrev = abbrevs.find(code);
+                if (abbrev == abbrevs.end()) return false;
+
+                uint64_t cu = 0;
+                bool in_type_unit = false;
+                for (const auto& [idx, form] : abbrev->second.attrs) {
+                    uint64_t value = 0;
+                    if (!read_form(e, form, offset_size, value)) return false;
+                    if (idx == DW_IDX_compile_unit) cu = value;
+                    if (idx == DW_IDX_type_unit) in_type_unit = true;
+                }
+                uint8_t kind = kind_of_tag(abbrev->second.tag);
+                if (in_type_unit || kind == 0 || cu >= cus.size()) continue;
+                found.push_back({cus[cu], kind});
+            }
+            if (!e.ok) return false;
+
+            for (const auto& [unit, kind] : found) {
+                entries_.push_back({name, unit, kind});
+            }
+        }
+        r.pos = end;
+    }
+    if (!r.ok) return false;
+
+    // Type units key their types by signature; those rows stay with the walk
+    covered_ = static_cast<uint8_t>(NameKind::Function) | static_cast<uint8_t>(NameKind::Variable);
+    if (!type_units) {
+        covered_ |= static_cast<uint8_t>(NameKind::Struct) | static_cast<uint8_t>(NameKind::Type);
+    }
+    source_ = ".debug_names";
+    finish();
+    return true;
+}
+
+bool NameIndex::load_gdb_index(const uint8_t* data, uint64_t size) {
+    units_.clear();
+    entries_.clear();
+
+    // Header: version, then section-relative offsets of each area
+    Reader r{data, size, true};
+    uint64_t version = r.fixed(4);
+    if (!r.ok || version < 7 || version > 9) return false;
+    uint64_t cu_list = r.fixed(4);
+    uint64_t types_list = r.fixed(4);
+    r.fixed(4);  // Address area
+    uint64_t symbols = r.fixed(4);
+    if (version >= 9) r.fixed(4);  // Shortcut table
+    uint64_t pool = r.fixed(4);
+    if (!r.ok || cu_list > types_list || symbols > pool || pool > size) return false;
+
+    Reader cus{data, types_list, true, cu_list};
+    while (cus.ok && cus.pos < types_list) {
+        units_.push_back(cus.fixed(8));
+        cus.fixed(8);  // Length
+    }
+    if (!cus.ok) return false;
+
+    // Symbol table: (name, CU vector) offsets into the constant pool; (0, 0) is an empty slot
+    Reader slots{data, pool, true, symbols};
+    while (slots.ok && slots.pos < pool) {
+        uint64_t name_offset = slots.fixed(4);
+        uint64_t vector_offset = slots.fixed(4);
+        if (!slots.ok) return false;
+        if (name_offset == 0 && vector_offset == 0) continue;
+        if (name_offset >= size - pool) return false;
+
+        const char* text = reinterpret_cast<const char*>(data + pool + name_offset);
+        std::string_view name = unqualified(std::string_view(text, strnlen(text, size - pool - name_offset)));
+
+        Reader vec{data, size, true, pool + vector_offset};
+        uint64_t count = vec.fixed(4);
+        for (uint64_t i = 0; i < count && vec.ok; ++i) {
+            uint64_t value = vec.fixed(4);
+            uint64_t unit = value & 0xffffff;
+            uint64_t kind = (value >> 28) & 7;
+            if (unit >= units_.size()) continue;  // A type unit
+            uint8_t kinds = 0;
+            switch (kind) {
+                case 1: kinds = static_cast<uint8_t>(NameKind::Struct) | static_cast<uint8_t>(NameKind::Type); break;
+                case 2: kinds = static_cast<uint8_t>(NameKind::Variable); break;
+                case 3: kinds = static_cast<uint8_t>(NameKind::Function); break;
+                case 0: kinds = 0xff; break;  // Kind not recorded
+                default: break;
+            }
+            if (kinds != 0) entries_.push_back({name, static_cast<uint32_t>(unit), kinds});
+        }
+        if (!vec.ok) return false;
+    }
+
+    covered_ = static_cast<uint8_t>(NameKind::Function) | static_cast<uint8_t>(NameKind::Variable) |
+               static_cast<uint8_t>(NameKind::Struct);
+    source_ = ".gdb_index";
+    finish();
+    return true;
+}
+
+void NameIndex::finish() {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const Entry& a, const Entry& b) { return folded_less(a.name, b.name); });
+    entries_.shrink_to_fit();
+}
+
+std::vector<uint64_t> NameIndex::units(const NameKey& key, NameKind kind) const {
+    auto first = std::lower_bound(entries_.begin(), entries_.end(), key.text,
+                                  [](const Entry& e, const std::string& text) { return folded_less(e.name, text); });
+
+    // Names folding to the same prefix (or name) are contiguous from first
+    auto in_range = [&key](std::string_view name) {
+        return folded_starts_with(name, key.text) && (key.prefix || name.size() == key.text.size());
+    };
+    std::vector<uint64_t> result;
+    for (auto it = first; it != entries_.end() && in_range(it->name); ++it) {
+        if ((it->kinds & static_cast<uint8_t>(kind)) && key.matches(it->name)) {
+            result.push_back(units_[it->unit]);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+} // namespace dwarfsql
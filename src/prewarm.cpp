@@ -0,0 +1,135 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * prewarm.cpp - Background index walks and table cache builds
+ */
+
+#include <dwarfsql/prewarm.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+
+namespace dwarfsql {
+
+Prewarmer::Prewarmer(SessionSet& sessions, const std::vector<TableDef>& tables,
+                     const std::vector<std::string>& names, int threads, Runner run)
+    : run_(std::move(run)), start_(std::chrono::steady_clock::now()) {
+    auto wanted = [&](const std::string& table) {
+        return names.empty() || std::find(names.begin(), names.end(), table) != names.end();
+    };
+    bool several = sessions.size() > 1;
+
+    for (size_t m = 0; m < sessions.size(); ++m) {
+        std::string prefix = several ? sessions[m].name + ":" : std::string();
+        DwarfSession* session = sessions[m].session.get();
+
+        // The index first: nearly every table's cache is a view of it
+        std::vector<Step> steps;
+        steps.push_back({prefix + "index", [session] { session->index(); }, nullptr});
+        for (const auto& def : tables) {
+            if (!wanted(def.name)) continue;
+            const TableDef& part = def.parts.empty() ? def : def.parts[m];
+            if (!part.prewarm) continue;
+            steps.push_back({prefix + def.name, part.prewarm, part.warm});
+        }
+        total_ += steps.size();
+        modules_.push_back(std::move(steps));
+    }
+
+    size_t count = threads > 0 ? static_cast<size_t>(threads)
+                               : std::max(1u, std::thread::hardware_concurrency());
+    count = std::min(count, modules_.size());
+    for (size_t i = 0; i < count; ++i) {
+        threads_.emplace_back([this] { worker(); });
+    }
+}
+
+Prewarmer::~Prewarmer() {
+    stopping_ = true;
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void Prewarmer::worker() {
+    for (size_t m = next_module_++; m < modules_.size() && !stopping_; m = next_module_++) {
+        for (const Step& step : modules_[m]) {
+            if (stopping_) return;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                building_.push_back(step.label);
+            }
+            std::string error;
+            try {
+                if (run_) {
+                    run_(step.fn);
+                } else {
+                    step.fn();
+                }
+            } catch (const std::exception& e) {
+                error = step.label + ": " + e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            building_.erase(std::find(building_.begin(), building_.end(), step.label));
+            if (!error.empty()) errors_.push_back(error);
+            if (++done_ == total_) finished_ns_ = elapsed_ns(start_);
+        }
+    }
+}
+
+Prewarmer::Progress Prewarmer::progress() const {
+    Progress p;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        p.total = total_;
+        p.done = done_;
+        p.building = building_;
+        p.errors = errors_;
+        p.finished = done_ == total_;
+        p.elapsed_ns = p.finished ? finished_ns_ : elapsed_ns(start_);
+    }
+    for (const auto& steps : modules_) {
+        for (const Step& step : steps) {
+            if (step.warm && step.warm()) p.warm.push_back(step.label);
+        }
+    }
+    return p;
+}
+
+std::vector<std::string> Prewarmer::unknown_tables(const std::vector<TableDef>& tables,
+                                                   const std::vector<std::string>& names) {
+    std::vector<std::string> unknown;
+    for (const auto& name : names) {
+        bool found = std::any_of(tables.begin(), tables.end(),
+                                 [&](const TableDef& def) { return def.name == name; });
+        if (!found) unknown.push_back(name);
+    }
+    return unknown;
+}
+
+std::string format_prewarm(const Prewarmer::Progress& progress) {
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "Prewarm: %s, %zu/%zu steps in %.2f s",
+                  progress.finished ? "done" : "running", progress.done, progress.total,
+                  progress.elapsed_ns / 1e9);
+    std::string text = buf;
+    if (!progress.building.empty()) {
+        text += " (building ";
+        for (size_t i = 0; i < progress.building.size(); ++i) {
+            text += (i > 0 ? ", " : "") + progress.building[i];
+        }
+        text += ")";
+    }
+    for (const auto& error : progress.errors) {
+        text += "\n  Error: " + error;
+    }
+    return text;
+}
+
+} // namespace dwarfsql
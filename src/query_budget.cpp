@@ -0,0 +1,90 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * query_budget.cpp - Query time and row limits, and cancellation
+ */
+
+#include <dwarfsql/query_budget.hpp>
+
+namespace dwarfsql {
+
+namespace {
+
+thread_local QueryBudget* t_budget = nullptr;
+
+// Virtual machine instructions between checks of the budget
+constexpr int PROGRESS_OPS = 1000;
+
+int progress_check(void* budget) {
+    return static_cast<QueryBudget*>(budget)->spent() ? 1 : 0;
+}
+
+int count_row(unsigned int, void* budget, void* stmt, void*) {
+    // The row past the limit is still returned; the next step is interrupted
+    if (!static_cast<QueryBudget*>(budget)->add_row()) {
+        sqlite3_interrupt(sqlite3_db_handle(static_cast<sqlite3_stmt*>(stmt)));
+    }
+    return 0;
+}
+
+} // namespace
+
+QueryBudget::QueryBudget(const QueryLimits& limits)
+    : limits_(limits),
+      deadline_(std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.max_ms)) {}
+
+bool QueryBudget::add_row() {
+    uint64_t rows = rows_.fetch_add(1, std::memory_order_relaxed) + 1;
+    return limits_.max_rows == 0 || rows <= limits_.max_rows;
+}
+
+bool QueryBudget::spent() const {
+    if (cancelled_.load(std::memory_order_relaxed) || expired_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (limits_.max_rows > 0 && rows_.load(std::memory_order_relaxed) > limits_.max_rows) {
+        return true;
+    }
+    if (limits_.max_ms > 0 && std::chrono::steady_clock::now() >= deadline_) {
+        expired_.store(true, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+std::string QueryBudget::reason() const {
+    if (!spent()) return "";
+    if (cancelled_.load(std::memory_order_relaxed)) return "query cancelled";
+    if (expired_.load(std::memory_order_relaxed)) {
+        return "query stopped after " + std::to_string(limits_.max_ms) + " ms (time limit)";
+    }
+    return "query stopped after " + std::to_string(limits_.max_rows) + " rows (row limit)";
+}
+
+QueryBudget* QueryBudget::current() {
+    return t_budget;
+}
+
+QueryScope::QueryScope(QueryBudget* budget, sqlite3* db) : previous_(t_budget), db_(db) {
+    t_budget = budget;
+    if (db_ && budget) {
+        sqlite3_progress_handler(db_, PROGRESS_OPS, progress_check, budget);
+        sqlite3_trace_v2(db_, SQLITE_TRACE_ROW, count_row, budget);
+    } else {
+        db_ = nullptr;
+    }
+}
+
+QueryScope::~QueryScope() {
+    if (db_) {
+        sqlite3_progress_handler(db_, 0, nullptr, nullptr);
+        sqlite3_trace_v2(db_, 0, nullptr, nullptr);
+    }
+    t_budget = previous_;
+}
+
+} // namespace dwarfsql
@@ -0,0 +1,93 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * session_set.cpp - Opening several binaries at once
+ */
+
+#include <dwarfsql/session_set.hpp>
+#include <dwarfsql/index_file.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+namespace dwarfsql {
+
+namespace {
+
+std::string file_name(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+} // anonymous namespace
+
+bool SessionSet::open(const std::vector<std::string>& paths, int jobs,
+                      const std::function<void(DwarfSession&)>& prepare) {
+    modules_.clear();
+    errors_.clear();
+
+    if (jobs <= 0) {
+        jobs = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    size_t thread_count = std::min(static_cast<size_t>(std::max(jobs, 1)), paths.size());
+
+    // Each worker opens whole binaries; a lone binary gets the threads for its own index
+    std::vector<std::unique_ptr<DwarfSession>> sessions(paths.size());
+    std::vector<std::string> errors(paths.size());
+    std::atomic<size_t> next{0};
+
+    auto worker = [&] {
+        size_t i;
+        while ((i = next.fetch_add(1)) < paths.size()) {
+            auto session = std::make_unique<DwarfSession>();
+            if (!session->open(paths[i])) {
+                errors[i] = paths[i] + ": " + session->last_error();
+                continue;
+            }
+            session->set_jobs(paths.size() == 1 ? jobs : 1);
+            if (prepare) prepare(*session);
+            sessions[i] = std::move(session);
+        }
+    };
+
+    if (thread_count <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back(worker);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    std::unordered_map<std::string, size_t> name_count;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (sessions[i]) ++name_count[file_name(paths[i])];
+    }
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!sessions[i]) {
+            errors_.push_back(std::move(errors[i]));
+            continue;
+        }
+        std::string name = file_name(paths[i]);
+        modules_.push_back({name_count[name] > 1 ? paths[i] : name, std::move(sessions[i])});
+    }
+    return !modules_.empty();
+}
+
+const SessionSet::Module* SessionSet::find(const std::string& name) const {
+    for (const auto& module : modules_) {
+        if (module.name == name) return &module;
+    }
+    return nullptr;
+}
+
+} // namespace dwarfsql
@@ -0,0 +1,155 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * statement_cache.cpp - Prepared statements reused by normalized SQL
+ */
+
+#include <dwarfsql/statement_cache.hpp>
+
+#include <cctype>
+
+namespace dwarfsql {
+
+std::string normalize_sql(std::string_view sql) {
+    std::string out;
+    out.reserve(sql.size());
+    bool space = false;  // Whitespace or a comment since the last character kept
+
+    size_t i = 0;
+    while (i < sql.size()) {
+        char c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            space = true;
+            ++i;
+            continue;
+        }
+        if (c == '-' && i + 1 < sql.size() && sql[i + 1] == '-') {
+            size_t end = sql.find('\n', i);
+            i = end == std::string_view::npos ? sql.size() : end;
+            space = true;
+            continue;
+        }
+        if (c == '/' && i + 1 < sql.size() && sql[i + 1] == '*') {
+            size_t end = sql.find("*/", i + 2);
+            i = end == std::string_view::npos ? sql.size() : end + 2;
+            space = true;
+            continue;
+        }
+
+        if (space && !out.empty()) out += ' ';
+        space = false;
+
+        // Literals and quoted names are kept byte for byte; a doubled quote escapes itself
+        char close = c == '\'' || c == '"' || c == '`' ? c : c == '[' ? ']' : 0;
+        if (!close) {
+            out += c;
+            ++i;
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < sql.size()) {
+            if (sql[end] == close) {
+                if (close != ']' && end + 1 < sql.size() && sql[end + 1] == close) {
+                    end += 2;
+                    continue;
+                }
+                break;
+            }
+            ++end;
+        }
+        end = end < sql.size() ? end + 1 : end;
+        out.append(sql.substr(i, end - i));
+        i = end;
+    }
+
+    while (!out.empty() && (out.back() == ';' || out.back() == ' ')) {
+        out.pop_back();
+    }
+    return out;
+}
+
+// ============================================================================
+// StatementCache
+// ============================================================================
+
+StatementCache::StatementCache(sqlite3* db, size_t capacity)
+    : db_(db), capacity_(capacity > 0 ? capacity : 1) {}
+
+StatementCache::~StatementCache() {
+    for (auto& entry : entries_) {
+        sqlite3_finalize(entry.stmt);
+    }
+}
+
+StatementCache::Statement::Statement(Statement&& other) noexcept
+    : stmt_(other.stmt_), entry_(other.entry_), reused_(other.reused_)
+{
+    other.stmt_ = nullptr;
+    other.entry_ = nullptr;
+}
+
+StatementCache::Statement::~Statement() {
+    if (!stmt_) return;
+    if (!entry_) {
+        sqlite3_finalize(stmt_);
+        return;
+    }
+    sqlite3_reset(stmt_);
+    sqlite3_clear_bindings(stmt_);
+    entry_->in_use = false;
+}
+
+StatementCache::Statement StatementCache::prepare(std::string_view sql, std::string& error) {
+    std::string key = normalize_sql(sql);
+
+    auto found = by_key_.find(key);
+    if (found != by_key_.end() && !found->second->in_use) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+        Entry& entry = entries_.front();
+        entry.in_use = true;
+        return Statement(entry.stmt, &entry, true);
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    const char* tail = nullptr;
+    if (sqlite3_prepare_v3(db_, key.c_str(), static_cast<int>(key.size()), SQLITE_PREPARE_PERSISTENT,
+                           &stmt, &tail) != SQLITE_OK) {
+        error = sqlite3_errmsg(db_);
+        return Statement();
+    }
+    // The key has no trailing semicolons, so anything left is a second statement
+    if (!stmt || (tail && *tail)) {
+        sqlite3_finalize(stmt);
+        return Statement();
+    }
+
+    // The same shape already checked out (a statement run from inside another):
+    // this copy is used once and not kept
+    if (found != by_key_.end()) {
+        return Statement(stmt, nullptr, false);
+    }
+
+    entries_.push_front(Entry{std::move(key), stmt});
+    Entry& entry = entries_.front();
+    by_key_.emplace(entry.key, entries_.begin());
+    entry.in_use = true;
+    evict();
+    return Statement(stmt, &entry, false);
+}
+
+void StatementCache::evict() {
+    auto it = entries_.end();
+    while (entries_.size() > capacity_ && it != entries_.begin()) {
+        --it;
+        if (it->in_use) continue;
+        by_key_.erase(it->key);
+        sqlite3_finalize(it->stmt);
+        it = entries_.erase(it);
+    }
+}
+
+} // namespace dwarfsql
@@ -0,0 +1,281 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * stats.cpp - Query latencies and the .stats / metrics reports
+ */
+
+#include <dwarfsql/stats.hpp>
+#include <dwarfsql/dwarf_vtable.hpp>
+#include <dwarfsql/session_set.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <sstream>
+
+namespace dwarfsql {
+
+// ============================================================================
+// QueryStats
+// ============================================================================
+
+void QueryStats::record(uint64_t total_ns, uint64_t decode_ns, bool ok) {
+    count_.fetch_add(1, std::memory_order_relaxed);
+    if (!ok) errors_.fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(total_ns, std::memory_order_relaxed);
+    decode_ns_.fetch_add(decode_ns, std::memory_order_relaxed);
+    last_ns_.store(total_ns, std::memory_order_relaxed);
+    last_decode_ns_.store(decode_ns, std::memory_order_relaxed);
+
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (total_ns > max && !max_ns_.compare_exchange_weak(max, total_ns, std::memory_order_relaxed)) {
+    }
+
+    double seconds = total_ns / 1e9;
+    for (size_t i = 0; i < BUCKETS.size(); ++i) {
+        if (seconds <= BUCKETS[i]) {
+            buckets_[i].fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+}
+
+std::array<uint64_t, QueryStats::BUCKETS.size() + 1> QueryStats::histogram() const {
+    // Buckets are stored disjoint; Prometheus wants them cumulative
+    std::array<uint64_t, BUCKETS.size() + 1> result{};
+    uint64_t running = 0;
+    for (size_t i = 0; i < BUCKETS.size(); ++i) {
+        running += buckets_[i].load(std::memory_order_relaxed);
+        result[i] = running;
+    }
+    result[BUCKETS.size()] = count();
+    return result;
+}
+
+// ============================================================================
+// Reports
+// ============================================================================
+
+namespace {
+
+struct TableEntry {
+    std::string module;
+    std::string table;
+    const TableStats* stats;
+};
+
+// One entry per table and module, in registration order
+std::vector<TableEntry> table_entries(const SessionSet& sessions, const std::vector<TableDef>& tables) {
+    std::vector<TableEntry> entries;
+    std::string single = sessions.size() == 1 ? sessions[0].name : std::string();
+    for (const auto& def : tables) {
+        if (!def.parts.empty()) {
+            for (size_t i = 0; i < def.parts.size(); ++i) {
+                if (def.parts[i].stats) {
+                    entries.push_back({def.modules[i], def.name, def.parts[i].stats.get()});
+                }
+            }
+        } else if (def.stats) {
+            entries.push_back({single, def.name, def.stats.get()});
+        }
+    }
+    return entries;
+}
+
+std::string format_ms(uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.2f ms", ns / 1e6);
+    return buf;
+}
+
+std::string format_number(double value, const char* format) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), format, value);
+    return buf;
+}
+
+std::string pad(const std::string& text, size_t width, bool left = false) {
+    if (text.size() >= width) return text;
+    std::string fill(width - text.size(), ' ');
+    return left ? text + fill : fill + text;
+}
+
+// Sample value: counts as integers, everything else to nine significant digits
+std::string metric_value(double value) {
+    if (value == std::floor(value) && std::fabs(value) < 1e15) {
+        return std::to_string(static_cast<int64_t>(value));
+    }
+    return format_number(value, "%.9g");
+}
+
+// Label value escaping of the text exposition format
+std::string label_value(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+std::string format_stats(const SessionSet& sessions, const std::vector<TableDef>& tables,
+                         const QueryStats& queries) {
+    std::ostringstream out;
+
+    uint64_t count = queries.count();
+    out << "Queries: " << count;
+    if (queries.errors() > 0) out << " (" << queries.errors() << " failed)";
+    if (queries.stopped() > 0) out << " (" << queries.stopped() << " stopped early)";
+    if (count > 0) {
+        uint64_t total = queries.total_ns();
+        uint64_t decode = std::min(queries.decode_ns(), total);
+        out << ", " << format_ms(total) << " total (tables " << format_ms(decode)
+            << ", SQLite " << format_ms(total - decode) << "), mean " << format_ms(total / count)
+            << ", max " << format_ms(queries.max_ns()) << "\n";
+        uint64_t last = queries.last_ns();
+        uint64_t last_decode = std::min(queries.last_decode_ns(), last);
+        out << "Last query: " << format_ms(last) << " (tables " << format_ms(last_decode)
+            << ", SQLite " << format_ms(last - last_decode) << ")";
+    }
+    out << "\n";
+    uint64_t reused = queries.statements_reused();
+    uint64_t prepared = queries.statements_prepared();
+    if (reused + prepared > 0) {
+        out << "Prepared statements: " << reused << " reused, " << prepared << " compiled\n";
+    }
+
+    auto entries = table_entries(sessions, tables);
+    const char* headers[] = {"scans", "builds", "build_ms", "rows", "bytes", "lookups",
+                             "lookup_ms", "dies", "offdie", "type_hit", "lines_ms"};
+    std::string current_module;
+    bool any = false;
+    for (const auto& e : entries) {
+        const TableStats& s = *e.stats;
+        if (s.scans == 0 && s.builds == 0) continue;  // Not queried yet
+
+        if (!any || (sessions.size() > 1 && e.module != current_module)) {
+            out << "\n";
+            if (sessions.size() > 1) out << "Module " << e.module << ":\n";
+            out << pad("table", 18, true);
+            for (const char* h : headers) out << pad(h, 11);
+            out << "\n";
+            current_module = e.module;
+            any = true;
+        }
+
+        uint64_t hits = s.type_cache_hits;
+        uint64_t lookups = hits + s.type_cache_misses;
+        out << pad(e.table, 18, true)
+            << pad(std::to_string(s.scans), 11)
+            << pad(std::to_string(s.builds), 11)
+            << pad(format_number(s.build_ns / 1e6, "%.1f"), 11)
+            << pad(std::to_string(s.rows), 11)
+            << pad(std::to_string(s.bytes), 11)
+            << pad(std::to_string(s.lookups), 11)
+            << pad(format_number(s.lookup_ns / 1e6, "%.1f"), 11)
+            << pad(std::to_string(s.dies_visited), 11)
+            << pad(std::to_string(s.offdie_calls), 11)
+            << pad(lookups ? format_number(100.0 * hits / lookups, "%.1f%%") : "-", 11)
+            << pad(format_number(s.srclines_ns / 1e6, "%.1f"), 11) << "\n";
+    }
+    if (!any) out << "No table has been queried yet\n";
+    return out.str();
+}
+
+std::string format_metrics(const SessionSet& sessions, const std::vector<TableDef>& tables,
+                           const QueryStats& queries) {
+    std::ostringstream out;
+    auto entries = table_entries(sessions, tables);
+
+    auto family = [&](const char* name, const char* type, const char* help,
+                      const std::function<double(const TableStats&)>& value) {
+        out << "# HELP " << name << " " << help << "\n"
+            << "# TYPE " << name << " " << type << "\n";
+        for (const auto& e : entries) {
+            out << name << "{module=\"" << label_value(e.module) << "\",table=\""
+                << label_value(e.table) << "\"} " << metric_value(value(*e.stats)) << "\n";
+        }
+    };
+    auto seconds = [](uint64_t ns) { return ns / 1e9; };
+
+    for (size_t m = 0; m < sessions.size(); ++m) {
+        if (m == 0) {
+            out << "# HELP dwarfsql_module_indexed Whether the module's DIE index has been built\n"
+                << "# TYPE dwarfsql_module_indexed gauge\n";
+        }
+        out << "dwarfsql_module_indexed{module=\"" << label_value(sessions[m].name) << "\"} "
+            << (sessions[m].session->has_index() ? 1 : 0) << "\n";
+    }
+
+    family("dwarfsql_table_scans_total", "counter", "Cursors opened on the table",
+           [](const TableStats& s) { return double(s.scans); });
+    family("dwarfsql_table_builds_total", "counter", "Row cache and filter index builds",
+           [](const TableStats& s) { return double(s.builds); });
+    family("dwarfsql_table_build_seconds_total", "counter", "Time spent building the row cache",
+           [&](const TableStats& s) { return seconds(s.build_ns); });
+    family("dwarfsql_table_rows", "gauge", "Rows in the row cache",
+           [](const TableStats& s) { return double(s.rows); });
+    family("dwarfsql_table_bytes", "gauge", "Row storage of the row cache, strings excluded",
+           [](const TableStats& s) { return double(s.bytes); });
+    family("dwarfsql_table_lookups_total", "counter", "Keys, units and calls decoded without the cache",
+           [](const TableStats& s) { return double(s.lookups); });
+    family("dwarfsql_table_lookup_seconds_total", "counter", "Time spent in lookups",
+           [&](const TableStats& s) { return seconds(s.lookup_ns); });
+    family("dwarfsql_table_lookup_rows_total", "counter", "Rows produced by lookups",
+           [](const TableStats& s) { return double(s.lookup_rows); });
+    family("dwarfsql_table_dies_visited_total", "counter", "DIEs visited for the table",
+           [](const TableStats& s) { return double(s.dies_visited); });
+    family("dwarfsql_table_offdie_calls_total", "counter", "dwarf_offdie_b calls for the table",
+           [](const TableStats& s) { return double(s.offdie_calls); });
+    family("dwarfsql_table_type_cache_hits_total", "counter", "Type names found in the type-name cache",
+           [](const TableStats& s) { return double(s.type_cache_hits); });
+    family("dwarfsql_table_type_cache_misses_total", "counter", "Type names rendered from DIEs",
+           [](const TableStats& s) { return double(s.type_cache_misses); });
+    family("dwarfsql_table_srclines_seconds_total", "counter", "Time spent in libdwarf line table decoding",
+           [&](const TableStats& s) { return seconds(s.srclines_ns); });
+
+    out << "# HELP dwarfsql_queries_total Queries executed\n"
+        << "# TYPE dwarfsql_queries_total counter\n"
+        << "dwarfsql_queries_total " << queries.count() << "\n"
+        << "# HELP dwarfsql_query_errors_total Queries the SQL parser rejected\n"
+        << "# TYPE dwarfsql_query_errors_total counter\n"
+        << "dwarfsql_query_errors_total " << queries.errors() << "\n"
+        << "# HELP dwarfsql_queries_stopped_total Queries stopped by their time or row limit, or cancelled\n"
+        << "# TYPE dwarfsql_queries_stopped_total counter\n"
+        << "dwarfsql_queries_stopped_total " << queries.stopped() << "\n"
+        << "# HELP dwarfsql_query_table_seconds_total Query time spent decoding tables\n"
+        << "# TYPE dwarfsql_query_table_seconds_total counter\n"
+        << "dwarfsql_query_table_seconds_total " << metric_value(seconds(queries.decode_ns())) << "\n"
+        << "# HELP dwarfsql_statement_cache_hits_total Queries run from a cached prepared statement\n"
+        << "# TYPE dwarfsql_statement_cache_hits_total counter\n"
+        << "dwarfsql_statement_cache_hits_total " << queries.statements_reused() << "\n"
+        << "# HELP dwarfsql_statement_cache_misses_total Queries compiled into the statement cache\n"
+        << "# TYPE dwarfsql_statement_cache_misses_total counter\n"
+        << "dwarfsql_statement_cache_misses_total " << queries.statements_prepared() << "\n"
+        << "# HELP dwarfsql_query_duration_seconds Query wall time\n"
+        << "# TYPE dwarfsql_query_duration_seconds histogram\n";
+    auto histogram = queries.histogram();
+    for (size_t i = 0; i < QueryStats::BUCKETS.size(); ++i) {
+        out << "dwarfsql_query_duration_seconds_bucket{le=\"" << metric_value(QueryStats::BUCKETS[i]) << "\"} "
+            << histogram[i] << "\n";
+    }
+    out << "dwarfsql_query_duration_seconds_bucket{le=\"+Inf\"} " << histogram.back() << "\n"
+        << "dwarfsql_query_duration_seconds_sum " << metric_value(seconds(queries.total_ns())) << "\n"
+        << "dwarfsql_query_duration_seconds_count " << queries.count() << "\n";
+    return out.str();
+}
+
+} // namespace dwarfsql
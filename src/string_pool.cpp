@@ -0,0 +1,171 @@
+// Copyright (c) 2024-2026 Elias Bachaalany
+// SPDX-License-Identifier: LicenseRef-Human-Origin-Source-1.0
+//
+// This file is licensed under the Human-Origin Source License v1.0.
+// See LICENSE.
+
+/**
+ * string_pool.cpp - Append-only storage for interned strings
+ */
+
+#include <dwarfsql/string_pool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace dwarfsql {
+
+StringPool::StringPool(StringPool&& other) noexcept
+    : blocks_(std::move(other.blocks_))
+    , cursor_(other.cursor_)
+    , left_(other.left_)
+    , bytes_(other.bytes_)
+    , strings_(std::move(other.strings_))
+{
+    other.clear();
+}
+
+StringPool& StringPool::operator=(StringPool&& other) noexcept {
+    if (this != &other) {
+        blocks_ = std::move(other.blocks_);
+        cursor_ = other.cursor_;
+        left_ = other.left_;
+        bytes_ = other.bytes_;
+        strings_ = std::move(other.strings_);
+        other.clear();
+    }
+    return *this;
+}
+
+InternedString StringPool::intern(std::string_view s) {
+    if (s.empty()) return InternedString();
+
+    auto it = strings_.find(s);
+    if (it != strings_.end()) {
+        return InternedString(it->data(), static_cast<uint32_t>(it->size()));
+    }
+
+    // Clamp pathological lengths rather than wrap the 32-bit size
+    size_t n = std::min(s.size(), static_cast<size_t>(std::numeric_limits<uint32_t>::max()));
+
+    char* dst;
+    if (n > BLOCK_SIZE / 4) {
+        // Large strings get their own block so they don't strand the current one
+        blocks_.push_back(std::make_unique<char[]>(n));
+        bytes_ += n;
+        dst = blocks_.back().get();
+    } else {
+        if (left_ < n) {
+            blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+            bytes_ += BLOCK_SIZE;
+            cursor_ = blocks_.back().get();
+            left_ = BLOCK_SIZE;
+        }
+        dst = cursor_;
+        cursor_ += n;
+        left_ -= n;
+    }
+
+    std::memcpy(dst, s.data(), n);
+    strings_.insert(std::string_view(dst, n));
+    return InternedString(dst, static_cast<uint32_t>(n));
+}
+
+void StringPool::adopt(StringPool&& other) {
+    if (&other == this || other.blocks_.empty()) return;
+
+    for (std::string_view s : other.strings_) {
+        strings_.insert(s);
+    }
+    blocks_.insert(blocks_.end(),
+                   std::make_move_iterator(other.blocks_.begin()),
+                   std::make_move_iterator(other.blocks_.end()));
+    if (other.left_ > left_) {
+        cursor_ = other.cursor_;
+        left_ = other.left_;
+    }
+    bytes_ += other.bytes_;
+    other.clear();
+}
+
+void StringPool::absorb(StringPool&& other) {
+    if (&other == this || other.blocks_.empty()) return;
+
+    blocks_.insert(blocks_.end(),
+                   std::make_move_iterator(other.blocks_.begin()),
+                   std::make_move_iterator(other.blocks_.end()));
+    bytes_ += other.bytes_;
+    other.clear();
+}
+
+void StringPool::clear() {
+    strings_.clear();
+    blocks_.clear();
+    cursor_ = nullptr;
+    left_ = 0;
+    bytes_ = 0;
+}
+
+// ============================================================================
+// StringTable
+// ============================================================================
+
+StringTable::StringTable() : chunks_(std::make_unique<std::atomic<const InternedString*>[]>(MAX_CHUNKS)) {
+    clear();
+}
+
+StringTable::StringTable(StringTable&& other) noexcept
+    : chunks_(std::move(other.chunks_))
+    , owned_(std::move(other.owned_))
+    , numbers_(std::move(other.numbers_))
+    , size_(other.size_.load())
+{
+    other.chunks_ = std::make_unique<std::atomic<const InternedString*>[]>(MAX_CHUNKS);
+    other.clear();
+}
+
+StringTable& StringTable::operator=(StringTable&& other) noexcept {
+    if (this != &other) {
+        std::swap(chunks_, other.chunks_);
+        owned_ = std::move(other.owned_);
+        numbers_ = std::move(other.numbers_);
+        size_ = other.size_.load();
+        other.clear();
+    }
+    return *this;
+}
+
+uint32_t StringTable::add(InternedString s) {
+    if (s.empty()) return 0;
+    auto it = numbers_.find(s.data());
+    if (it != numbers_.end()) return it->second;
+
+    size_t size = size_.load(std::memory_order_relaxed);
+    if (size == MAX_CHUNKS << CHUNK_BITS) return 0;
+    uint32_t number = static_cast<uint32_t>(size);
+    size_t chunk = number >> CHUNK_BITS;
+    if (chunk == owned_.size()) {
+        owned_.push_back(std::make_unique<InternedString[]>(CHUNK_MASK + 1));
+        chunks_[chunk].store(owned_.back().get(), std::memory_order_release);
+    }
+    owned_[chunk][number & CHUNK_MASK] = s;
+    numbers_.emplace(s.data(), number);
+    size_.store(size + 1, std::memory_order_release);
+    return number;
+}
+
+void StringTable::clear() {
+    for (size_t i = 0; i < MAX_CHUNKS; ++i) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    owned_.clear();
+    numbers_.clear();
+
+    // Number 0
+    owned_.push_back(std::make_unique<InternedString[]>(CHUNK_MASK + 1));
+    chunks_[0].store(owned_.back().get(), std::memory_order_release);
+    size_.store(1, std::memory_order_release);
+}
+
+} // namespace dwarfsql